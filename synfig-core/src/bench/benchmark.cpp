@@ -0,0 +1,208 @@
+/* === S Y N F I G ========================================================= */
+/*!	\file benchmark.cpp
+**	\brief Timing, reporting and baseline comparison of benchmarks
+**
+**	$Id$
+**
+**	\legal
+**	......... ... 2026 Synfig contributors
+**
+**	This package is free software; you can redistribute it and/or
+**	modify it under the terms of the GNU General Public License as
+**	published by the Free Software Foundation; either version 2 of
+**	the License, or (at your option) any later version.
+**
+**	This package is distributed in the hope that it will be useful,
+**	but WITHOUT ANY WARRANTY; without even the implied warranty of
+**	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+**	General Public License for more details.
+**	\endlegal
+*/
+/* ========================================================================= */
+
+/* === H E A D E R S ======================================================= */
+
+#ifdef USING_PCH
+#	include "pch.h"
+#else
+#ifdef HAVE_CONFIG_H
+#	include <config.h>
+#endif
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+
+#include "benchmark.h"
+
+#endif
+
+/* === U S I N G =========================================================== */
+
+using namespace bench;
+
+/* === M A C R O S ========================================================= */
+
+//! Count of samples, median of them is reported
+#define SAMPLES 5
+
+/* === G L O B A L S ======================================================= */
+
+/* === P R O C E D U R E S ================================================= */
+
+static double
+now()
+{
+	return std::chrono::duration<double>(
+		std::chrono::steady_clock::now().time_since_epoch() ).count();
+}
+
+static double
+run_iterations(const std::function<void()> &func, long long count)
+{
+	double t = now();
+	for(long long i = 0; i < count; ++i)
+		func();
+	return now() - t;
+}
+
+static std::string
+format_time(double t)
+{
+	char buf[64];
+	if      (t < 1e-6) snprintf(buf, sizeof(buf), "%8.2f ns", t*1e9);
+	else if (t < 1e-3) snprintf(buf, sizeof(buf), "%8.2f us", t*1e6);
+	else if (t < 1.0)  snprintf(buf, sizeof(buf), "%8.2f ms", t*1e3);
+	else               snprintf(buf, sizeof(buf), "%8.2f s ", t);
+	return buf;
+}
+
+/* === M E T H O D S ======================================================= */
+
+Runner::Runner():
+	min_time(0.5),
+	list_only(false)
+{ }
+
+bool
+Runner::is_enabled(const std::string &name) const
+{
+	if (filters.empty())
+		return true;
+	for(std::vector<std::string>::const_iterator i = filters.begin(); i != filters.end(); ++i)
+		if (name.find(*i) != std::string::npos)
+			return true;
+	return false;
+}
+
+void
+Runner::measure(const std::string &name, const std::function<void()> &func, double items)
+{
+	if (!is_enabled(name))
+		return;
+	if (list_only)
+		{ printf("%s\n", name.c_str()); return; }
+
+	// warm up caches and lazy initializations, and estimate count of iterations per sample
+	double sample_time = min_time/SAMPLES;
+	long long count = 1;
+	double t = run_iterations(func, count);
+	while(t < sample_time*0.5 && count < (1LL << 40)) {
+		count = t > 0.0 ? std::max(count*2, (long long)(count*sample_time/t)) : count*16;
+		t = run_iterations(func, count);
+	}
+
+	std::vector<double> samples;
+	for(int i = 0; i < SAMPLES; ++i)
+		samples.push_back(run_iterations(func, count)/count);
+	std::sort(samples.begin(), samples.end());
+
+	Result result;
+	result.name = name;
+	result.time = samples[SAMPLES/2];
+	result.iterations = count*SAMPLES;
+	result.items = items;
+	results.push_back(result);
+
+	if (items > 0.0)
+		printf("%-48s %s  %10.2f M/s\n", name.c_str(), format_time(result.time).c_str(), items/result.time*1e-6);
+	else
+		printf("%-48s %s\n", name.c_str(), format_time(result.time).c_str());
+	fflush(stdout);
+}
+
+bool
+Runner::save_json(const std::string &filename) const
+{
+	FILE *f = fopen(filename.c_str(), "w");
+	if (!f) {
+		fprintf(stderr, "Cannot write to file \"%s\"\n", filename.c_str());
+		return false;
+	}
+
+	// one benchmark per line, load_baseline() relies on it
+	fprintf(f, "{\"benchmarks\":[\n");
+	for(std::vector<Result>::const_iterator i = results.begin(); i != results.end(); ++i)
+		fprintf( f, "{\"name\":\"%s\",\"time\":%.9g,\"iterations\":%lld,\"items\":%.9g}%s\n",
+				 i->name.c_str(), i->time, i->iterations, i->items,
+				 i + 1 == results.end() ? "" : "," );
+	fprintf(f, "]}\n");
+
+	bool success = !ferror(f);
+	if (fclose(f)) success = false;
+	return success;
+}
+
+bool
+Runner::load_baseline(const std::string &filename, Baseline &baseline)
+{
+	std::ifstream f(filename.c_str());
+	if (!f) {
+		fprintf(stderr, "Cannot read baseline file \"%s\"\n", filename.c_str());
+		return false;
+	}
+
+	const std::string name_key = "\"name\":\"";
+	const std::string time_key = "\"time\":";
+	std::string line;
+	while(std::getline(f, line)) {
+		size_t name_pos = line.find(name_key);
+		size_t time_pos = line.find(time_key);
+		if (name_pos == std::string::npos || time_pos == std::string::npos)
+			continue;
+		name_pos += name_key.size();
+		size_t name_end = line.find('"', name_pos);
+		if (name_end == std::string::npos)
+			continue;
+		baseline[line.substr(name_pos, name_end - name_pos)] = atof(line.c_str() + time_pos + time_key.size());
+	}
+	return true;
+}
+
+int
+Runner::compare(const Baseline &baseline, double tolerance) const
+{
+	int regressions = 0;
+	printf("\n%-48s %11s  %11s  %8s\n", "comparison with baseline", "baseline", "current", "change");
+	for(std::vector<Result>::const_iterator i = results.begin(); i != results.end(); ++i) {
+		Baseline::const_iterator b = baseline.find(i->name);
+		if (b == baseline.end() || b->second <= 0.0) {
+			printf("%-48s %11s  %s  %8s\n", i->name.c_str(), "-", format_time(i->time).c_str(), "new");
+			continue;
+		}
+		double change = i->time/b->second - 1.0;
+		bool regression = change > tolerance;
+		if (regression) ++regressions;
+		printf( "%-48s %s  %s  %+7.1f%%%s\n",
+				i->name.c_str(),
+				format_time(b->second).c_str(),
+				format_time(i->time).c_str(),
+				change*100.0,
+				regression ? "  REGRESSION" : "" );
+	}
+	return regressions;
+}
+
+/* === E N T R Y P O I N T ================================================= */
@@ -0,0 +1,108 @@
+/* === S Y N F I G ========================================================= */
+/*!	\file benchmark.h
+**	\brief Timing, reporting and baseline comparison of benchmarks
+**
+**	$Id$
+**
+**	\legal
+**	......... ... 2026 Synfig contributors
+**
+**	This package is free software; you can redistribute it and/or
+**	modify it under the terms of the GNU General Public License as
+**	published by the Free Software Foundation; either version 2 of
+**	the License, or (at your option) any later version.
+**
+**	This package is distributed in the hope that it will be useful,
+**	but WITHOUT ANY WARRANTY; without even the implied warranty of
+**	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+**	General Public License for more details.
+**	\endlegal
+*/
+/* ========================================================================= */
+
+/* === S T A R T =========================================================== */
+
+#ifndef __SYNFIG_BENCH_BENCHMARK_H
+#define __SYNFIG_BENCH_BENCHMARK_H
+
+/* === H E A D E R S ======================================================= */
+
+#include <functional>
+#include <map>
+#include <string>
+#include <vector>
+
+/* === M A C R O S ========================================================= */
+
+/* === T Y P E D E F S ===================================================== */
+
+/* === C L A S S E S & S T R U C T S ======================================= */
+
+namespace bench {
+
+//! Runs benchmarks and collects their timings
+class Runner
+{
+public:
+	struct Result {
+		std::string name;
+		double time;			//!< median time of one iteration in seconds
+		long long iterations;	//!< total count of measured iterations
+		double items;			//!< items (pixels, values, layers) processed by one iteration
+		Result(): time(), iterations(), items() { }
+	};
+
+	typedef std::map<std::string, double> Baseline;
+
+private:
+	std::vector<std::string> filters;
+	double min_time;
+	bool list_only;
+	std::vector<Result> results;
+
+public:
+	Runner();
+
+	//! Benchmark runs only if its name contains one of the filters
+	void add_filter(const std::string &filter)
+		{ filters.push_back(filter); }
+	//! Minimal time spent to measure one benchmark, in seconds
+	void set_min_time(double x)
+		{ min_time = x; }
+	void set_list_only(bool x)
+		{ list_only = x; }
+
+	//! Returns false if benchmark is filtered out, so caller may skip preparation
+	bool is_enabled(const std::string &name) const;
+
+	//! Calls \a func repeatedly, each call is one iteration
+	void measure(const std::string &name, const std::function<void()> &func, double items = 0.0);
+
+	const std::vector<Result>& get_results() const
+		{ return results; }
+
+	bool save_json(const std::string &filename) const;
+	static bool load_baseline(const std::string &filename, Baseline &baseline);
+
+	//! Prints difference with \a baseline, returns count of benchmarks
+	//! which became slower more than by \a tolerance (0.1 means 10%)
+	int compare(const Baseline &baseline, double tolerance) const;
+};
+
+//! Options of procedurally generated scenes
+struct SceneOptions {
+	int width;
+	int height;
+	int layers;		//!< count of primitive layers in the scene
+	int frames;		//!< count of different frames rendered by the scene benchmark
+	SceneOptions(): width(480), height(270), layers(200), frames(24) { }
+};
+
+void run_micro_benchmarks(Runner &runner);
+void run_scene_benchmarks(Runner &runner, const SceneOptions &options);
+
+}; // END of namespace bench
+
+/* === E N D =============================================================== */
+
+#endif
@@ -0,0 +1,142 @@
+/* === S Y N F I G ========================================================= */
+/*!	\file bench/main.cpp
+**	\brief Benchmark suite of synfig-core
+**
+**	$Id$
+**
+**	\legal
+**	......... ... 2026 Synfig contributors
+**
+**	This package is free software; you can redistribute it and/or
+**	modify it under the terms of the GNU General Public License as
+**	published by the Free Software Foundation; either version 2 of
+**	the License, or (at your option) any later version.
+**
+**	This package is distributed in the hope that it will be useful,
+**	but WITHOUT ANY WARRANTY; without even the implied warranty of
+**	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+**	General Public License for more details.
+**	\endlegal
+*/
+/* ========================================================================= */
+
+/* === H E A D E R S ======================================================= */
+
+#ifdef USING_PCH
+#	include "pch.h"
+#else
+#ifdef HAVE_CONFIG_H
+#	include <config.h>
+#endif
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+
+#include <glibmm/miscutils.h>
+
+#include <synfig/general.h>
+#include <synfig/main.h>
+
+#include "benchmark.h"
+
+#endif
+
+/* === U S I N G =========================================================== */
+
+using namespace bench;
+
+/* === M A C R O S ========================================================= */
+
+/* === G L O B A L S ======================================================= */
+
+/* === P R O C E D U R E S ================================================= */
+
+static void
+print_usage(const char *name)
+{
+	printf(
+		"Usage: %s [options] [filter...]\n"
+		"Runs benchmarks whose names contain one of the filters (all by default).\n"
+		"\n"
+		"Options:\n"
+		"  --list                 print names of benchmarks and exit\n"
+		"  --micro                run only benchmarks of separate functions\n"
+		"  --scenes               run only benchmarks of generated documents\n"
+		"  --min-time SECONDS     time spent to measure each benchmark (default 0.5)\n"
+		"  --layers NUM           count of layers in generated documents (default 200)\n"
+		"  --size WIDTHxHEIGHT    size of rendered frames (default 480x270)\n"
+		"  --frames NUM           count of animated frames (default 24)\n"
+		"  --json FILE            write results to FILE\n"
+		"  --baseline FILE        compare results with FILE written by --json\n"
+		"  --tolerance PERCENT    allowed slowdown against baseline (default 10)\n"
+		"\n"
+		"Exit code is 1 if some of benchmarks are slower than baseline.\n",
+		name );
+}
+
+/* === E N T R Y P O I N T ================================================= */
+
+int main(int argc, char **argv)
+{
+	Runner runner;
+	SceneOptions scene_options;
+	bool micro = true;
+	bool scenes = true;
+	std::string json_file;
+	std::string baseline_file;
+	double tolerance = 10.0;
+
+	for(int i = 1; i < argc; ++i) {
+		std::string arg = argv[i];
+		bool has_value = i + 1 < argc;
+		if (arg == "--help" || arg == "-h")
+			{ print_usage(argv[0]); return 0; }
+		else if (arg == "--list")
+			runner.set_list_only(true);
+		else if (arg == "--micro")
+			scenes = false;
+		else if (arg == "--scenes")
+			micro = false;
+		else if (arg == "--min-time" && has_value)
+			runner.set_min_time(std::max(0.001, atof(argv[++i])));
+		else if (arg == "--layers" && has_value)
+			scene_options.layers = std::max(1, atoi(argv[++i]));
+		else if (arg == "--frames" && has_value)
+			scene_options.frames = std::max(1, atoi(argv[++i]));
+		else if (arg == "--size" && has_value) {
+			if (sscanf(argv[++i], "%dx%d", &scene_options.width, &scene_options.height) != 2
+			 || scene_options.width <= 0 || scene_options.height <= 0)
+				{ fprintf(stderr, "Invalid size: %s\n", argv[i]); return 2; }
+		}
+		else if (arg == "--json" && has_value)
+			json_file = argv[++i];
+		else if (arg == "--baseline" && has_value)
+			baseline_file = argv[++i];
+		else if (arg == "--tolerance" && has_value)
+			tolerance = atof(argv[++i]);
+		else if (!arg.empty() && arg[0] == '-')
+			{ fprintf(stderr, "Unknown option: %s\n\n", arg.c_str()); print_usage(argv[0]); return 2; }
+		else
+			runner.add_filter(arg);
+	}
+
+	Runner::Baseline baseline;
+	if (!baseline_file.empty() && !Runner::load_baseline(baseline_file, baseline))
+		return 2;
+
+	// modules are required by the scenes
+	synfig::Main synfig_main(Glib::path_get_dirname(synfig::get_binary_path(argv[0])));
+
+	if (micro)
+		run_micro_benchmarks(runner);
+	if (scenes)
+		run_scene_benchmarks(runner, scene_options);
+
+	if (!json_file.empty() && !runner.save_json(json_file))
+		return 2;
+	if (!baseline_file.empty() && runner.compare(baseline, tolerance*0.01) > 0)
+		return 1;
+	return 0;
+}
@@ -0,0 +1,377 @@
+/* === S Y N F I G ========================================================= */
+/*!	\file micro.cpp
+**	\brief Benchmarks of the separate rendering functions
+**
+**	$Id$
+**
+**	\legal
+**	......... ... 2026 Synfig contributors
+**
+**	This package is free software; you can redistribute it and/or
+**	modify it under the terms of the GNU General Public License as
+**	published by the Free Software Foundation; either version 2 of
+**	the License, or (at your option) any later version.
+**
+**	This package is distributed in the hope that it will be useful,
+**	but WITHOUT ANY WARRANTY; without even the implied warranty of
+**	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+**	General Public License for more details.
+**	\endlegal
+*/
+/* ========================================================================= */
+
+/* === H E A D E R S ======================================================= */
+
+#ifdef USING_PCH
+#	include "pch.h"
+#else
+#ifdef HAVE_CONFIG_H
+#	include <config.h>
+#endif
+
+#include <cmath>
+#include <vector>
+
+#include <ETL/stringf>
+
+#include <synfig/color.h>
+#include <synfig/color/pixelformat.h>
+#include <synfig/surface.h>
+#include <synfig/rendering/primitive/contour.h>
+#include <synfig/rendering/software/function/blur.h>
+#include <synfig/rendering/software/function/contour.h>
+#include <synfig/rendering/software/function/packedsurface.h>
+#include <synfig/rendering/software/function/resample.h>
+#include <synfig/valuenodes/valuenode_animated.h>
+
+#include "benchmark.h"
+
+#endif
+
+/* === U S I N G =========================================================== */
+
+using namespace synfig;
+using namespace bench;
+
+/* === M A C R O S ========================================================= */
+
+#define SURFACE_SIZE 512
+
+/* === G L O B A L S ======================================================= */
+
+namespace {
+	struct BlendMethodName { Color::BlendMethod method; const char *name; };
+	const BlendMethodName blend_methods[] = {
+		{ Color::BLEND_COMPOSITE,      "composite"      },
+		{ Color::BLEND_STRAIGHT,       "straight"       },
+		{ Color::BLEND_ONTO,           "onto"           },
+		{ Color::BLEND_STRAIGHT_ONTO,  "straight_onto"  },
+		{ Color::BLEND_BEHIND,         "behind"         },
+		{ Color::BLEND_SCREEN,         "screen"         },
+		{ Color::BLEND_OVERLAY,        "overlay"        },
+		{ Color::BLEND_HARD_LIGHT,     "hard_light"     },
+		{ Color::BLEND_MULTIPLY,       "multiply"       },
+		{ Color::BLEND_DIVIDE,         "divide"         },
+		{ Color::BLEND_ADD,            "add"            },
+		{ Color::BLEND_ADD_COMPOSITE,  "add_composite"  },
+		{ Color::BLEND_SUBTRACT,       "subtract"       },
+		{ Color::BLEND_DIFFERENCE,     "difference"     },
+		{ Color::BLEND_BRIGHTEN,       "brighten"       },
+		{ Color::BLEND_DARKEN,         "darken"         },
+		{ Color::BLEND_COLOR,          "color"          },
+		{ Color::BLEND_HUE,            "hue"            },
+		{ Color::BLEND_SATURATION,     "saturation"     },
+		{ Color::BLEND_LUMINANCE,      "luminance"      },
+		{ Color::BLEND_ALPHA_BRIGHTEN, "alpha_brighten" },
+		{ Color::BLEND_ALPHA_DARKEN,   "alpha_darken"   },
+		{ Color::BLEND_ALPHA_OVER,     "alpha_over"     },
+		{ Color::BLEND_ALPHA,          "alpha"          } };
+
+	struct BlurTypeName { rendering::Blur::Type type; const char *name; };
+	const BlurTypeName blur_types[] = {
+		{ rendering::Blur::BOX,          "box"           },
+		{ rendering::Blur::FASTGAUSSIAN, "fast_gaussian" },
+		{ rendering::Blur::CROSS,        "cross"         },
+		{ rendering::Blur::GAUSSIAN,     "gaussian"      },
+		{ rendering::Blur::DISC,         "disc"          } };
+
+	struct InterpolationName { Color::Interpolation interpolation; const char *name; };
+	const InterpolationName interpolations[] = {
+		{ Color::INTERPOLATION_NEAREST, "nearest" },
+		{ Color::INTERPOLATION_LINEAR,  "linear"  },
+		{ Color::INTERPOLATION_COSINE,  "cosine"  },
+		{ Color::INTERPOLATION_CUBIC,   "cubic"   } };
+
+	volatile float sink;
+}
+
+/* === P R O C E D U R E S ================================================= */
+
+//! Simple deterministic generator, results should not depend on platform
+class Random {
+private:
+	unsigned int seed;
+public:
+	explicit Random(unsigned int seed = 1): seed(seed) { }
+	float operator()()
+		{ seed = seed*1664525u + 1013904223u; return (float)(seed >> 8)/(float)(1u << 24); }
+	Color color()
+		{ float a = (*this)(); return Color((*this)()*a, (*this)()*a, (*this)()*a, a); }
+};
+
+//! Surface with smooth gradients and noise, similar to rendered images
+static void
+fill_surface(synfig::Surface &surface, unsigned int seed)
+{
+	Random random(seed);
+	surface.set_wh(SURFACE_SIZE, SURFACE_SIZE);
+	for(int y = 0; y < surface.get_h(); ++y)
+		for(int x = 0; x < surface.get_w(); ++x) {
+			float a = 0.5f + 0.5f*std::sin(x*0.05f)*std::cos(y*0.03f);
+			surface[y][x] = Color(x/(float)SURFACE_SIZE*a, y/(float)SURFACE_SIZE*a, random()*a, a);
+		}
+}
+
+static void
+bench_color_blend(Runner &runner)
+{
+	const int count = 4096;
+	Random random;
+	std::vector<Color> a(count), b(count), dest(count);
+	for(int i = 0; i < count; ++i)
+		{ a[i] = random.color(); b[i] = random.color(); }
+
+	for(size_t m = 0; m < sizeof(blend_methods)/sizeof(blend_methods[0]); ++m) {
+		Color::BlendMethod method = blend_methods[m].method;
+		runner.measure(
+			etl::strprintf("color_blend/%s", blend_methods[m].name),
+			[&]() {
+				for(int i = 0; i < count; ++i)
+					dest[i] = Color::blend(a[i], b[i], 0.75f, method);
+				sink = dest[count/2].get_a();
+			},
+			count );
+	}
+}
+
+static void
+bench_blur(Runner &runner)
+{
+	const Real radii[] = { 2.0, 16.0, 64.0 };
+
+	synfig::Surface src, dest;
+	bool prepared = false;
+	for(size_t t = 0; t < sizeof(blur_types)/sizeof(blur_types[0]); ++t)
+		for(size_t r = 0; r < sizeof(radii)/sizeof(radii[0]); ++r) {
+			std::string name = etl::strprintf("blur/%s/r%d", blur_types[t].name, (int)radii[r]);
+			if (!runner.is_enabled(name)) continue;
+			if (!prepared) {
+				fill_surface(src, 2);
+				dest.set_wh(SURFACE_SIZE, SURFACE_SIZE);
+				prepared = true;
+			}
+
+			rendering::software::Blur::Params params(
+				dest, RectInt(0, 0, SURFACE_SIZE, SURFACE_SIZE),
+				src, VectorInt(0, 0),
+				blur_types[t].type, Vector(radii[r], radii[r]),
+				false, Color::BLEND_COMPOSITE, 1.f );
+			runner.measure(
+				name,
+				[&]() { rendering::software::Blur::blur(params); },
+				(double)SURFACE_SIZE*SURFACE_SIZE );
+		}
+}
+
+static void
+bench_contour(Runner &runner)
+{
+	// star with many rays, in pixel coordinates
+	const int rays = 200;
+	const Real center = SURFACE_SIZE*0.5;
+	rendering::Contour contour;
+	for(int i = 0; i < rays*2; ++i) {
+		Real angle = PI*i/rays;
+		Real radius = center*(i % 2 ? 0.45 : 0.95);
+		Vector p(center + radius*std::cos(angle), center + radius*std::sin(angle));
+		if (i) contour.line_to(p); else contour.move_to(p);
+	}
+	contour.close();
+
+	if (runner.is_enabled("contour/build_polyspan"))
+		runner.measure(
+			"contour/build_polyspan",
+			[&]() {
+				rendering::Polyspan polyspan;
+				polyspan.init(0, 0, SURFACE_SIZE, SURFACE_SIZE);
+				rendering::software::Contour::build_polyspan(contour.get_chunks(), Matrix(), polyspan);
+				polyspan.sort_marks();
+			},
+			rays*2 );
+
+	if (!runner.is_enabled("contour/render_polyspan"))
+		return;
+	rendering::Polyspan polyspan;
+	polyspan.init(0, 0, SURFACE_SIZE, SURFACE_SIZE);
+	rendering::software::Contour::build_polyspan(contour.get_chunks(), Matrix(), polyspan);
+	polyspan.sort_marks();
+	synfig::Surface surface(SURFACE_SIZE, SURFACE_SIZE);
+	surface.clear();
+	runner.measure(
+		"contour/render_polyspan",
+		[&]() {
+			rendering::software::Contour::render_polyspan(
+				surface, polyspan, false, true,
+				rendering::Contour::WINDING_NON_ZERO,
+				Color(1.f, 0.5f, 0.25f, 1.f), 0.5f, Color::BLEND_COMPOSITE );
+		},
+		(double)SURFACE_SIZE*SURFACE_SIZE );
+}
+
+static void
+bench_resample(Runner &runner)
+{
+	synfig::Surface src, dest;
+	bool prepared = false;
+	const RectInt bounds(0, 0, SURFACE_SIZE, SURFACE_SIZE);
+	Matrix matrix = Matrix().set_translate(-0.5*SURFACE_SIZE, -0.5*SURFACE_SIZE)
+	              * Matrix().set_rotate(Angle::deg(30.0))
+	              * Matrix().set_scale(1.3)
+	              * Matrix().set_translate(0.5*SURFACE_SIZE, 0.5*SURFACE_SIZE);
+
+	for(size_t i = 0; i < sizeof(interpolations)/sizeof(interpolations[0]); ++i) {
+		std::string name = etl::strprintf("resample/%s", interpolations[i].name);
+		if (!runner.is_enabled(name)) continue;
+		if (!prepared) {
+			fill_surface(src, 3);
+			dest.set_wh(SURFACE_SIZE, SURFACE_SIZE);
+			prepared = true;
+		}
+		Color::Interpolation interpolation = interpolations[i].interpolation;
+		runner.measure(
+			name,
+			[&]() {
+				dest.clear();
+				rendering::software::Resample::resample(
+					dest, bounds, src, bounds, matrix,
+					interpolation, false, 1.f, Color::BLEND_COMPOSITE );
+			},
+			(double)SURFACE_SIZE*SURFACE_SIZE );
+	}
+}
+
+static void
+bench_packed_surface(Runner &runner)
+{
+	if (!runner.is_enabled("packed_surface/pack") && !runner.is_enabled("packed_surface/reader"))
+		return;
+
+	synfig::Surface surface;
+	fill_surface(surface, 4);
+
+	rendering::software::PackedSurface packed;
+	runner.measure(
+		"packed_surface/pack",
+		[&]() { packed.set_pixels(&surface[0][0], surface.get_w(), surface.get_h()); },
+		(double)SURFACE_SIZE*SURFACE_SIZE );
+
+	packed.set_pixels(&surface[0][0], surface.get_w(), surface.get_h());
+	runner.measure(
+		"packed_surface/reader",
+		[&]() {
+			rendering::software::PackedSurface::Reader reader(packed);
+			float sum = 0.f;
+			for(int y = 0; y < SURFACE_SIZE; ++y)
+				for(int x = 0; x < SURFACE_SIZE; ++x)
+					sum += reader.get_pixel(x, y).get_a();
+			sink = sum;
+		},
+		(double)SURFACE_SIZE*SURFACE_SIZE );
+}
+
+static void
+bench_pixelformat(Runner &runner)
+{
+	struct Format { PixelFormat pf; const char *name; };
+	const Format formats[] = {
+		{ PF_RGB,                "rgb"         },
+		{ PF_RGB|PF_A,           "rgba"        },
+		{ PF_BGR|PF_A,           "bgra"        },
+		{ PF_RGB|PF_A_PREMULT,   "rgba_premult"},
+		{ PF_GRAY,               "gray"        } };
+
+	synfig::Surface surface;
+	std::vector<unsigned char> buffer(SURFACE_SIZE*SURFACE_SIZE*4);
+	bool prepared = false;
+	Gamma gamma(2.2f);
+	for(size_t i = 0; i < sizeof(formats)/sizeof(formats[0]); ++i)
+		for(int g = 0; g < 2; ++g) {
+			std::string name = etl::strprintf("color_to_pixelformat/%s%s", formats[i].name, g ? "/gamma" : "");
+			if (!runner.is_enabled(name)) continue;
+			if (!prepared) { fill_surface(surface, 5); prepared = true; }
+			PixelFormat pf = formats[i].pf;
+			const Gamma *gamma_ptr = g ? &gamma : NULL;
+			runner.measure(
+				name,
+				[&]() {
+					color_to_pixelformat(
+						&buffer.front(), &surface[0][0], pf, gamma_ptr,
+						SURFACE_SIZE, SURFACE_SIZE );
+				},
+				(double)SURFACE_SIZE*SURFACE_SIZE );
+		}
+}
+
+static void
+bench_valuenode(Runner &runner)
+{
+	const int waypoints = 100;
+	const int samples = 1000;
+
+	struct Case { const char *name; ValueBase value; Interpolation interpolation; };
+	const Case cases[] = {
+		{ "real/tcb",      ValueBase(Real()),   INTERPOLATION_TCB    },
+		{ "real/linear",   ValueBase(Real()),   INTERPOLATION_LINEAR },
+		{ "vector/tcb",    ValueBase(Vector()), INTERPOLATION_TCB    },
+		{ "vector/linear", ValueBase(Vector()), INTERPOLATION_LINEAR },
+		{ "color/linear",  ValueBase(Color()),  INTERPOLATION_LINEAR } };
+
+	for(size_t c = 0; c < sizeof(cases)/sizeof(cases[0]); ++c) {
+		std::string name = etl::strprintf("valuenode_animated/%s", cases[c].name);
+		if (!runner.is_enabled(name)) continue;
+
+		Random random(6);
+		ValueNode_Animated::Handle node = ValueNode_Animated::create(cases[c].value, Time(0));
+		Type &type = cases[c].value.get_type();
+		for(int i = 1; i < waypoints; ++i) {
+			ValueBase value = type == type_real   ? ValueBase(Real(random()))
+			                : type == type_vector ? ValueBase(Vector(random(), random()))
+			                :                       ValueBase(random.color());
+			node->new_waypoint(Time(i), value);
+		}
+		for(ValueNode_Animated::WaypointList::iterator i = node->editable_waypoint_list().begin(); i != node->editable_waypoint_list().end(); ++i)
+			i->set_before(cases[c].interpolation), i->set_after(cases[c].interpolation);
+
+		runner.measure(
+			name,
+			[&]() {
+				for(int i = 0; i < samples; ++i)
+					(*node)(Time((Real)i*(waypoints - 1)/samples));
+			},
+			samples );
+	}
+}
+
+void
+bench::run_micro_benchmarks(Runner &runner)
+{
+	bench_color_blend(runner);
+	bench_blur(runner);
+	bench_contour(runner);
+	bench_resample(runner);
+	bench_packed_surface(runner);
+	bench_pixelformat(runner);
+	bench_valuenode(runner);
+}
+
+/* === E N T R Y P O I N T ================================================= */
@@ -0,0 +1,243 @@
+/* === S Y N F I G ========================================================= */
+/*!	\file scenes.cpp
+**	\brief Benchmarks of procedurally generated documents
+**
+**	$Id$
+**
+**	\legal
+**	......... ... 2026 Synfig contributors
+**
+**	This package is free software; you can redistribute it and/or
+**	modify it under the terms of the GNU General Public License as
+**	published by the Free Software Foundation; either version 2 of
+**	the License, or (at your option) any later version.
+**
+**	This package is distributed in the hope that it will be useful,
+**	but WITHOUT ANY WARRANTY; without even the implied warranty of
+**	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+**	General Public License for more details.
+**	\endlegal
+*/
+/* ========================================================================= */
+
+/* === H E A D E R S ======================================================= */
+
+#ifdef USING_PCH
+#	include "pch.h"
+#else
+#ifdef HAVE_CONFIG_H
+#	include <config.h>
+#endif
+
+#include <algorithm>
+#include <cstdio>
+
+#include <glibmm/miscutils.h>
+
+#include <ETL/stringf>
+
+#include <synfig/canvas.h>
+#include <synfig/context.h>
+#include <synfig/filesystemnative.h>
+#include <synfig/gradient.h>
+#include <synfig/layer.h>
+#include <synfig/loadcanvas.h>
+#include <synfig/savecanvas.h>
+#include <synfig/rendering/renderer.h>
+#include <synfig/rendering/common/task/tasktransformation.h>
+#include <synfig/valuenodes/valuenode_animated.h>
+
+#include "benchmark.h"
+
+#endif
+
+/* === U S I N G =========================================================== */
+
+using namespace synfig;
+using namespace bench;
+
+/* === M A C R O S ========================================================= */
+
+//! Count of primitive layers in each group
+#define GROUP_SIZE 16
+
+/* === G L O B A L S ======================================================= */
+
+/* === P R O C E D U R E S ================================================= */
+
+namespace {
+	class Random {
+	private:
+		unsigned int seed;
+	public:
+		explicit Random(unsigned int seed): seed(seed) { }
+		Real operator()()
+			{ seed = seed*1664525u + 1013904223u; return (Real)(seed >> 8)/(Real)(1u << 24); }
+		Real range(Real a, Real b)
+			{ return a + (b - a)*(*this)(); }
+		Color color()
+			{ return Color((*this)(), (*this)(), (*this)(), range(0.5, 1.0)); }
+		Vector vector(Real size)
+			{ return Vector(range(-size, size), range(-size, size)); }
+	};
+}
+
+static void
+set_animated_param(Layer::Handle layer, const String &param, const ValueBase &a, const ValueBase &b, Time end)
+{
+	ValueNode_Animated::Handle node = ValueNode_Animated::create(a, Time(0));
+	node->new_waypoint(end, b);
+	layer->connect_dynamic_param(param, ValueNode::Handle(node));
+}
+
+//! Builds document with groups of circles, rectangles and gradients,
+//! some groups are blurred and all primitives move over the time
+static Canvas::Handle
+build_scene(const SceneOptions &options)
+{
+	const Real fps = 24.0;
+	const Real span = 4.0;
+	const Real aspect = (Real)options.width/options.height;
+	const Time end = Time(options.frames/fps);
+
+	Canvas::Handle canvas = Canvas::create();
+	RendDesc &desc = canvas->rend_desc();
+	desc.set_wh(options.width, options.height);
+	desc.set_tl_br(Point(-span*aspect, span), Point(span*aspect, -span));
+	desc.set_frame_rate(fps);
+	desc.set_time_start(Time(0));
+	desc.set_time_end(end);
+
+	Random random(7);
+	Canvas::Handle group_canvas;
+	for(int i = 0; i < options.layers; ++i) {
+		if (i % GROUP_SIZE == 0) {
+			group_canvas = Canvas::create_inline(canvas);
+			Layer::Handle group = Layer::create("group");
+			group->set_param("canvas", ValueBase(group_canvas));
+			set_animated_param(group, "origin", Vector(), random.vector(0.5), end);
+			canvas->push_front(group);
+
+			if (i % (GROUP_SIZE*4) == GROUP_SIZE) {
+				Layer::Handle blur = Layer::create("blur");
+				blur->set_param("size", Vector(0.1, 0.1));
+				group_canvas->push_back(blur);
+			}
+		}
+
+		Layer::Handle layer;
+		switch(i % 4) {
+		case 0:
+		case 2:
+			layer = Layer::create("circle");
+			layer->set_param("color", random.color());
+			layer->set_param("radius", random.range(0.1, 1.0));
+			set_animated_param(layer, "origin", random.vector(span), random.vector(span), end);
+			break;
+		case 1:
+			layer = Layer::create("rectangle");
+			layer->set_param("color", random.color());
+			set_animated_param(layer, "point1", random.vector(span), random.vector(span), end);
+			layer->set_param("point2", random.vector(span));
+			break;
+		default:
+			layer = Layer::create("linear_gradient");
+			layer->set_param("amount", random.range(0.1, 0.4));
+			layer->set_param("p1", random.vector(span));
+			layer->set_param("p2", random.vector(span));
+			layer->set_param("gradient", Gradient(random.color(), random.color()));
+			break;
+		}
+		if (layer)
+			group_canvas->push_front(layer);
+	}
+	return canvas;
+}
+
+static void
+render_frame(Canvas::Handle canvas, rendering::Renderer::Handle renderer, rendering::SurfaceResource::Handle surface, Time time)
+{
+	const RendDesc &desc = canvas->rend_desc();
+	canvas->set_time(time);
+	canvas->load_resources(time);
+
+	Vector p0 = desc.get_tl();
+	Vector p1 = desc.get_br();
+	ContextParams params;
+	params.render_rect = Rect(p0, p1);
+	rendering::Task::Handle task = canvas->build_rendering_task(params);
+	surface->create(desc.get_w(), desc.get_h());
+	if (!task) return;
+
+	if (p0[0] > p1[0] || p0[1] > p1[1]) {
+		Matrix m;
+		if (p0[0] > p1[0]) { m.m00 = -1.0; m.m20 = p0[0] + p1[0]; std::swap(p0[0], p1[0]); }
+		if (p0[1] > p1[1]) { m.m11 = -1.0; m.m21 = p0[1] + p1[1]; std::swap(p0[1], p1[1]); }
+		rendering::TaskTransformationAffine::Handle t = new rendering::TaskTransformationAffine();
+		t->transformation->matrix = m;
+		t->sub_task() = task;
+		task = t;
+	}
+
+	task->target_surface = surface;
+	task->target_rect = RectInt(VectorInt(), surface->get_size());
+	task->source_rect = Rect(p0, p1);
+	renderer->run(task, true);
+}
+
+void
+bench::run_scene_benchmarks(Runner &runner, const SceneOptions &options)
+{
+	const String suffix = etl::strprintf("/%dl_%dx%d", options.layers, options.width, options.height);
+	const String load_name   = "scene/load"     + suffix;
+	const String time_name   = "scene/set_time" + suffix;
+	const String render_name = "scene/render"   + suffix;
+	if ( !runner.is_enabled(load_name)
+	  && !runner.is_enabled(time_name)
+	  && !runner.is_enabled(render_name) )
+		return;
+
+	Canvas::Handle canvas = build_scene(options);
+	const RendDesc &desc = canvas->rend_desc();
+	const int frames = std::max(1, options.frames);
+
+	// loading is measured with the document saved into temporary file
+	if (runner.is_enabled(load_name)) {
+		String filename = Glib::build_filename(
+			Glib::get_tmp_dir(), etl::strprintf("synfig-bench-%d.sif", (int)options.layers) );
+		FileSystem::Identifier identifier = FileSystemNative::instance()->get_identifier(filename);
+		if (save_canvas(identifier, canvas)) {
+			runner.measure(
+				load_name,
+				[&]() {
+					String errors, warnings;
+					Canvas::Handle loaded = open_canvas_as(identifier, filename, errors, warnings);
+					if (!loaded)
+						fprintf(stderr, "Cannot load scene: %s\n", errors.c_str());
+				},
+				options.layers );
+		} else {
+			fprintf(stderr, "Cannot save scene to \"%s\"\n", filename.c_str());
+		}
+		remove(filename.c_str());
+	}
+
+	int frame = 0;
+	runner.measure(
+		time_name,
+		[&]() { canvas->set_time(Time(frame++ % frames)/desc.get_frame_rate()); },
+		options.layers );
+
+	rendering::Renderer::Handle renderer = rendering::Renderer::get_renderer("software");
+	if (!renderer) {
+		fprintf(stderr, "Renderer \"software\" not found\n");
+		return;
+	}
+	rendering::SurfaceResource::Handle surface = new rendering::SurfaceResource();
+	runner.measure(
+		render_name,
+		[&]() { render_frame(canvas, renderer, surface, Time(frame++ % frames)/desc.get_frame_rate()); },
+		(double)desc.get_w()*desc.get_h() );
+}
+
+/* === E N T R Y P O I N T ================================================= */
@@ -83,6 +83,7 @@ public:
 	Layer::Handle hit_check(Context context, const Point &point)const;
 
 	virtual Vocab get_param_vocab()const;
+	virtual Real get_rendering_neighbourhood()const { return 0.0; }
 
 protected:
 	virtual RendDesc get_sub_renddesc_vfunc(const RendDesc &renddesc) const;
@@ -0,0 +1,167 @@
+/* === S Y N F I G ========================================================= */
+/*!	\file escapetime.h
+**	\brief Batched escape-time iterations for the fractal layers
+**
+**	$Id$
+**
+**	\legal
+**	......... ... 2026 Synfig contributors
+**
+**	This package is free software; you can redistribute it and/or
+**	modify it under the terms of the GNU General Public License as
+**	published by the Free Software Foundation; either version 2 of
+**	the License, or (at your option) any later version.
+**
+**	This package is distributed in the hope that it will be useful,
+**	but WITHOUT ANY WARRANTY; without even the implied warranty of
+**	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+**	General Public License for more details.
+**	\endlegal
+*/
+/* ========================================================================= */
+
+/* === S T A R T =========================================================== */
+
+#ifndef __SYNFIG_LYR_STD_ESCAPETIME_H
+#define __SYNFIG_LYR_STD_ESCAPETIME_H
+
+/* === H E A D E R S ======================================================= */
+
+#include <algorithm>
+#include <cmath>
+
+#include <synfig/color.h>
+#include <synfig/matrix.h>
+#include <synfig/rect.h>
+#include <synfig/surface.h>
+
+/* === M A C R O S ========================================================= */
+
+/* === T Y P E D E F S ===================================================== */
+
+/* === C L A S S E S & S T R U C T S ======================================= */
+
+namespace synfig
+{
+namespace modules
+{
+namespace lyr_std
+{
+
+//! Batch of points for iterations z = z*z + c
+/*! Lanes are processed by plain loops over fixed-size arrays without
+**  data dependent branches, so compiler is able to vectorize them.
+**  Iterations stop when all of the lanes are escaped. */
+template<typename T>
+class EscapeTime
+{
+public:
+	enum { LANES = 8 };
+
+	T zr[LANES], zi[LANES];	//!< initial z, then z at escape or after the last iteration
+	T cr[LANES], ci[LANES];
+	ColorReal mag[LANES];	//!< squared magnitude of z
+	int escape[LANES];		//!< iteration of escape, -1 if point stays inside of the set
+
+	//! \param broken_after_zi selects variant of "broken" formula, true for Julia and false for Mandelbrot
+	void iterate(int count, int iterations, Real bailout, bool broken, bool broken_after_zi)
+	{
+		bool active[LANES];
+		for(int l = 0; l < LANES; ++l)
+			{ mag[l] = 0; escape[l] = -1; active[l] = l < count; }
+
+		int remaining = std::min(count, (int)LANES);
+		for(int i = 0; i < iterations && remaining > 0; ++i)
+		{
+			for(int l = 0; l < LANES; ++l)
+			{
+				T r = zr[l]*zr[l] - zi[l]*zi[l] + cr[l];
+				T m = zr[l]*zi[l]*2 + ci[l];
+				if (broken) r += broken_after_zi ? m : zi[l];
+				ColorReal mg = (ColorReal)(r*r + m*m);
+
+				bool a = active[l];
+				bool e = a && mg > bailout;
+				zr[l] = a ? r : zr[l];
+				zi[l] = a ? m : zi[l];
+				mag[l] = a ? mg : mag[l];
+				escape[l] = e ? i : escape[l];
+				active[l] = a && !e;
+			}
+
+			remaining = 0;
+			for(int l = 0; l < LANES; ++l)
+				remaining += active[l];
+		}
+	}
+};
+
+//! Returns true if float is precise enough to iterate points of \a rect transformed by \a matrix
+inline bool
+escape_time_float_precision(const Matrix &matrix, const RectInt &rect)
+{
+	Real range = 2.0;
+	Vector corners[] = {
+		matrix.get_transformed(Vector(rect.minx, rect.miny)),
+		matrix.get_transformed(Vector(rect.maxx, rect.miny)),
+		matrix.get_transformed(Vector(rect.minx, rect.maxy)),
+		matrix.get_transformed(Vector(rect.maxx, rect.maxy)) };
+	for(int i = 0; i < 4; ++i)
+		range = std::max(range, std::max(std::fabs(corners[i][0]), std::fabs(corners[i][1])));
+
+	// iterations amplify rounding errors, so keep a wide margin
+	Real pixel = std::min(matrix.axis_x().mag(), matrix.axis_y().mag());
+	return pixel > range*1e-4;
+}
+
+//! Renders escape-time fractal into \a rect of \a surface
+/*! \a matrix transforms pixels into the plane of the fractal.
+**  \a julia selects starting point: z = pos and c = \a seed for Julia set,
+**  z = 0 and c = pos for Mandelbrot set.
+**  \a params should provide method:
+**    Color shade(int escape, Real zr, Real zi, ColorReal mag) const */
+template<typename T, typename P>
+void
+render_escape_time(
+	synfig::Surface &surface,
+	const RectInt &rect,
+	const Matrix &matrix,
+	const P &params,
+	int iterations,
+	Real bailout,
+	bool broken,
+	bool julia,
+	const Point &seed )
+{
+	const int lanes = EscapeTime<T>::LANES;
+	EscapeTime<T> batch;
+	for(int y = rect.miny; y < rect.maxy; ++y)
+	{
+		Color *row = surface[y];
+		for(int x = rect.minx; x < rect.maxx; x += lanes)
+		{
+			int count = std::min(lanes, rect.maxx - x);
+			for(int l = 0; l < lanes; ++l)
+			{
+				Point p = matrix.get_transformed(Vector(x + std::min(l, count - 1) + 0.5, y + 0.5));
+				batch.zr[l] = julia ? (T)p[0] : T();
+				batch.zi[l] = julia ? (T)p[1] : T();
+				batch.cr[l] = (T)(julia ? seed[0] : p[0]);
+				batch.ci[l] = (T)(julia ? seed[1] : p[1]);
+			}
+
+			batch.iterate(count, iterations, bailout, broken, julia);
+
+			for(int l = 0; l < count; ++l)
+				row[x + l] = params.shade(batch.escape[l], batch.zr[l], batch.zi[l], batch.mag[l]);
+		}
+	}
+}
+
+}; // END of namespace lyr_std
+}; // END of namespace modules
+}; // END of namespace synfig
+
+/* === E N D =============================================================== */
+
+#endif
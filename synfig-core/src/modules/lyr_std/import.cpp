@@ -167,6 +167,7 @@ Import::set_param(const String & param, const ValueBase &value)
 
 		rendering_surface = new rendering::SurfaceResource(
 			newimporter->get_frame(get_canvas()->rend_desc(), time) );
+		rendering_surface->seal();
 		importer=newimporter;
 		param_filename.set(filename);
 
@@ -223,7 +224,10 @@ Import::load_resources_vfunc(IndependentContext context, Time time)const
 {
 	Time time_offset=param_time_offset.get(Time());
 	if(get_amount() && importer && importer->is_animated())
+	{
 		rendering_surface = new rendering::SurfaceResource(
 			importer->get_frame(get_canvas()->rend_desc(), time+time_offset) );
+		rendering_surface->seal();
+	}
 	context.load_resources(time);
 }
@@ -65,6 +65,7 @@ public:
 	virtual Color get_color(Context context, const Point &pos)const;
 	Layer::Handle hit_check(Context context, const Point &point)const;
 	virtual Vocab get_param_vocab()const;
+	virtual Real get_rendering_neighbourhood()const { return 0.0; }
 	virtual etl::handle<Transform> get_transform()const;
 
 protected:
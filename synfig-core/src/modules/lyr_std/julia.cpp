@@ -41,8 +41,14 @@
 #include <synfig/context.h>
 #include <synfig/paramdesc.h>
 #include <synfig/renddesc.h>
+#include <synfig/surface.h>
 #include <synfig/value.h>
 
+#include <synfig/rendering/common/task/tasktransformation.h>
+#include <synfig/rendering/software/task/tasksw.h>
+
+#include "escapetime.h"
+
 #endif
 
 using namespace etl;
@@ -96,6 +102,68 @@ color_neg_flip(Color &color)
 	}
 }
 
+namespace {
+
+class TaskJulia: public rendering::Task, public rendering::TaskInterfaceTransformation
+{
+public:
+	typedef etl::handle<TaskJulia> Handle;
+	static Token token;
+	virtual Token::Handle get_token() const { return token.handle(); }
+
+	Julia::Params params;
+	rendering::Holder<rendering::TransformationAffine> transformation;
+
+	virtual rendering::Transformation::Handle get_transformation() const
+		{ return transformation.handle(); }
+};
+
+
+class TaskJuliaSW: public TaskJulia, public rendering::TaskSW,
+	public rendering::TaskInterfaceSplit
+{
+public:
+	typedef etl::handle<TaskJuliaSW> Handle;
+	static Token token;
+	virtual Token::Handle get_token() const { return token.handle(); }
+
+	virtual bool run(RunParams&) const {
+		if (!is_valid())
+			return true;
+
+		Vector ppu = get_pixels_per_unit();
+
+		Matrix bounds_transfromation;
+		bounds_transfromation.m00 = ppu[0];
+		bounds_transfromation.m11 = ppu[1];
+		bounds_transfromation.m20 = target_rect.minx - ppu[0]*source_rect.minx;
+		bounds_transfromation.m21 = target_rect.miny - ppu[1]*source_rect.miny;
+
+		Matrix matrix = bounds_transfromation * transformation->matrix;
+		Matrix inv_matrix = matrix.get_inverted();
+
+		LockWrite la(this);
+		if (!la)
+			return false;
+
+		if (escape_time_float_precision(inv_matrix, target_rect))
+			render_escape_time<float>( la->get_surface(), target_rect, inv_matrix, params,
+				params.iterations, 4.0, params.broken, true, params.seed );
+		else
+			render_escape_time<double>( la->get_surface(), target_rect, inv_matrix, params,
+				params.iterations, 4.0, params.broken, true, params.seed );
+
+		return true;
+	}
+};
+
+rendering::Task::Token TaskJulia::token(
+	DescAbstract<TaskJulia>("Julia") );
+rendering::Task::Token TaskJuliaSW::token(
+	DescReal<TaskJuliaSW, TaskJulia>("JuliaSW") );
+
+} // namespace
+
 /* === M E T H O D S ======================================================= */
 
 Julia::Julia():
@@ -225,46 +293,105 @@ Julia::get_sub_renddesc_vfunc(const RendDesc &renddesc) const
 	return desc;
 }
 
+void
+Julia::fill_params(Params &params)const
+{
+	params.icolor=param_icolor.get(Color());
+	params.ocolor=param_ocolor.get(Color());
+	params.color_shift=param_color_shift.get(Angle());
+	params.iterations=param_iterations.get(int());
+	params.seed=param_seed.get(Point());
+	params.distort_inside=param_distort_inside.get(bool());
+	params.shade_inside=param_shade_inside.get(bool());
+	params.solid_inside=param_solid_inside.get(bool());
+	params.invert_inside=param_invert_inside.get(bool());
+	params.color_inside=param_color_inside.get(bool());
+	params.distort_outside=param_distort_outside.get(bool());
+	params.shade_outside=param_shade_outside.get(bool());
+	params.solid_outside=param_solid_outside.get(bool());
+	params.invert_outside=param_invert_outside.get(bool());
+	params.color_outside=param_color_outside.get(bool());
+	params.color_cycle=param_color_cycle.get(bool());
+	params.smooth_outside=param_smooth_outside.get(bool());
+	params.broken=param_broken.get(bool());
+}
+
 Color
-Julia::get_color(Context context, const Point &pos)const
+Julia::Params::shade(int escape, Real zr, Real zi, ColorReal mag, const Color &context_color)const
 {
-	Color icolor=param_icolor.get(Color());
-	Color ocolor=param_ocolor.get(Color());
-	Angle color_shift=param_color_shift.get(Angle());
-	int iterations=param_iterations.get(int());
-	Point seed=param_seed.get(Point());
-	bool distort_inside=param_distort_inside.get(bool());
-	bool shade_inside=param_shade_inside.get(bool());
-	bool solid_inside=param_solid_inside.get(bool());
-	bool invert_inside=param_invert_inside.get(bool());
-	bool color_inside=param_color_inside.get(bool());
-	bool distort_outside=param_distort_outside.get(bool());
-	bool shade_outside=param_shade_outside.get(bool());
-	bool solid_outside=param_solid_outside.get(bool());
-	bool invert_outside=param_invert_outside.get(bool());
-	bool color_outside=param_color_outside.get(bool());
-
-	bool color_cycle=param_color_cycle.get(bool());
-	bool smooth_outside=param_smooth_outside.get(bool());
-	bool broken=param_broken.get(bool());
+	Color ret;
+
+	if(escape>=0)
+	{
+		ColorReal depth;
+		if(smooth_outside)
+		{
+			// Darco's original mandelbrot smoothing algo
+			// depth=((Point::value_type)i+(2.0-sqrt(mag))/PI);
+
+			// Linas Vepstas algo (Better than darco's)
+			// See (http://linas.org/art-gallery/escape/smooth.html)
+			depth= (ColorReal)escape - log(log(sqrt(mag))) / LOG_OF_2;
+
+			// Clamp
+			if(depth<0) depth=0;
+		}
+		else
+			depth=static_cast<ColorReal>(escape);
+
+		ret=solid_outside ? ocolor : context_color;
+
+		if(invert_outside)
+			ret=~ret;
+
+		if(color_outside)
+			ret=ret.set_uv(zr,zi).clamped_negative();
+
+		if(color_cycle)
+			ret=ret.rotate_uv(color_shift.operator*(depth)).clamped_negative();
+
+		if(shade_outside)
+		{
+			ColorReal alpha=depth/static_cast<ColorReal>(iterations);
+			ret=(ocolor-ret)*alpha+ret;
+		}
+		return ret;
+	}
+
+	ret=solid_inside ? icolor : context_color;
+
+	if(invert_inside)
+		ret=~ret;
+
+	if(color_inside)
+		ret=ret.set_uv(zr,zi).clamped_negative();
+
+	if(shade_inside)
+		ret=(icolor-ret)*mag+ret;
+
+	return ret;
+}
 
+Color
+Julia::color_func(const Params &params, Context context, const Point &pos, const Color *context_color)const
+{
 	Real
 		cr, ci,
 		zr, zi,
 		zr_hold;
 
 	ColorReal
-		depth, mag(0);
+		mag(0);
 
-	Color
-		ret;
+	int
+		escape(-1);
 
-	cr=seed[0];
-	ci=seed[1];
+	cr=params.seed[0];
+	ci=params.seed[1];
 	zr=pos[0];
 	zi=pos[1];
 
-	for(int i=0;i<iterations;i++)
+	for(int i=0;i<params.iterations;i++)
 	{
 		// Perform complex multiplication
 		zr_hold=zr;
@@ -272,72 +399,53 @@ Julia::get_color(Context context, const Point &pos)const
 		zi=zr_hold*zi*2 + ci;
 
 		// Use "broken" algorithm, if requested (looks weird)
-		if(broken)zr+=zi;
+		if(params.broken)zr+=zi;
 
 		// Calculate Magnitude
 		mag=zr*zr+zi*zi;
 
 		if(mag>4)
-		{
-			if(smooth_outside)
-			{
-				// Darco's original mandelbrot smoothing algo
-				// depth=((Point::value_type)i+(2.0-sqrt(mag))/PI);
-
-				// Linas Vepstas algo (Better than darco's)
-				// See (http://linas.org/art-gallery/escape/smooth.html)
-				depth= (ColorReal)i - log(log(sqrt(mag))) / LOG_OF_2;
-
-				// Clamp
-				if(depth<0) depth=0;
-			}
-			else
-				depth=static_cast<ColorReal>(i);
-
-			if(solid_outside)
-				ret=ocolor;
-			else
-				if(distort_outside)
-					ret=context.get_color(Point(zr,zi));
-				else
-					ret=context.get_color(pos);
-
-			if(invert_outside)
-				ret=~ret;
-
-			if(color_outside)
-				ret=ret.set_uv(zr,zi).clamped_negative();
-
-			if(color_cycle)
-				ret=ret.rotate_uv(color_shift.operator*(depth)).clamped_negative();
-
-			if(shade_outside)
-			{
-				ColorReal alpha=depth/static_cast<ColorReal>(iterations);
-				ret=(ocolor-ret)*alpha+ret;
-			}
-			return ret;
-		}
+			{ escape=i; break; }
 	}
 
-	if(solid_inside)
-		ret=icolor;
-	else
-		if(distort_inside)
+	bool solid = escape>=0 ? params.solid_outside : params.solid_inside;
+	bool distort = escape>=0 ? params.distort_outside : params.distort_inside;
+	Color ret;
+	if(!solid)
+	{
+		if(distort)
 			ret=context.get_color(Point(zr,zi));
 		else
-			ret=context.get_color(pos);
-
-	if(invert_inside)
-		ret=~ret;
+			ret=context_color ? *context_color : context.get_color(pos);
+	}
 
-	if(color_inside)
-		ret=ret.set_uv(zr,zi).clamped_negative();
+	return params.shade(escape, zr, zi, mag, ret);
+}
 
-	if(shade_inside)
-		ret=(icolor-ret)*mag+ret;
+Color
+Julia::get_color(Context context, const Point &pos)const
+{
+	Params params;
+	fill_params(params);
+	return color_func(params, context, pos, NULL);
+}
 
-	return ret;
+void
+Julia::get_color_span(Context context, const Point &start, const Vector &step, int count, Color *out)const
+{
+	Params params;
+	fill_params(params);
+
+	// fetch the whole span of context at once when undistorted context is visible
+	const bool use_context =
+	    (!params.solid_inside && !params.distort_inside)
+	 || (!params.solid_outside && !params.distort_outside);
+	if (use_context)
+		context.get_color_span(start, step, count, out);
+
+	Point pos = start;
+	for(Color *i = out, *end = out + count; i != end; ++i, pos += step)
+		*i = color_func(params, context, pos, use_context ? i : NULL);
 }
 
 Layer::Vocab
@@ -412,3 +520,18 @@ Julia::get_param_vocab()const
 
 	return ret;
 }
+
+rendering::Task::Handle
+Julia::build_rendering_task_vfunc(Context context) const
+{
+	Params params;
+	fill_params(params);
+
+	// batched iterations fill the whole surface, so context must be invisible
+	if (!params.is_solid())
+		return Layer::build_rendering_task_vfunc(context);
+
+	TaskJulia::Handle task(new TaskJulia());
+	task->params = params;
+	return task;
+}
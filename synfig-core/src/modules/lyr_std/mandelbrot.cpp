@@ -40,8 +40,14 @@
 #include <synfig/context.h>
 #include <synfig/paramdesc.h>
 #include <synfig/renddesc.h>
+#include <synfig/surface.h>
 #include <synfig/value.h>
 
+#include <synfig/rendering/common/task/tasktransformation.h>
+#include <synfig/rendering/software/task/tasksw.h>
+
+#include "escapetime.h"
+
 #endif
 
 using namespace etl;
@@ -95,6 +101,69 @@ color_neg_flip(Color &color)
 	}
 }
 
+namespace {
+
+class TaskMandelbrot: public rendering::Task, public rendering::TaskInterfaceTransformation
+{
+public:
+	typedef etl::handle<TaskMandelbrot> Handle;
+	static Token token;
+	virtual Token::Handle get_token() const { return token.handle(); }
+
+	Mandelbrot::Params params;
+	rendering::Holder<rendering::TransformationAffine> transformation;
+
+	virtual rendering::Transformation::Handle get_transformation() const
+		{ return transformation.handle(); }
+};
+
+
+class TaskMandelbrotSW: public TaskMandelbrot, public rendering::TaskSW,
+	public rendering::TaskInterfaceSplit
+{
+public:
+	typedef etl::handle<TaskMandelbrotSW> Handle;
+	static Token token;
+	virtual Token::Handle get_token() const { return token.handle(); }
+
+	virtual bool run(RunParams&) const {
+		if (!is_valid())
+			return true;
+
+		Vector ppu = get_pixels_per_unit();
+
+		Matrix bounds_transfromation;
+		bounds_transfromation.m00 = ppu[0];
+		bounds_transfromation.m11 = ppu[1];
+		bounds_transfromation.m20 = target_rect.minx - ppu[0]*source_rect.minx;
+		bounds_transfromation.m21 = target_rect.miny - ppu[1]*source_rect.miny;
+
+		Matrix matrix = bounds_transfromation * transformation->matrix;
+		Matrix inv_matrix = matrix.get_inverted();
+
+		LockWrite la(this);
+		if (!la)
+			return false;
+
+		// deep zoom needs double, otherwise twice more lanes fit into vector registers
+		if (escape_time_float_precision(inv_matrix, target_rect))
+			render_escape_time<float>( la->get_surface(), target_rect, inv_matrix, params,
+				params.iterations, params.bailout, params.broken, false, Point() );
+		else
+			render_escape_time<double>( la->get_surface(), target_rect, inv_matrix, params,
+				params.iterations, params.bailout, params.broken, false, Point() );
+
+		return true;
+	}
+};
+
+rendering::Task::Token TaskMandelbrot::token(
+	DescAbstract<TaskMandelbrot>("Mandelbrot") );
+rendering::Task::Token TaskMandelbrotSW::token(
+	DescReal<TaskMandelbrotSW, TaskMandelbrot>("MandelbrotSW") );
+
+} // namespace
+
 /* === M E T H O D S ======================================================= */
 
 Mandelbrot::Mandelbrot():
@@ -307,119 +376,178 @@ Mandelbrot::get_sub_renddesc_vfunc(const RendDesc &renddesc) const
 	return desc;
 }
 
+void
+Mandelbrot::fill_params(Params &params)const
+{
+	params.iterations=param_iterations.get(int());
+	params.bailout=param_bailout.get(Real());
+	params.broken=param_broken.get(bool());
+	params.distort_inside=param_distort_inside.get(bool());
+	params.shade_inside=param_shade_inside.get(bool());
+	params.solid_inside=param_solid_inside.get(bool());
+	params.invert_inside=param_invert_inside.get(bool());
+	params.gradient_inside=param_gradient_inside.get(Gradient());
+	params.gradient_offset_inside=param_gradient_offset_inside.get(Real());
+	params.gradient_loop_inside=param_gradient_loop_inside.get(bool());
+	params.distort_outside=param_distort_outside.get(bool());
+	params.shade_outside=param_shade_outside.get(bool());
+	params.solid_outside=param_solid_outside.get(bool());
+	params.invert_outside=param_invert_outside.get(bool());
+	params.gradient_outside=param_gradient_outside.get(Gradient());
+	params.smooth_outside=param_smooth_outside.get(bool());
+	params.gradient_offset_outside=param_gradient_offset_outside.get(Real());
+	params.gradient_scale_outside=param_gradient_scale_outside.get(Real());
+	params.lp=lp;
+}
+
 Color
-Mandelbrot::get_color(Context context, const Point &pos)const
+Mandelbrot::Params::shade(int escape, Real zr, Real zi, ColorReal mag, const Color &context_color)const
+{
+	Color ret;
+
+	if(escape>=0)
+	{
+		ColorReal depth;
+		if(smooth_outside)
+		{
+			// Darco's original mandelbrot smoothing algo
+			// depth=((Point::value_type)i+(2.0-sqrt(mag))/PI);
+
+			// Linas Vepstas algo (Better than darco's)
+			// See (http://linas.org/art-gallery/escape/smooth.html)
+			depth= (ColorReal)escape + LOG_OF_2*lp - log(log(sqrt(mag))) / LOG_OF_2;
+
+			// Clamp
+			if(depth<0) depth=0;
+		}
+		else
+			depth=static_cast<ColorReal>(escape);
+
+		ColorReal amount(depth/static_cast<ColorReal>(iterations));
+		amount=amount*gradient_scale_outside+gradient_offset_outside;
+		amount-=floor(amount);
+
+		if(solid_outside)
+			ret=gradient_outside(amount);
+		else
+		{
+			ret=context_color;
+
+			if(invert_outside)
+				ret=~ret;
+
+			if(shade_outside)
+				ret=Color::blend(gradient_outside(amount), ret, 1.0);
+		}
+
+		return ret;
+	}
+
+	ColorReal amount(abs(mag+gradient_offset_inside));
+	if(gradient_loop_inside)
+		amount-=floor(amount);
+
+	if(solid_inside)
+		ret=gradient_inside(amount);
+	else
+	{
+		ret=context_color;
+
+		if(invert_inside)
+			ret=~ret;
+
+		if(shade_inside)
+			ret=Color::blend(gradient_inside(amount), ret, 1.0);
+	}
+
+	return ret;
+}
+
+Color
+Mandelbrot::color_func(const Params &params, Context context, const Point &pos, const Color *context_color)const
 {
-	int iterations=param_iterations.get(int());
-	Real bailout=param_bailout.get(Real());
-	bool broken=param_broken.get(bool());
-
-	bool distort_inside=param_distort_inside.get(bool());
-	bool shade_inside=param_shade_inside.get(bool());
-	bool solid_inside=param_solid_inside.get(bool());
-	bool invert_inside=param_invert_inside.get(bool());
-	Gradient gradient_inside=param_gradient_inside.get(Gradient());
-	Real gradient_offset_inside=param_gradient_offset_inside.get(Real());
-	bool gradient_loop_inside=param_gradient_loop_inside.get(bool());
-
-	bool distort_outside=param_distort_outside.get(bool());
-	bool shade_outside=param_shade_outside.get(bool());
-	bool solid_outside=param_solid_outside.get(bool());
-	bool invert_outside=param_invert_outside.get(bool());
-	Gradient gradient_outside=param_gradient_outside.get(Gradient());
-	bool smooth_outside=param_smooth_outside.get(bool());
-	Real gradient_offset_outside=param_gradient_offset_outside.get(Real());
-	Real gradient_scale_outside=param_gradient_scale_outside.get(Real());
-	
 	Real
 		cr, ci,
 		zr, zi,
 		zr_hold;
 
 	ColorReal
-		depth, mag(0);
-
-	Color
-		ret;
+		mag(0);
 
+	int
+		escape(-1);
 
 	zr=zi=0;
 	cr=pos[0];
 	ci=pos[1];
 
-	for(int i=0;i<iterations;i++)
+	for(int i=0;i<params.iterations;i++)
 	{
 		// Perform complex multiplication
 		zr_hold=zr;
 		zr=zr*zr-zi*zi + cr;
-		if(broken)zr+=zi; // Use "broken" algorithm, if requested (looks weird)
+		if(params.broken)zr+=zi; // Use "broken" algorithm, if requested (looks weird)
 		zi=zr_hold*zi*2 + ci;
 
 
 		// Calculate Magnitude
 		mag=zr*zr+zi*zi;
 
-		if(mag>bailout)
-		{
-			if(smooth_outside)
-			{
-				// Darco's original mandelbrot smoothing algo
-				// depth=((Point::value_type)i+(2.0-sqrt(mag))/PI);
-
-				// Linas Vepstas algo (Better than darco's)
-				// See (http://linas.org/art-gallery/escape/smooth.html)
-				depth= (ColorReal)i + LOG_OF_2*lp - log(log(sqrt(mag))) / LOG_OF_2;
-
-				// Clamp
-				if(depth<0) depth=0;
-			}
-			else
-				depth=static_cast<ColorReal>(i);
-
-			ColorReal amount(depth/static_cast<ColorReal>(iterations));
-			amount=amount*gradient_scale_outside+gradient_offset_outside;
-			amount-=floor(amount);
-
-			if(solid_outside)
-				ret=gradient_outside(amount);
-			else
-			{
-				if(distort_outside)
-					ret=context.get_color(Point(pos[0]+zr,pos[1]+zi));
-				else
-					ret=context.get_color(pos);
-
-				if(invert_outside)
-					ret=~ret;
-
-				if(shade_outside)
-					ret=Color::blend(gradient_outside(amount), ret, 1.0);
-			}
-
-
-			return ret;
-		}
+		if(mag>params.bailout)
+			{ escape=i; break; }
 	}
 
-	ColorReal amount(abs(mag+gradient_offset_inside));
-	if(gradient_loop_inside)
-		amount-=floor(amount);
-
-	if(solid_inside)
-		ret=gradient_inside(amount);
-	else
+	bool solid = escape>=0 ? params.solid_outside : params.solid_inside;
+	bool distort = escape>=0 ? params.distort_outside : params.distort_inside;
+	Color ret;
+	if(!solid)
 	{
-		if(distort_inside)
+		if(distort)
 			ret=context.get_color(Point(pos[0]+zr,pos[1]+zi));
 		else
-			ret=context.get_color(pos);
+			ret=context_color ? *context_color : context.get_color(pos);
+	}
 
-		if(invert_inside)
-			ret=~ret;
+	return params.shade(escape, zr, zi, mag, ret);
+}
 
-		if(shade_inside)
-			ret=Color::blend(gradient_inside(amount), ret, 1.0);
-	}
+Color
+Mandelbrot::get_color(Context context, const Point &pos)const
+{
+	Params params;
+	fill_params(params);
+	return color_func(params, context, pos, NULL);
+}
 
-	return ret;
+void
+Mandelbrot::get_color_span(Context context, const Point &start, const Vector &step, int count, Color *out)const
+{
+	Params params;
+	fill_params(params);
+
+	// fetch the whole span of context at once when undistorted context is visible
+	const bool use_context =
+	    (!params.solid_inside && !params.distort_inside)
+	 || (!params.solid_outside && !params.distort_outside);
+	if (use_context)
+		context.get_color_span(start, step, count, out);
+
+	Point pos = start;
+	for(Color *i = out, *end = out + count; i != end; ++i, pos += step)
+		*i = color_func(params, context, pos, use_context ? i : NULL);
+}
+
+rendering::Task::Handle
+Mandelbrot::build_rendering_task_vfunc(Context context) const
+{
+	Params params;
+	fill_params(params);
+
+	// batched iterations fill the whole surface, so context must be invisible
+	if (!params.is_solid())
+		return Layer::build_rendering_task_vfunc(context);
+
+	TaskMandelbrot::Handle task(new TaskMandelbrot());
+	task->params = params;
+	return task;
 }
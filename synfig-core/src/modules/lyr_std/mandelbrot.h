@@ -91,16 +91,54 @@ private:
 	//!Parameter: (Real)
 	ValueBase param_gradient_scale_outside;
 
+public:
+	struct Params
+	{
+		int iterations;
+		Real bailout;
+		bool broken;
+		bool distort_inside;
+		bool shade_inside;
+		bool solid_inside;
+		bool invert_inside;
+		Gradient gradient_inside;
+		Real gradient_offset_inside;
+		bool gradient_loop_inside;
+		bool distort_outside;
+		bool shade_outside;
+		bool solid_outside;
+		bool invert_outside;
+		Gradient gradient_outside;
+		bool smooth_outside;
+		Real gradient_offset_outside;
+		Real gradient_scale_outside;
+		Real lp;	//!< log(log(bailout))
+
+		//! Returns true if context is not visible
+		bool is_solid() const { return solid_inside && solid_outside; }
+		//! Colors the point by result of iterations (\a escape is -1 for points of the set),
+		//! \a context_color is used only when the set is not solid there
+		Color shade(int escape, Real zr, Real zi, ColorReal mag, const Color &context_color = Color())const;
+	};
+
+private:
+	void fill_params(Params &params)const;
+	//! Calculates color at \a pos, \a context_color is the color of context at \a pos if it is already known
+	Color color_func(const Params &params, Context context, const Point &pos, const Color *context_color)const;
+
 public:
 	Mandelbrot();
 
 	virtual bool set_param(const String &param, const ValueBase &value);
 	virtual ValueBase get_param(const String &param)const;
 	virtual Color get_color(Context context, const Point &pos)const;
+	virtual void get_color_span(Context context, const Point &start, const Vector &step, int count, Color *out)const;
 	virtual Vocab get_param_vocab()const;
+	virtual Real get_rendering_neighbourhood()const { return 0.0; }
 
 protected:
 	virtual RendDesc get_sub_renddesc_vfunc(const RendDesc &renddesc) const;
+	virtual rendering::Task::Handle build_rendering_task_vfunc(Context context) const;
 };
 
 }; // END of namespace lyr_std
@@ -85,6 +85,7 @@ public:
 	virtual Rect get_bounding_rect()const;
 
 	virtual Vocab get_param_vocab()const;
+	virtual Real get_rendering_neighbourhood()const { return 0.0; }
 	virtual etl::handle<Transform> get_transform()const;
 
 protected:
@@ -63,6 +63,20 @@ SYNFIG_LAYER_SET_VERSION(XORPattern,"0.1");
 
 /* === P R O C E D U R E S ================================================= */
 
+static inline Color
+xor_color(const Point &origin, const Point &size, const Point &point)
+{
+	unsigned int a=(unsigned int)floor((point[0]-origin[0])/size[0]), b=(unsigned int)floor((point[1]-origin[1])/size[1]);
+	unsigned char rindex=(a^b);
+	unsigned char gindex=(a^(~b))*4;
+	unsigned char bindex=~(a^b)*2;
+
+	return Color((Color::value_type)rindex/(Color::value_type)255.0,
+				 (Color::value_type)gindex/(Color::value_type)255.0,
+				 (Color::value_type)bindex/(Color::value_type)255.0,
+				 1.0);
+}
+
 /* === M E T H O D S ======================================================= */
 
 XORPattern::XORPattern():
@@ -107,15 +121,7 @@ XORPattern::get_color(Context context, const Point &point)const
 	if(get_amount()==0.0)
 		return context.get_color(point);
 
-	unsigned int a=(unsigned int)floor((point[0]-origin[0])/size[0]), b=(unsigned int)floor((point[1]-origin[1])/size[1]);
-	unsigned char rindex=(a^b);
-	unsigned char gindex=(a^(~b))*4;
-	unsigned char bindex=~(a^b)*2;
-
-	Color color((Color::value_type)rindex/(Color::value_type)255.0,
-				(Color::value_type)gindex/(Color::value_type)255.0,
-				(Color::value_type)bindex/(Color::value_type)255.0,
-				1.0);
+	Color color(xor_color(origin, size, point));
 
 	if(get_amount() == 1 && get_blend_method() == Color::BLEND_STRAIGHT)
 		return color;
@@ -124,6 +130,25 @@ XORPattern::get_color(Context context, const Point &point)const
 
 }
 
+void
+XORPattern::get_color_span(Context context, const Point &start, const Vector &step, int count, Color *out)const
+{
+	Point origin=param_origin.get(Point());
+	Point size=param_size.get(Point());
+
+	const bool straight = get_amount() == 1 && get_blend_method() == Color::BLEND_STRAIGHT;
+	if (!straight)
+		context.get_color_span(start, step, count, out);
+	if (get_amount() == 0.0)
+		return;
+
+	Point point = start;
+	for(Color *i = out, *end = out + count; i != end; ++i, point += step)
+		*i = straight
+		   ? xor_color(origin, size, point)
+		   : Color::blend(xor_color(origin, size, point), *i, get_amount(), get_blend_method());
+}
+
 Layer::Vocab
 XORPattern::get_param_vocab()const
 {
@@ -65,7 +65,9 @@ public:
 	virtual bool set_param(const String &param, const ValueBase &value);
 	virtual ValueBase get_param(const String &param)const;
 	virtual Color get_color(Context context, const Point &pos)const;
+	virtual void get_color_span(Context context, const Point &start, const Vector &step, int count, Color *out)const;
 	virtual Vocab get_param_vocab()const;
+	virtual Real get_rendering_neighbourhood()const { return 0.0; }
 	virtual Layer::Handle hit_check(Context context, const Point &point)const;
 };
 
@@ -209,6 +209,9 @@ bmp::end_frame()
 bool
 bmp::start_frame(synfig::ProgressCallback *callback)
 {
+	if(!get_frame_list().empty())
+		imagecount=get_frame_number();
+
 	int w=desc.get_w(),h=desc.get_h();
 
 	rowspan=4*((w*(pixel_size(pf)*8)+31)/32);
@@ -320,6 +320,25 @@ CheckerBoard::get_color(Context context, const Point &getpos)const
 		return Color::blend(Color::alpha(),context.get_color(getpos),get_amount(),get_blend_method());
 }
 
+void
+CheckerBoard::get_color_span(Context context, const Point &start, const Vector &step, int count, Color *out)const
+{
+	Color color=param_color.get(Color());
+
+	// uncovered squares always show the context
+	context.get_color_span(start, step, count, out);
+
+	const bool straight = get_amount()==1.0 && get_blend_method()==Color::BLEND_STRAIGHT;
+	Point pos = start;
+	for(Color *i = out, *end = out + count; i != end; ++i, pos += step)
+	{
+		if(get_amount()!=0.0 && point_test(pos))
+			*i = straight ? color : Color::blend(color,*i,get_amount(),get_blend_method());
+		else
+			*i = Color::blend(Color::alpha(),*i,get_amount(),get_blend_method());
+	}
+}
+
 rendering::Task::Handle
 CheckerBoard::build_composite_task_vfunc(ContextParams /*context_params*/)const
 {
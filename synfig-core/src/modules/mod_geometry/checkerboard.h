@@ -64,6 +64,7 @@ public:
 	virtual synfig::ValueBase get_param(const synfig::String & param)const;
 
 	virtual synfig::Color get_color(synfig::Context context, const synfig::Point &pos)const;
+	virtual void get_color_span(synfig::Context context, const synfig::Point &start, const synfig::Vector &step, int count, synfig::Color *out)const;
 
 	virtual Vocab get_param_vocab()const;
 
@@ -81,6 +81,7 @@ gif::gif(const char *filename_, const synfig::TargetParam & /* params */):
 
 gif::~gif()
 {
+	wait_encoder();
 	if(file)
 		fputc(';',file.get());	// Image terminator
 }
@@ -204,7 +205,7 @@ gif::start_frame(synfig::ProgressCallback *callback)
 }
 
 void
-gif::end_frame()
+gif::encode_frame(int frame)
 {
 	int w = desc.get_w(), h = desc.get_h();
 	unsigned int value;
@@ -217,12 +218,12 @@ gif::end_frame()
 	// Fill in the background color
 	if(get_alpha_mode()==TARGET_ALPHA_MODE_KEEP)
 	{
-		Surface::alpha_pen pen(curr_surface.begin(),1.0,Color::BLEND_BEHIND);
-		pen.set_value(get_canvas()->rend_desc().get_bg_color());
-		for(int y=0;y<curr_surface.get_h();y++,pen.inc_y())
+		Surface::alpha_pen pen(encode_surface.begin(),1.0,Color::BLEND_BEHIND);
+		pen.set_value(bg_color);
+		for(int y=0;y<encode_surface.get_h();y++,pen.inc_y())
 		{
 			int x;
-			for(x=0;x<curr_surface.get_w();x++,pen.inc_x())
+			for(x=0;x<encode_surface.get_w();x++,pen.inc_x())
 			{
 				if(pen.get_value().get_a()>0.1)
 					pen.put_value();
@@ -235,7 +236,7 @@ gif::end_frame()
 
 	if(local_palette)
 	{
-		curr_palette = Palette(curr_surface, 256/(1<<(8-rootsize)) - build_off_previous - 1, Gamma());
+		curr_palette = Palette(encode_surface, 256/(1<<(8-rootsize)) - build_off_previous - 1, Gamma());
 		synfig::info("curr_palette.size()=%d",curr_palette.size());
 	}
 
@@ -320,22 +321,22 @@ gif::end_frame()
 		// Now we compress it!
 		for(int i=0; i < w; ++i)
 		{
-			Color color(curr_surface[cur_scanline][i].clamped());
+			Color color(encode_surface[cur_scanline][i].clamped());
 			Palette::iterator iter(curr_palette.find_closest(color, Gamma()));
 
 			if(dithering)
 			{
 				Color error(color-iter->color);
 				//error*=0.25;
-				if(curr_surface.get_h()>cur_scanline+1)
+				if(encode_surface.get_h()>cur_scanline+1)
 				{
-					curr_surface[cur_scanline+1][i-1]  += error * ((float)3/(float)16);
-					curr_surface[cur_scanline+1][i]    += error * ((float)5/(float)16);
-					if(curr_surface.get_w()>i+1)
-						curr_surface[cur_scanline+1][i+1]  += error * ((float)1/(float)16);
+					encode_surface[cur_scanline+1][i-1]  += error * ((float)3/(float)16);
+					encode_surface[cur_scanline+1][i]    += error * ((float)5/(float)16);
+					if(encode_surface.get_w()>i+1)
+						encode_surface[cur_scanline+1][i+1]  += error * ((float)1/(float)16);
 				}
-				if(curr_surface.get_w()>i+1)
-					curr_surface[cur_scanline][i+1]    += error * ((float)7/(float)16);
+				if(encode_surface.get_w()>i+1)
+					encode_surface[cur_scanline][i+1]    += error * ((float)7/(float)16);
 			}
 
 			curr_frame[cur_scanline][i]=iter-curr_palette.begin();
@@ -359,7 +360,7 @@ gif::end_frame()
 						abs( ( iter->color-prev_palette[prev_frame[cur_scanline][i]-1].color ).get_y() ) > (1.0/16.0) ||
 //						abs((int)value-(int)prev_frame[cur_scanline][i])>2||
 //						(value<=2 && value!=prev_frame[cur_scanline][i]) ||
-						(imagecount%iframe_density)==0 || imagecount==desc.get_frame_end()-1 ) // lossy version
+						(frame%iframe_density)==0 || frame==desc.get_frame_end()-1 ) // lossy version
 						prev_frame[cur_scanline][i]=value;
 					else
 					{
@@ -431,6 +432,25 @@ gif::end_frame()
 	fputc(0,file.get());		// Block terminator
 
 	fflush(file.get());
+}
+
+void
+gif::wait_encoder()
+{
+	if(encoder.joinable())
+		encoder.join();
+}
+
+void
+gif::end_frame()
+{
+	// The frame is quantized and compressed in background while
+	// the next one renders. Only one frame is kept in flight, so
+	// memory does not depend on the length of the animation.
+	wait_encoder();
+	encode_surface=curr_surface;
+	bg_color=get_canvas()->rend_desc().get_bg_color();
+	encoder=std::thread(&gif::encode_frame,this,imagecount);
 	imagecount++;
 }
 
@@ -33,6 +33,7 @@
 #include <synfig/string.h>
 #include <synfig/smartfile.h>
 #include <cstdio>
+#include <thread>
 #include <synfig/surface.h>
 #include <synfig/palette.h>
 #include <synfig/targetparam.h>
@@ -173,6 +174,9 @@ private:
 	lzwcode *table,*next,*node;
 
 	synfig::Surface curr_surface;
+	synfig::Surface encode_surface;	// frame being compressed by the encoder thread
+	synfig::Color bg_color;
+	std::thread encoder;
 	etl::surface<unsigned char> curr_frame;
 	etl::surface<unsigned char> prev_frame;
 
@@ -192,6 +196,9 @@ private:
 	synfig::Palette curr_palette;
 
 	void output_curr_palette();
+	//! Quantizes and compresses encode_surface into the file, runs in the encoder thread
+	void encode_frame(int frame);
+	void wait_encoder();
 
 public:
 	gif(const char *filename, const synfig::TargetParam& /* params */);
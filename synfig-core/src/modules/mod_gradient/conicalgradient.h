@@ -73,11 +73,13 @@ public:
 	virtual ValueBase get_param(const String & param)const;
 
 	virtual Color get_color(Context context, const Point &pos)const;
+	virtual void get_color_span(Context context, const Point &start, const Vector &step, int count, Color *out)const;
 
 	virtual bool accelerated_render(Context context,Surface *surface,int quality, const RendDesc &renddesc, ProgressCallback *cb)const;
 	Layer::Handle hit_check(Context context, const Point &point)const;
 
 	virtual Vocab get_param_vocab()const;
+	virtual Real get_rendering_neighbourhood()const { return 0.0; }
 }; // END of class ConicalGradient
 
 /* === E N D =============================================================== */
@@ -86,6 +86,7 @@ public:
 	Layer::Handle hit_check(synfig::Context context, const synfig::Point &point)const;
 
 	virtual Vocab get_param_vocab()const;
+	virtual Real get_rendering_neighbourhood()const { return 0.0; }
 };
 
 /* === E N D =============================================================== */
@@ -195,6 +195,23 @@ LinearGradient::get_color(Context context, const Point &point)const
 		return Color::blend(color,context.get_color(point),get_amount(),get_blend_method());
 }
 
+void
+LinearGradient::get_color_span(Context context, const Point &start, const Vector &step, int count, Color *out)const
+{
+	Params params;
+	fill_params(params);
+
+	const bool straight = get_amount()==1.0 && get_blend_method()==Color::BLEND_STRAIGHT;
+	if (!straight)
+		context.get_color_span(start, step, count, out);
+
+	Point point = start;
+	for(Color *i = out, *end = out + count; i != end; ++i, point += step)
+		*i = straight
+		   ? color_func(params, point)
+		   : Color::blend(color_func(params, point), *i, get_amount(), get_blend_method());
+}
+
 bool
 LinearGradient::accelerated_render(Context context,Surface *surface,int quality, const RendDesc &renddesc, ProgressCallback *cb)const
 {
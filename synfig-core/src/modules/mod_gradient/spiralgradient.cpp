@@ -200,6 +200,20 @@ SpiralGradient::get_color(Context context, const Point &pos)const
 		return Color::blend(color,context.get_color(pos),get_amount(),get_blend_method());
 }
 
+void
+SpiralGradient::get_color_span(Context context, const Point &start, const Vector &step, int count, Color *out)const
+{
+	const bool straight = get_amount()==1.0 && get_blend_method()==Color::BLEND_STRAIGHT;
+	if (!straight)
+		context.get_color_span(start, step, count, out);
+
+	Point pos = start;
+	for(Color *i = out, *end = out + count; i != end; ++i, pos += step)
+		*i = straight
+		   ? color_func(pos)
+		   : Color::blend(color_func(pos), *i, get_amount(), get_blend_method());
+}
+
 bool
 SpiralGradient::accelerated_render(Context context,Surface *surface,int quality, const RendDesc &renddesc, ProgressCallback *cb)const
 {
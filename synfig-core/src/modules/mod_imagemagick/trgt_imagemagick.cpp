@@ -151,6 +151,9 @@ imagemagick_trgt::end_frame()
 bool
 imagemagick_trgt::start_frame(synfig::ProgressCallback *cb)
 {
+	if(!get_frame_list().empty())
+		imagecount=get_frame_number();
+
 	const char *msg=_("Unable to open pipe to imagemagick's convert utility");
 
 	string newfilename;
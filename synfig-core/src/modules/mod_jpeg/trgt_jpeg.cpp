@@ -96,6 +96,9 @@ jpeg_trgt::set_rend_desc(RendDesc *given_desc)
 bool
 jpeg_trgt::start_frame(synfig::ProgressCallback *callback)
 {
+	if(!get_frame_list().empty())
+		imagecount=get_frame_number();
+
 	int w=desc.get_w(),h=desc.get_h();
 
 	if(file && file!=stdout)
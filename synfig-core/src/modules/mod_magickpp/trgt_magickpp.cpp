@@ -31,6 +31,8 @@
 #	include <config.h>
 #endif
 
+#include <cstring>
+
 #include <synfig/general.h>
 
 #include <ETL/misc>
@@ -40,6 +42,10 @@
 
 /* === M A C R O S ========================================================= */
 
+// Frames joined into one file are kept until the end of the render,
+// pixels of frames over this count are cached on disk by ImageMagick
+#define MAX_FRAMES_IN_MEMORY 16
+
 using namespace synfig;
 using namespace etl;
 
@@ -52,6 +58,30 @@ SYNFIG_TARGET_SET_VERSION(magickpp_trgt,"0.1");
 
 /* === M E T H O D S ======================================================= */
 
+//! Checks whether the format of the file can hold multiple images
+static bool
+can_join_images(const String &filename, String &format)
+{
+	bool adjoin = false;
+	MagickCore::ExceptionInfo* exceptionInfo = MagickCore::AcquireExceptionInfo();
+	try
+	{
+		Magick::Image image(Magick::Geometry(1, 1), Magick::Color());
+		image.fileName(filename);
+		SetImageInfo(image.imageInfo(),Magick::MagickTrue,exceptionInfo);
+		adjoin = image.adjoin();
+		format = image.imageInfo()->magick;
+	}
+	catch(Magick::Warning &warning) {
+		synfig::warning("exception '%s'", warning.what());
+	}
+	catch(Magick::Error &error) {
+		synfig::error("exception '%s'", error.what());
+	}
+	MagickCore::DestroyExceptionInfo(exceptionInfo);
+	return adjoin;
+}
+
 template <class Container>
 MagickCore::Image* copy_image_list(Container& container)
 {
@@ -90,31 +120,9 @@ magickpp_trgt::~magickpp_trgt()
 
 	try
 	{
-		bool multiple_images = images.size() > 1;
-		bool can_adjoin = false;
-
-		if (multiple_images)
-		{
-			// check whether this file format supports multiple-image files
-			Magick::Image image(*(images.begin()));
-			image.fileName(filename);
-			try
-			{
-				SetImageInfo(image.imageInfo(),Magick::MagickTrue,exceptionInfo);
-				can_adjoin = image.adjoin();
-			}
-			catch(Magick::Warning &warning) {
-				synfig::warning("exception '%s'", warning.what());
-			}
-		}
-
-		// the file type is now in image.imageInfo()->magick and
-		// image.adjoin() tells us whether we can write to a single file
-		if (can_adjoin)
+		if (images.size() > 1)
 		{
 			synfig::info("joining images");
-			unsigned int delay = round_to_int(100.0 / desc.get_frame_rate());
-			for_each(images.begin(), images.end(), Magick::animationDelayImage(delay));
 
 			// optimize the images (only write the pixels that change from frame to frame
 			// make a completely new image list
@@ -168,23 +176,18 @@ magickpp_trgt::~magickpp_trgt()
 			synfig::info("recreating image list");
 			insertImages(&images, image_list);
 		}
-		else if (multiple_images)
-		{
-			// if we can't write multiple images to a file of this type,
-			// include '%04d' in the filename, so the files will be numbered
-			// with a fixed width, '0'-padded number
-			synfig::info("can't join images of this type - numbering instead");
-			filename = (filename_sans_extension(filename) + sequence_separator + "%04d" + filename_extension(filename));
-		}
 
-		synfig::info("writing %d image%s to %s", images.size(), images.size() == 1 ? "" : "s", filename.c_str());
-		try
+		if (!images.empty())
 		{
-			Magick::writeImages(images.begin(), images.end(), filename);
-			synfig::info("done");
-		}
-		catch(Magick::Warning &warning) {
-			synfig::warning("exception '%s'", warning.what());
+			synfig::info("writing %d image%s to %s", images.size(), images.size() == 1 ? "" : "s", filename.c_str());
+			try
+			{
+				Magick::writeImages(images.begin(), images.end(), filename);
+				synfig::info("done");
+			}
+			catch(Magick::Warning &warning) {
+				synfig::warning("exception '%s'", warning.what());
+			}
 		}
 	}
 	catch(Magick::Warning &warning) {
@@ -207,18 +210,74 @@ magickpp_trgt::~magickpp_trgt()
 bool
 magickpp_trgt::set_rend_desc(RendDesc *given_desc)
 {
+	gif_target = NULL;
+
+	// ImageMagick needs all frames of an animated gif in memory to join them,
+	// so animations are passed to the gif target which writes frame by frame
+	String format;
+	if (given_desc->get_frame_end() - given_desc->get_frame_start() > 0
+	 && can_join_images(filename, format)
+	 && format == "GIF"
+	 && Target::book().count("gif"))
+	{
+		gif_target = Target_Scanline::Handle::cast_dynamic(Target::create("gif", filename, params));
+		if (gif_target)
+		{
+			synfig::info("writing animated gif frame by frame");
+			if (!gif_target->set_rend_desc(given_desc))
+				return false;
+		}
+	}
+
 	desc = *given_desc;
 	return true;
 }
 
 bool
-magickpp_trgt::init(synfig::ProgressCallback*)
+magickpp_trgt::init(synfig::ProgressCallback *cb)
 {
+	if (gif_target)
+	{
+		gif_target->set_canvas(get_canvas());
+		gif_target->set_quality(get_quality());
+		return gif_target->init(cb);
+	}
+
 	width = desc.get_w();
 	height = desc.get_h();
+	multi_image = desc.get_frame_end() - desc.get_frame_start() > 0;
+	delay = round_to_int(100.0 / desc.get_frame_rate());
+	imagecount = 0;
 
 	start_pointer = NULL;
 
+	// Single images and formats which can't hold multiple images
+	// are written frame by frame, so nothing is kept in memory
+	stream = true;
+	if (multi_image)
+	{
+		String format;
+		stream = !can_join_images(filename, format);
+
+		// if we can't write multiple images to a file of this type,
+		// include the frame number in the filename, so the files will
+		// be numbered with a fixed width, '0'-padded number
+		if (stream)
+			synfig::info("can't join images of this type - numbering instead");
+	}
+
+	if (!stream)
+	{
+		// frames are joined only when the render ends, so limit the memory
+		// of ImageMagick to make it keep the pixels of the rest on disk
+		MagickCore::MagickSizeType limit = (MagickCore::MagickSizeType)MAX_FRAMES_IN_MEMORY
+		                                 * width * height * 4 * sizeof(MagickCore::Quantum);
+		if (limit < MagickCore::GetMagickResourceLimit(MagickCore::MemoryResource))
+			MagickCore::SetMagickResourceLimit(MagickCore::MemoryResource, limit);
+		if (limit < MagickCore::GetMagickResourceLimit(MagickCore::MapResource))
+			MagickCore::SetMagickResourceLimit(MagickCore::MapResource, limit);
+	}
+
 	buffer1 = new unsigned char[4*width*height];
 	if (buffer1 == NULL)
 		return false;
@@ -244,15 +303,56 @@ magickpp_trgt::init(synfig::ProgressCallback*)
 void
 magickpp_trgt::end_frame()
 {
+	if (gif_target)
+	{
+		gif_target->end_frame();
+		return;
+	}
+
+	int index = imagecount++;
+
+	if (stream)
+	{
+		String name = multi_image
+		            ? filename_sans_extension(filename) + sequence_separator
+		            + strprintf("%04d", index) + filename_extension(filename)
+		            : filename;
+		try
+		{
+			Magick::Image image(width, height, "RGBA", Magick::CharPixel, start_pointer);
+			image.write(name);
+		}
+		catch(Magick::Warning &warning) {
+			synfig::warning("exception '%s'", warning.what());
+		}
+		catch(Magick::Error &error) {
+			synfig::error("exception '%s'", error.what());
+		}
+		return;
+	}
+
+	// a frame identical to the previous one just extends its delay,
+	// so still parts of the animation do not occupy memory
+	if (!images.empty()
+	 && memcmp(start_pointer, start_pointer == buffer1 ? buffer2 : buffer1, 4*width*height) == 0)
+	{
+		images.back().animationDelay(images.back().animationDelay() + delay);
+		return;
+	}
+
 	Magick::Image image(width, height, "RGBA", Magick::CharPixel, start_pointer);
+	image.animationDelay(delay);
 	if (transparent && images.begin() != images.end())
 		(images.end()-1)->gifDisposeMethod(Magick::BackgroundDispose);
 	images.push_back(image);
 }
 
 bool
-magickpp_trgt::start_frame(synfig::ProgressCallback */*callback*/)
+magickpp_trgt::start_frame(synfig::ProgressCallback *callback)
 {
+	if (gif_target)
+		return gif_target->start_frame(callback);
+
 	if (start_pointer == buffer1)
 		start_pointer = buffer_pointer = buffer2;
 	else
@@ -265,14 +365,19 @@ magickpp_trgt::start_frame(synfig::ProgressCallback */*callback*/)
 }
 
 Color*
-magickpp_trgt::start_scanline(int /*scanline*/)
+magickpp_trgt::start_scanline(int scanline)
 {
+	if (gif_target)
+		return gif_target->start_scanline(scanline);
 	return color_buffer;
 }
 
 bool
 magickpp_trgt::end_scanline()
 {
+	if (gif_target)
+		return gif_target->end_scanline();
+
 	if (previous_buffer_pointer)
 		color_to_pixelformat(previous_buffer_pointer, color_buffer, PF_RGB|PF_A, 0, width);
 
@@ -52,12 +52,18 @@ private:
 	int width, height;
 
 	synfig::String filename;
+	synfig::TargetParam params;
 	unsigned char *buffer1, *start_pointer, *buffer_pointer;
 	unsigned char *buffer2, *previous_buffer_pointer;
 	bool transparent;
 	synfig::Color *color_buffer;
 	std::vector<Magick::Image> images;
 	synfig::String sequence_separator;
+	bool multi_image;
+	bool stream;	// write each frame as it arrives instead of joining them at the end
+	int imagecount;
+	unsigned int delay;
+	synfig::Target_Scanline::Handle gif_target;	// animated gif is written by the streaming gif target
 
 public:
 
@@ -65,6 +71,7 @@ public:
 		width(),
 		height(),
 		filename(filename),
+		params(params),
 		buffer1(NULL),
 		start_pointer(NULL),
 		buffer_pointer(NULL),
@@ -72,7 +79,11 @@ public:
 		previous_buffer_pointer(NULL),
 		transparent(),
 		color_buffer(NULL),
-		sequence_separator(params.sequence_separator)
+		sequence_separator(params.sequence_separator),
+		multi_image(),
+		stream(),
+		imagecount(),
+		delay()
 	{ }
 	virtual ~magickpp_trgt();
 
@@ -78,6 +78,7 @@ public:
 	using Layer::get_bounding_rect;
 	virtual synfig::Rect get_bounding_rect(synfig::Context context)const;
 	virtual Vocab get_param_vocab()const;
+	virtual synfig::Real get_rendering_neighbourhood()const { return 0.0; }
 	virtual bool reads_context()const { return true; }
 
 protected:
@@ -318,6 +318,20 @@ Noise::get_color(Context context, const Point &point)const
 		return Color::blend(color,context.get_color(point),get_amount(),get_blend_method());
 }
 
+void
+Noise::get_color_span(Context context, const Point &start, const Vector &step, int count, Color *out)const
+{
+	const bool straight = get_amount()==1.0 && get_blend_method()==Color::BLEND_STRAIGHT;
+	if (!straight)
+		context.get_color_span(start, step, count, out);
+
+	Point point = start;
+	for(Color *i = out, *end = out + count; i != end; ++i, point += step)
+		*i = straight
+		   ? color_func(point,0,context)
+		   : Color::blend(color_func(point,0,context), *i, get_amount(), get_blend_method());
+}
+
 
 bool
 Noise::accelerated_render(Context context,Surface *surface,int quality, const RendDesc &renddesc, ProgressCallback *cb)const
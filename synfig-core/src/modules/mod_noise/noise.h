@@ -79,9 +79,11 @@ public:
 	virtual bool set_param(const synfig::String &param, const synfig::ValueBase &value);
 	virtual synfig::ValueBase get_param(const synfig::String &param)const;
 	virtual synfig::Color get_color(synfig::Context context, const synfig::Point &pos)const;
+	virtual void get_color_span(synfig::Context context, const synfig::Point &start, const synfig::Vector &step, int count, synfig::Color *out)const;
 	virtual bool accelerated_render(synfig::Context context,synfig::Surface *surface,int quality, const synfig::RendDesc &renddesc, synfig::ProgressCallback *cb)const;
 	synfig::Layer::Handle hit_check(synfig::Context context, const synfig::Point &point)const;
 	virtual Vocab get_param_vocab()const;
+	virtual synfig::Real get_rendering_neighbourhood()const { return 0.0; }
 };
 
 /* === E N D =============================================================== */
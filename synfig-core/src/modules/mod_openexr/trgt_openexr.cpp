@@ -92,6 +92,9 @@ exr_trgt::set_rend_desc(RendDesc *given_desc)
 bool
 exr_trgt::start_frame(synfig::ProgressCallback *cb)
 {
+	if(!get_frame_list().empty())
+		imagecount=get_frame_number();
+
 	int w=desc.get_w(),h=desc.get_h();
 
 	String frame_name;
@@ -48,8 +48,12 @@
 #include <ETL/hermite>
 #include <vector>
 
+#include <synfig/threadpool.h>
 #include <synfig/valuenodes/valuenode_bline.h>
 
+#include <synfig/rendering/common/task/tasktransformation.h>
+#include <synfig/rendering/software/task/tasksw.h>
+
 #endif
 
 using namespace etl;
@@ -73,8 +77,136 @@ SYNFIG_LAYER_SET_VERSION(Plant,"0.2");
 
 /* === P R O C E D U R E S ================================================= */
 
+namespace {
+
+class TaskPlant: public rendering::Task, public rendering::TaskInterfaceTransformation
+{
+public:
+	typedef etl::handle<TaskPlant> Handle;
+	static Token token;
+	virtual Token::Handle get_token() const { return token.handle(); }
+
+	Plant::ParticleList::Handle particle_list;
+	Real size;
+	bool size_as_alpha;
+	bool reverse;
+	rendering::Holder<rendering::TransformationAffine> transformation;
+
+	TaskPlant(): size(), size_as_alpha(), reverse() { }
+
+	virtual rendering::Transformation::Handle get_transformation() const
+		{ return transformation.handle(); }
+
+	virtual Rect calc_bounds() const
+	{
+		if (!particle_list || particle_list->particles.empty())
+			return Rect::zero();
+		Rect bounds = particle_list->bounds;
+		bounds.expand(size);
+		return transformation->transform_bounds(bounds).rect;
+	}
+};
+
+
+class TaskPlantSW: public TaskPlant, public rendering::TaskSW,
+	public rendering::TaskInterfaceSplit
+{
+public:
+	typedef etl::handle<TaskPlantSW> Handle;
+	static Token token;
+	virtual Token::Handle get_token() const { return token.handle(); }
+
+	//! draws the box-filtered square with corners (x0, y0) and (x1, y1) in pixels
+	static void splat(synfig::Surface &surface, const RectInt &rect, const Color &color, Real x0, Real y0, Real x1, Real y1)
+	{
+		int ix0 = std::max(rect.minx, (int)floor(x0));
+		int iy0 = std::max(rect.miny, (int)floor(y0));
+		int ix1 = std::min(rect.maxx, (int)ceil(x1));
+		int iy1 = std::min(rect.maxy, (int)ceil(y1));
+		for(int y = iy0; y < iy1; ++y) {
+			ColorReal ky = std::min(y1, Real(y + 1)) - std::max(y0, Real(y));
+			Color *c = &surface[y][ix0];
+			for(int x = ix0; x < ix1; ++x, ++c) {
+				ColorReal kx = std::min(x1, Real(x + 1)) - std::max(x0, Real(x));
+				*c = Color::blend(color, *c, kx*ky, Color::BLEND_COMPOSITE);
+			}
+		}
+	}
+
+	virtual bool run(RunParams&) const {
+		if (!is_valid() || !particle_list || particle_list->particles.empty())
+			return true;
+
+		Vector ppu = get_pixels_per_unit();
+
+		Matrix bounds_transfromation;
+		bounds_transfromation.m00 = ppu[0];
+		bounds_transfromation.m11 = ppu[1];
+		bounds_transfromation.m20 = target_rect.minx - ppu[0]*source_rect.minx;
+		bounds_transfromation.m21 = target_rect.miny - ppu[1]*source_rect.miny;
+
+		Matrix matrix = bounds_transfromation * transformation->matrix;
+		Real half_size = 0.5*size*sqrt(fabs(matrix.det()));
+		if (std::isnan(half_size) || std::isinf(half_size))
+			return true;
+
+		LockWrite la(this);
+		if (!la)
+			return false;
+		synfig::Surface &surface = la->get_surface();
+
+		// transform and cull all particles in a single pass,
+		// each band of the split task touches only its own rows
+		const std::vector<Plant::Particle> &particles = particle_list->particles;
+		const Real minx = target_rect.minx - half_size, maxx = target_rect.maxx + half_size;
+		const Real miny = target_rect.miny - half_size, maxy = target_rect.maxy + half_size;
+		const int count = (int)particles.size();
+		for(int i = 0; i < count; ++i) {
+			const Plant::Particle &particle = particles[reverse ? count - i - 1 : i];
+			Vector p = matrix.get_transformed(particle.point);
+			if (p[0] < minx || p[0] >= maxx || p[1] < miny || p[1] >= maxy)
+				continue;
+
+			Real s = half_size;
+			Color color = particle.color;
+			if (size_as_alpha) {
+				s *= color.get_a();
+				color.set_a(1);
+			}
+			splat(surface, target_rect, color, p[0] - s, p[1] - s, p[0] + s, p[1] + s);
+		}
+
+		return true;
+	}
+};
+
+rendering::Task::Token TaskPlant::token(
+	DescAbstract<TaskPlant>("Plant") );
+rendering::Task::Token TaskPlantSW::token(
+	DescReal<TaskPlantSW, TaskPlant>("PlantSW") );
+
+} // namespace
+
 /* === M E T H O D S ======================================================= */
 
+bool
+Plant::Growth::operator==(const Growth &other) const
+{
+	if ( splits        != other.splits
+	  || step          != other.step
+	  || gravity       != other.gravity
+	  || drag          != other.drag
+	  || split_angle   != other.split_angle
+	  || random_factor != other.random_factor
+	  || random.get_seed() != other.random.get_seed()
+	  || gradient.size() != other.gradient.size() )
+		return false;
+	for(Gradient::const_iterator i = gradient.begin(), j = other.gradient.begin(); i != gradient.end(); ++i, ++j)
+		if (i->pos != j->pos || i->color != j->color)
+			return false;
+	return true;
+}
+
 
 Plant::Plant():
 	param_bline(ValueBase(std::vector<BLinePoint>())),
@@ -93,6 +225,7 @@ Plant::Plant():
 	param_random_factor(ValueBase(Real(0.2))),
 	param_drag(ValueBase(Real(0.1))),
 	param_use_width(ValueBase(true)),
+	particle_list(new ParticleList()),
 	version(get_register_version())
 {
 	bounding_rect=Rect::zero();
@@ -125,18 +258,15 @@ Plant::Plant():
 }
 
 void
-Plant::branch(int n,int depth,float t, float stunt_growth, synfig::Point position,synfig::Vector vel)const
+Plant::branch(const Growth &growth, std::vector<Particle> &particles, Rect &bounds, int n,int depth,float t, float stunt_growth, synfig::Point position,synfig::Vector vel)
 {
-	int splits=param_splits.get(int());
-	Real step=param_step.get(Real());
-	Vector gravity=param_gravity.get(Vector());
-	Real drag=param_drag.get(Real());
-	Gradient gradient=param_gradient.get(Gradient());
-	Angle split_angle=param_split_angle.get(Angle());
-	Real random_factor=param_random_factor.get(Real());
-	Random random;
-	random.set_seed(param_random.get(int()));
-	
+	const int splits=growth.splits;
+	const Real step=growth.step;
+	const Vector &gravity=growth.gravity;
+	const Real drag=growth.drag;
+	const Real random_factor=growth.random_factor;
+	const Random &random=growth.random;
+
 	float next_split((1.0-t)/(splits-depth)+t/*+random_factor*random(40+depth,t*splits,0,0)/splits*/);
 	for(;t<next_split;t+=step)
 	{
@@ -146,25 +276,31 @@ Plant::branch(int n,int depth,float t, float stunt_growth, synfig::Point positio
 		position[0]+=vel[0]*step;
 		position[1]+=vel[1]*step;
 
-		particle_list.push_back(Particle(position, gradient(t)));
-		if (particle_list.size() % 1000000 == 0)
-			synfig::info("constructed %d million particles...", particle_list.size()/1000000);
-
-		bounding_rect.expand(position);
+		particles.push_back(Particle(position, growth.gradient(t)));
+		bounds.expand(position);
 	}
 
 	if(t>=1.0-stunt_growth)return;
 
-	synfig::Real sin_v=synfig::Angle::cos(split_angle).get();
-	synfig::Real cos_v=synfig::Angle::sin(split_angle).get();
+	synfig::Real sin_v=synfig::Angle::cos(growth.split_angle).get();
+	synfig::Real cos_v=synfig::Angle::sin(growth.split_angle).get();
 
 	synfig::Vector velocity1(vel[0]*sin_v - vel[1]*cos_v + random_factor*random(Random::SMOOTH_COSINE, 30+n+depth, t*splits, 0.0f, 0.0f),
 							 vel[0]*cos_v + vel[1]*sin_v + random_factor*random(Random::SMOOTH_COSINE, 32+n+depth, t*splits, 0.0f, 0.0f));
 	synfig::Vector velocity2(vel[0]*sin_v + vel[1]*cos_v + random_factor*random(Random::SMOOTH_COSINE, 31+n+depth, t*splits, 0.0f, 0.0f),
 							-vel[0]*cos_v + vel[1]*sin_v + random_factor*random(Random::SMOOTH_COSINE, 33+n+depth, t*splits, 0.0f, 0.0f));
 
-	Plant::branch(n,depth+1,t,stunt_growth,position,velocity1);
-	Plant::branch(n,depth+1,t,stunt_growth,position,velocity2);
+	branch(growth,particles,bounds,n,depth+1,t,stunt_growth,position,velocity1);
+	branch(growth,particles,bounds,n,depth+1,t,stunt_growth,position,velocity2);
+}
+
+void
+Plant::grow_sprout(const Growth *growth, const Sprout *sprout, std::vector<Particle> *particles, Rect *bounds)
+{
+	*bounds = Rect(sprout->point);
+	branch(*growth, *particles, *bounds, sprout->index, 0, 0, // time
+		   sprout->stunt_growth, // stunt growth
+		   sprout->point, sprout->velocity);
 }
 
 void
@@ -208,22 +344,35 @@ void
 Plant::sync()const
 {
 	std::vector<BLinePoint> bline(param_bline.get_list_of(BLinePoint()));
-	Real step_=param_step.get(Real());
-	Gradient gradient=param_gradient.get(Gradient());
-	Real random_factor=param_random_factor.get(Real());
-	Random random;
-	random.set_seed(param_random.get(int()));
-	int sprouts=param_sprouts.get(int());
+	int sprouts_per_segment=param_sprouts.get(int());
 	Real velocity=param_velocity.get(Real());
 	Real perp_velocity=param_perp_velocity.get(Real());
-	int splits=param_splits.get(int());
 	bool use_width=param_use_width.get(bool());
-	
+
+	Growth new_growth;
+	new_growth.splits=param_splits.get(int());
+	new_growth.step=param_step.get(Real());
+	new_growth.gravity=param_gravity.get(Vector());
+	new_growth.drag=param_drag.get(Real());
+	new_growth.gradient=param_gradient.get(Gradient());
+	new_growth.split_angle=param_split_angle.get(Angle());
+	new_growth.random_factor=param_random_factor.get(Real());
+	new_growth.random.set_seed(param_random.get(int()));
+
 	std::lock_guard<std::mutex> lock(mutex);
 	if (!needs_sync_) return;
 	time_t start_time; time(&start_time);
-	particle_list.clear();
 
+	// sprouts grown before may be reused only if all of them grows by the same rules
+	ParticleList::Handle prev_list = particle_list;
+	std::vector<Sprout> prev_sprouts;
+	if (growth == new_growth)
+		prev_sprouts.swap(sprouts);
+	sprouts.clear();
+	growth = new_growth;
+
+	// tasks which are rendering now still refers to the previous list
+	particle_list = new ParticleList();
 	bounding_rect=Rect::zero();
 
 	// Bline must have at least 2 points in it
@@ -233,11 +382,15 @@ Plant::sync()const
 		return;
 	}
 
+	const int splits=growth.splits;
+	const Real random_factor=growth.random_factor;
+	const Random &random=growth.random;
+
 	std::vector<synfig::BLinePoint>::const_iterator iter,next;
 
 	etl::hermite<Vector> curve;
 
-	Real step(abs(step_));
+	Real step(abs(growth.step));
 
 	int seg(0);
 
@@ -265,18 +418,15 @@ Plant::sync()const
 		if (steps < 1) steps = 1;
 		for(f=0.0;f<1.0;f+=step,i++)
 		{
-			Point point(curve(f));
-
-			particle_list.push_back(Particle(point, gradient(0)));
-			if (particle_list.size() % 1000000 == 0)
-				synfig::info("constructed %d million particles...", particle_list.size()/1000000);
-
-			bounding_rect.expand(point);
+			sprouts.push_back(Sprout());
+			Sprout &sprout = sprouts.back();
+			sprout.index = i;
+			sprout.point = curve(f);
 
 			Real stunt_growth(random_factor * (random(Random::SMOOTH_COSINE,i,f+seg,0.0f,0.0f)/2.0+0.5));
 			stunt_growth*=stunt_growth;
 
-			if((((i+1)*sprouts + steps/2) / steps) > branch_count) {
+			if((((i+1)*sprouts_per_segment + steps/2) / steps) > branch_count) {
 				Vector branch_velocity(deriv(f).norm()*velocity + deriv(f).perp().norm()*perp_velocity);
 
 				if (std::isnan(branch_velocity[0]) || std::isnan(branch_velocity[1]))
@@ -294,17 +444,72 @@ Plant::sync()const
 				}
 
 				branch_count++;
-				branch(i, 0, 0,		 // time
-					   stunt_growth, // stunt growth
-					   point, branch_velocity);
+				sprout.grows = true;
+				sprout.velocity = branch_velocity;
+				sprout.stunt_growth = stunt_growth;
 			}
 		}
 	}
 
+	// reuse unchanged sprouts, and grow the other ones simultaneously,
+	// sprouts are independent from each other for the given seed
+	std::vector<bool> reused(sprouts.size(), false);
+	std::vector< std::vector<Particle> > grown(sprouts.size());
+	ThreadPool::Group group;
+	for(int i = 0; i < (int)sprouts.size(); ++i)
+	{
+		Sprout &sprout = sprouts[i];
+		if (!sprout.grows) continue;
+		if (i < (int)prev_sprouts.size() && sprout.same_input(prev_sprouts[i]))
+		{
+			sprout.first = prev_sprouts[i].first;
+			sprout.count = prev_sprouts[i].count;
+			sprout.bounds = prev_sprouts[i].bounds;
+			reused[i] = true;
+			continue;
+		}
+		group.enqueue( sigc::bind( sigc::ptr_fun(&Plant::grow_sprout),
+			&growth, &sprout, &grown[i], &sprout.bounds ));
+	}
+	group.run();
+
+	// join sprouts into the single list
+	std::vector<Particle> &particles = particle_list->particles;
+	size_t total = sprouts.size();
+	for(int i = 0; i < (int)sprouts.size(); ++i)
+		total += reused[i] ? sprouts[i].count : grown[i].size();
+	particles.reserve(total);
+
+	const Color stem_color = growth.gradient(0);
+	Rect &bounds = particle_list->bounds;
+	for(int i = 0; i < (int)sprouts.size(); ++i)
+	{
+		Sprout &sprout = sprouts[i];
+		if (particles.empty()) bounds = Rect(sprout.point); else bounds.expand(sprout.point);
+		particles.push_back(Particle(sprout.point, stem_color));
+		if (!sprout.grows) continue;
+
+		int first = (int)particles.size();
+		if (reused[i])
+			particles.insert(particles.end(), prev_list->particles.begin() + sprout.first, prev_list->particles.begin() + sprout.first + sprout.count);
+		else
+			particles.insert(particles.end(), grown[i].begin(), grown[i].end());
+		sprout.first = first;
+		sprout.count = (int)particles.size() - first;
+		bounds.expand(sprout.bounds.get_min());
+		bounds.expand(sprout.bounds.get_max());
+	}
+
+	if (!particles.empty())
+	{
+		bounding_rect.expand(bounds.get_min());
+		bounding_rect.expand(bounds.get_max());
+	}
+
 	time_t end_time; time(&end_time);
 	if (end_time-start_time > 4)
 		synfig::info("Plant::sync() constructed %d particles in %d seconds\n",
-					 particle_list.size(), int(end_time-start_time));
+					 particles.size(), int(end_time-start_time));
 	needs_sync_=false;
 }
 
@@ -551,17 +756,24 @@ Plant::draw_particles(Surface *dest_surface, const RendDesc &renddesc)const
 	if (std::isinf(pw) || std::isinf(ph))
 		return;
 	
-	if (particle_list.begin() != particle_list.end())
+	ParticleList::Handle list;
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		list = particle_list;
+	}
+	const std::vector<Particle> &particles = list->particles;
+	
+	if (particles.begin() != particles.end())
 	{
-		std::vector<Particle>::iterator iter;
-		Particle *particle;
+		std::vector<Particle>::const_iterator iter;
+		const Particle *particle;
 		
 		float radius(size*sqrt(1.0f/(abs(pw)*abs(ph))));
 		
 		int x1,y1,x2,y2;
 		
-		if (reverse)	iter = particle_list.end();
-		else			iter = particle_list.begin();
+		if (reverse)	iter = particles.end();
+		else			iter = particles.begin();
 		
 		while (true)
 		{
@@ -747,12 +959,12 @@ Plant::draw_particles(Surface *dest_surface, const RendDesc &renddesc)const
 			
 			if (reverse)
 			{
-				if (--iter == particle_list.begin())
+				if (--iter == particles.begin())
 					break;
 			}
 			else
 			{
-				if (++iter == particle_list.end())
+				if (++iter == particles.end())
 					break;
 			}
 		}
@@ -760,6 +972,24 @@ Plant::draw_particles(Surface *dest_surface, const RendDesc &renddesc)const
 }
 
 
+rendering::Task::Handle
+Plant::build_composite_task_vfunc(ContextParams /*context_params*/)const
+{
+	if(needs_sync_==true)
+		sync();
+
+	TaskPlant::Handle task(new TaskPlant());
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		task->particle_list = particle_list;
+	}
+	task->size = param_size.get(Real());
+	task->size_as_alpha = param_size_as_alpha.get(bool());
+	task->reverse = param_reverse.get(bool());
+	task->transformation->matrix.set_translate(param_origin.get(Vector()));
+
+	return task;
+}
 
 Rect
 Plant::get_bounding_rect(Context context)const
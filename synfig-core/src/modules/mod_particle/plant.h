@@ -89,6 +89,7 @@ private:
 
 	bool bline_loop;
 
+public:
 	struct Particle
 	{
 		Point point;
@@ -98,18 +99,77 @@ private:
 			point(point),color(color) { }
 	};
 
-	mutable std::vector<Particle> particle_list;
+	//! Immutable list of particles, shared between the layer and rendering tasks
+	class ParticleList: public etl::shared_object
+	{
+	public:
+		typedef etl::handle<ParticleList> Handle;
+		std::vector<Particle> particles;
+		Rect bounds;
+	};
+
+private:
+	//! Parameters which affects the growth of every sprout
+	struct Growth
+	{
+		int splits;
+		Real step;
+		Vector gravity;
+		Real drag;
+		Gradient gradient;
+		Angle split_angle;
+		Real random_factor;
+		Random random;
+
+		Growth(): splits(), step(), drag(), random_factor() { }
+		bool operator==(const Growth &other) const;
+		bool operator!=(const Growth &other) const
+			{ return !(*this == other); }
+	};
+
+	//! Sample of the bline and the sprout which grows from it (if any)
+	struct Sprout
+	{
+		int index;
+		Point point;
+		Vector velocity;
+		Real stunt_growth;
+		bool grows;
+
+		//! range of the sprout particles in the particle list (without the sample particle)
+		int first;
+		int count;
+		Rect bounds;
+
+		Sprout(): index(), stunt_growth(), grows(), first(), count() { }
+		bool same_input(const Sprout &other) const
+		{
+			return grows == other.grows
+				&& index == other.index
+				&& point == other.point
+				&& velocity == other.velocity
+				&& stunt_growth == other.stunt_growth;
+		}
+	};
+
+	mutable ParticleList::Handle particle_list;
+	mutable std::vector<Sprout> sprouts;
+	mutable Growth growth;
 	mutable Rect	bounding_rect;
 	Real mass;
 
 	mutable bool needs_sync_;
 	mutable std::mutex mutex;
 
-	void branch(int n, int depth,float t, float stunt_growth, Point position,Vector velocity)const;
+	static void branch(const Growth &growth, std::vector<Particle> &particles, Rect &bounds, int n, int depth, float t, float stunt_growth, Point position, Vector velocity);
+	static void grow_sprout(const Growth *growth, const Sprout *sprout, std::vector<Particle> *particles, Rect *bounds);
 	void sync()const;
 	String version;
 	void draw_particles(Surface *surface, const RendDesc &renddesc)const;
 
+protected:
+	virtual rendering::Task::Handle build_composite_task_vfunc(ContextParams context_params)const;
+
 public:
 
 	Plant();
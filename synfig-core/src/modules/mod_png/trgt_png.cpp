@@ -130,6 +130,9 @@ png_trgt::end_frame()
 bool
 png_trgt::start_frame(synfig::ProgressCallback *callback)
 {
+	if(!get_frame_list().empty())
+		imagecount=get_frame_number();
+
 	int w=desc.get_w(),h=desc.get_h();
 
 	if(file && file!=stdout)
@@ -90,6 +90,9 @@ ppm::end_frame()
 bool
 ppm::start_frame(synfig::ProgressCallback *callback)
 {
+	if(!get_frame_list().empty())
+		imagecount=get_frame_number();
+
 	int w=desc.get_w(),h=desc.get_h();
 
 	if(filename=="-")
@@ -50,6 +50,7 @@
 #include "valuenode_registry.h"
 
 #include "debug/measure.h"
+#include "debug/trace.h"
 #include "layers/layer_pastecanvas.h"
 #include "valuenodes/valuenode_const.h"
 #include "valuenodes/valuenode_scale.h"
@@ -108,6 +109,7 @@ Canvas::on_changed()
 		printf("%s:%d Canvas::on_changed()\n", __FILE__, __LINE__);
 
 	is_dirty_=true;
+	invalidate_bounds_tree();
 	Node::on_changed();
 }
 
@@ -283,24 +285,119 @@ Canvas::get_context(const Context &parent_context)const
 Context
 Canvas::get_context_sorted(const ContextParams &params, CanvasBase &out_queue) const
 {
-	multimap<Real, Layer::Handle> layers;
-	int index = 0;
-	for(const_iterator i = begin(); i != end(); ++i, ++index)
+	out_queue.clear();
+
+	if (params.render_rect.is_full_infinite() || params.z_range || params.force_set_time)
 	{
-		assert(*i);
-		// TODO: the 1.0001 constant should be somehow user defined
-		Real depth = (*i)->get_z_depth()*1.0001 + (Real)index;
-		layers.insert(pair<Real, Layer::Handle>(depth, *i));
+		multimap<Real, Layer::Handle> layers;
+		int index = 0;
+		for(const_iterator i = begin(); i != end(); ++i, ++index)
+		{
+			assert(*i);
+			// TODO: the 1.0001 constant should be somehow user defined
+			Real depth = (*i)->get_z_depth()*1.0001 + (Real)index;
+			layers.insert(pair<Real, Layer::Handle>(depth, *i));
+		}
+
+		for(multimap<Real, Layer::Handle>::const_iterator i = layers.begin(); i != layers.end(); ++i)
+			out_queue.push_back(i->second);
 	}
+	else
+	{
+		std::lock_guard<std::mutex> lock(bounds_tree_mutex_);
+		update_bounds_tree(params);
 
-	out_queue.clear();
-	for(multimap<Real, Layer::Handle>::const_iterator i = layers.begin(); i != layers.end(); ++i)
-		out_queue.push_back(i->second);
+		// skip the largest subtrees of layers outside of render_rect
+		const std::vector<std::vector<Rect> > &levels = bounds_tree_.levels;
+		const int count = (int)bounds_tree_.layers.size();
+		for(int i = 0; i < count; )
+		{
+			if (params.render_rect && levels[0][i])
+				{ out_queue.push_back(bounds_tree_.layers[i++]); continue; }
+
+			int level = 0;
+			while( level + 1 < (int)levels.size()
+				&& (i & ((2 << level) - 1)) == 0
+				&& !(params.render_rect && levels[level + 1][i >> (level + 1)]) )
+					++level;
+			i += 1 << level;
+		}
+	}
 	out_queue.push_back(Layer::Handle());
 
 	return Context(out_queue.begin(), params);
 }
 
+void
+Canvas::invalidate_bounds_tree()const
+{
+	std::lock_guard<std::mutex> lock(bounds_tree_mutex_);
+	bounds_tree_.valid = false;
+	bounds_tree_.layers.clear();
+	bounds_tree_.levels.clear();
+}
+
+void
+Canvas::update_bounds_tree(const ContextParams &params)const
+{
+	if (bounds_tree_.valid && bounds_tree_.render_excluded_contexts == params.render_excluded_contexts)
+		return;
+
+	ContextParams bounds_params(params.render_excluded_contexts);
+	CanvasBase queue;
+	get_context_sorted(bounds_params, queue);
+	queue.pop_back();
+	bounds_tree_.layers.assign(queue.begin(), queue.end());
+
+	const int count = (int)bounds_tree_.layers.size();
+	bounds_tree_.levels.assign(1, std::vector<Rect>(count, Rect::infinite()));
+	std::vector<Rect> &bounds = bounds_tree_.levels[0];
+	for(int i = 0; i < count; ++i)
+	{
+		const Layer &layer = *bounds_tree_.layers[i];
+		if (!Context::active(bounds_params, layer))
+			{ bounds[i] = Rect::zero(); continue; }
+
+		// layers below this one may be rendered in other coordinates,
+		// so keep infinite bounds for all of them
+		if (!layer.is_context_preserved())
+			break;
+
+		const Layer_Composite *composite = dynamic_cast<const Layer_Composite*>(&layer);
+		if (composite && Color::is_straight(composite->get_blend_method()))
+			continue;
+
+		layer.sync_time();
+		const Layer_PasteCanvas *paste_canvas = dynamic_cast<const Layer_PasteCanvas*>(&layer);
+		Rect rect = paste_canvas
+		          ? paste_canvas->get_bounding_rect_context_dependent(bounds_params)
+		          : layer.get_bounding_rect();
+		if (!std::isnan(rect.minx) && !std::isnan(rect.miny) && !std::isnan(rect.maxx) && !std::isnan(rect.maxy))
+			bounds[i] = rect;
+	}
+
+	while(bounds_tree_.levels.back().size() > 1)
+	{
+		const std::vector<Rect> &prev = bounds_tree_.levels.back();
+		std::vector<Rect> next((prev.size() + 1)/2);
+		for(size_t j = 0; j < next.size(); ++j)
+		{
+			next[j] = prev[2*j];
+			if (2*j + 1 < prev.size() && prev[2*j + 1].is_valid())
+			{
+				if (next[j].is_valid())
+					next[j].expand(prev[2*j + 1].get_min()).expand(prev[2*j + 1].get_max());
+				else
+					next[j] = prev[2*j + 1];
+			}
+		}
+		bounds_tree_.levels.push_back(next);
+	}
+
+	bounds_tree_.render_excluded_contexts = params.render_excluded_contexts;
+	bounds_tree_.valid = true;
+}
+
 rendering::Task::Handle
 Canvas::build_rendering_task(const ContextParams &context_params) const
 {
@@ -407,6 +504,7 @@ Canvas::set_outline_grow(Real x)
 	{
 		outline_grow = x;
 		get_independent_context().set_outline_grow(outline_grow);
+		invalidate_bounds_tree();
 	}
 }
 
@@ -418,9 +516,14 @@ Canvas::get_outline_grow()const
 
 void
 Canvas::set_time(Time t)const
+	{ set_time(t, ContextParams()); }
+
+void
+Canvas::set_time(Time t, const ContextParams &params)const
 {
 	if(is_dirty_ || !get_time().is_equal(t))
 	{
+		SYNFIG_TRACE_SCOPE("Canvas::set_time");
 		#ifdef DEBUG_SET_TIME_MEASURE
 		debug::Measure measure("Canvas::set_time", true);
 		#endif
@@ -438,7 +541,18 @@ Canvas::set_time(Time t)const
 		const_cast<Canvas&>(*this).cur_time_=t;
 
 		is_dirty_=false;
+
+		// layers out of z_range (i.e. hidden by Layer_Switch) will get time on demand,
+		// unless their z_depth is animated
+		if (params.z_range)
+			for(const_iterator i = begin(); i != end(); ++i)
+				if ( (*i)->active()
+				  && !(*i)->dynamic_param_list().count("z_depth")
+				  && Context::z_depth_visibility(params, **i) <= 0.f )
+					(*i)->defer_time(t);
+
 		get_independent_context().set_time(t);
+		invalidate_bounds_tree();
 	}
 	is_dirty_=false;
 }
@@ -30,11 +30,14 @@
 
 #include <map>
 #include <list>
+#include <mutex>
+#include <vector>
 #include <ETL/handle>
 #include <sigc++/signal.h>
 #include <sigc++/connection.h>
 
 #include "vector.h"
+#include "rect.h"
 #include "string.h"
 #include "canvasbase.h"
 #include "valuenode.h"
@@ -264,6 +267,23 @@ private:
 	/*! \see get_grow_value set_grow_value */
 	Real outline_grow;
 
+	//! Bounding volume hierarchy of the sorted layers, used to skip layers outside of
+	//! ContextParams::render_rect. It is valid until next set_time() or on_changed().
+	struct BoundsTree
+	{
+		bool valid;
+		bool render_excluded_contexts;
+		//! Layers sorted by z_depth
+		std::vector<etl::handle<Layer> > layers;
+		//! levels[0] contains bounds of each layer, each next level contains unions of pairs
+		//! of previous one. Infinite bounds are used for layers which can't be skipped.
+		std::vector<std::vector<Rect> > levels;
+		BoundsTree(): valid(false), render_excluded_contexts(false) { }
+	};
+
+	mutable std::mutex bounds_tree_mutex_;
+	mutable BoundsTree bounds_tree_;
+
 
 	/*
  -- ** -- S I G N A L S -------------------------------------------------------
@@ -478,6 +498,11 @@ public:
 
 	//! Sets the time for all the layers in the canvas
 	void set_time(Time t)const;
+
+	//! Sets the time for the layers visible with \a params, evaluation of
+	//! parameters of other layers is deferred until they are used
+	//! \see Layer::defer_time()
+	void set_time(Time t, const ContextParams &params)const;
 	
 	//! Loads resources (frames) for all the external layers in the canvas
 	void load_resources(Time t)const;
@@ -695,6 +720,10 @@ private:
 	//! Seems to be used to disconnect the stored signals connections of the layers.
 	//! \see connections_
 	void disconnect_connections(etl::loose_handle<Layer> layer);
+	//! Marks bounds_tree_ as outdated
+	void invalidate_bounds_tree()const;
+	//! Rebuilds bounds_tree_ if necessary, bounds_tree_mutex_ must be locked
+	void update_bounds_tree(const ContextParams &params)const;
 
 protected:
 	//! Parent changed
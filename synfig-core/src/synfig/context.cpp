@@ -31,6 +31,8 @@
 #	include <config.h>
 #endif
 
+#include <algorithm>
+
 #include "context.h"
 
 #include "general.h"
@@ -99,7 +101,8 @@ IndependentContext::set_time(Time time, bool force)const
 	while(*context)
 	{
 		if ( (*context)->active() &&
-		    (force || !(*context)->get_time_mark().is_equal(time)) )
+		    (force || !(*context)->get_time_mark().is_equal(time)) &&
+		    !(*context)->is_time_deferred(time) )
 			break;
 		++context;
 	}
@@ -171,11 +174,42 @@ Context::get_color(const Point &pos)const
 	// If this layer isn't defined, return alpha
 	if((context)->empty()) return Color::alpha();
 
+	(*context)->sync_time();
 	Glib::Threads::RWLock::ReaderLock lock((*context)->get_rw_lock());
 
 	return (*context)->get_color(context.get_next(), pos);
 }
 
+void
+Context::get_color_span(const Point &start, const Vector &step, int count, Color *out)const
+{
+	if (count <= 0) return;
+
+	Context context(*this);
+
+	while(!context->empty())
+	{
+		// If this layer is active, then go
+		// ahead and break out of the loop
+		if(context.active() && context.in_z_range())
+			break;
+
+		// Otherwise, we want to keep searching
+		// till we find either an active layer,
+		// or the end of the layer list
+		++context;
+	}
+
+	// If this layer isn't defined, return alpha
+	if((context)->empty())
+		{ std::fill(out, out + count, Color::alpha()); return; }
+
+	(*context)->sync_time();
+	Glib::Threads::RWLock::ReaderLock lock((*context)->get_rw_lock());
+
+	(*context)->get_color_span(context.get_next(), start, step, count, out);
+}
+
 
 
 Rect
@@ -199,6 +233,7 @@ Context::get_full_bounding_rect()const
 	// If this layer isn't defined, return zero-sized rectangle
 	if(context->empty()) return Rect::zero();
 
+	(*context)->sync_time();
 	return (*context)->get_full_bounding_rect(context.get_next());
 }
 
@@ -252,6 +287,7 @@ Context::hit_check(const Point &pos)const
 	// If this layer isn't defined, return an empty handle
 	if((context)->empty()) return 0;
 
+	(*context)->sync_time();
 	return (*context)->hit_check(context.get_next(), pos);
 }
 
@@ -284,6 +320,7 @@ Context::accelerated_render(Surface *surface,int quality, const RendDesc &rendde
 		// If we are not active then move on to next layer
 		if(!context.active())
 			continue;
+		(*context)->sync_time();
 		const Rect layer_bounds(Transformation::transform_bounds(transfromation_matrix, (*context)->get_bounding_rect()));
 		// Cast current layer to composite
 		composite = etl::handle<Layer_Composite>::cast_dynamic(*context);
@@ -408,17 +445,29 @@ Context::build_rendering_task() const
 	while ( *context
 		 && ( !context.active()
 		   || ( !get_params().render_excluded_contexts
-			 && (*context)->get_exclude_from_rendering() )))
+			 && (*context)->get_exclude_from_rendering() )
+		   || ( (*context)->is_context_preserved()
+			 && !context.in_z_range() )))
 		++context;
 
-	// TODO: apply z_range and z_blur (now applies in Canvas::optimize_layers)
+	// TODO: apply z_range and z_blur to other layers (now applies in Canvas::optimize_layers)
 
 	if (!*context)
 		return rendering::Task::Handle();
 	else {
+		(*context)->sync_time();
 		if (context.get_params().force_set_time)
 			context.set_time((*context)->get_time_mark(), true);
-		return (*context)->build_rendering_task(context.get_next());
+
+		// layer may render the rest of context in other coordinates
+		Context next = context.get_next();
+		if (!(*context)->is_context_preserved() && !get_params().render_rect.is_full_infinite())
+		{
+			ContextParams params(get_params());
+			params.render_rect = Rect::infinite();
+			next = Context(next, params);
+		}
+		return (*context)->build_rendering_task(next);
 	}
 }
 
@@ -98,6 +98,9 @@ public:
 	Real z_range_blur;
 	//! Force set_time (to current time mark) at every rendering
 	bool force_set_time;
+	//! Only this rectangle of the context will be rendered,
+	//! so layers outside of it may be skipped (see Canvas::get_context_sorted())
+	Rect render_rect;
 
 	explicit ContextParams(bool render_excluded_contexts = false):
 	render_excluded_contexts(render_excluded_contexts),
@@ -105,7 +108,8 @@ public:
 	z_range_position(0.0),
 	z_range_depth(0.0),
 	z_range_blur(0.0),
-	force_set_time(false){ }
+	force_set_time(false),
+	render_rect(Rect::infinite()){ }
 };
 
 /*!	\class Context
@@ -156,6 +160,10 @@ public:
 	//! It is the blended color of the context
 	Color get_color(const Point &pos)const;
 
+	//!	Puts colors of the context at \count points, starting from \start
+	//! with distance \step between them, into \out
+	void get_color_span(const Point &start, const Vector &step, int count, Color *out)const;
+
 	//!	With a given \quality and a given render description it puts the context
 	//! blend result into the painting \surface */
 	bool accelerated_render(Surface *surface,int quality, const RendDesc &renddesc, ProgressCallback *cb) const;
@@ -0,0 +1,191 @@
+/* === S Y N F I G ========================================================= */
+/*!	\file trace.cpp
+**	\brief Per-thread tracing of render stages
+**
+**	$Id$
+**
+**	\legal
+**	......... ... 2026 Synfig contributors
+**
+**	This package is free software; you can redistribute it and/or
+**	modify it under the terms of the GNU General Public License as
+**	published by the Free Software Foundation; either version 2 of
+**	the License, or (at your option) any later version.
+**
+**	This package is distributed in the hope that it will be useful,
+**	but WITHOUT ANY WARRANTY; without even the implied warranty of
+**	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+**	General Public License for more details.
+**	\endlegal
+*/
+/* ========================================================================= */
+
+/* === H E A D E R S ======================================================= */
+
+#ifdef USING_PCH
+#	include "pch.h"
+#else
+#ifdef HAVE_CONFIG_H
+#	include <config.h>
+#endif
+
+#include <cstdio>
+#include <map>
+#include <mutex>
+#include <vector>
+
+#include <glib.h>
+
+#include <ETL/stringf>
+
+#include <synfig/general.h>
+
+#include "trace.h"
+
+#endif
+
+/* === U S I N G =========================================================== */
+
+using namespace etl;
+using namespace synfig;
+using namespace debug;
+
+/* === M A C R O S ========================================================= */
+
+//! Count of last events kept for each thread
+#define TRACE_BUFFER_SIZE 16384
+
+/* === G L O B A L S ======================================================= */
+
+namespace {
+	struct Buffer {
+		int tid;
+		String thread_name;
+		std::vector<Trace::Event> events;
+		std::atomic<size_t> count;
+		Buffer(int tid, const String &thread_name):
+			tid(tid), thread_name(thread_name), events(TRACE_BUFFER_SIZE), count(0) { }
+	};
+
+	std::mutex buffers_mutex;
+	std::vector<Buffer*> buffers; // never freed, threads may write until exit
+	std::map<String, std::map<String, long long> > counters; // values by name and series
+
+	thread_local Buffer *thread_buffer = nullptr;
+	thread_local String *thread_name = nullptr;
+}
+
+/* === P R O C E D U R E S ================================================= */
+
+static String
+escape(const char *s)
+{
+	String result;
+	for(; s && *s; ++s) {
+		if (*s == '"' || *s == '\\') result += '\\';
+		if ((unsigned char)*s >= 0x20) result += *s;
+	}
+	return result;
+}
+
+/* === M E T H O D S ======================================================= */
+
+std::atomic<bool> Trace::enabled(false);
+
+void
+Trace::set_thread_name(const String &name)
+{
+	if (thread_buffer) {
+		std::lock_guard<std::mutex> lock(buffers_mutex);
+		thread_buffer->thread_name = name;
+		return;
+	}
+	if (!thread_name) thread_name = new String();
+	*thread_name = name;
+}
+
+long long
+Trace::now()
+	{ return g_get_monotonic_time(); }
+
+void
+Trace::add(const Event &event)
+{
+	if (!thread_buffer) {
+		std::lock_guard<std::mutex> lock(buffers_mutex);
+		int tid = (int)buffers.size() + 1;
+		thread_buffer = new Buffer(tid, thread_name ? *thread_name : strprintf("thread %d", tid));
+		buffers.push_back(thread_buffer);
+	}
+
+	// only this thread writes to the buffer
+	size_t count = thread_buffer->count.load(std::memory_order_relaxed);
+	thread_buffer->events[count % TRACE_BUFFER_SIZE] = event;
+	thread_buffer->count.store(count + 1, std::memory_order_release);
+}
+
+void
+Trace::set_counter(const String &name, const String &series, long long value)
+{
+	if (!is_enabled()) return;
+	std::lock_guard<std::mutex> lock(buffers_mutex);
+	counters[name][series] = value;
+}
+
+bool
+Trace::save(const String &filename)
+{
+	FILE *f = fopen(filename.c_str(), "w");
+	if (!f) {
+		error("Trace: cannot write to file \"%s\"", filename.c_str());
+		return false;
+	}
+
+	std::lock_guard<std::mutex> lock(buffers_mutex);
+	fprintf(f, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n");
+	bool first = true;
+	size_t lost = 0;
+	for(std::vector<Buffer*>::const_iterator i = buffers.begin(); i != buffers.end(); ++i) {
+		const Buffer &buffer = **i;
+		fprintf( f, "%s{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%d,\"args\":{\"name\":\"%s\"}}",
+				 first ? "" : ",\n", buffer.tid, escape(buffer.thread_name.c_str()).c_str() );
+		first = false;
+
+		size_t count = buffer.count.load(std::memory_order_acquire);
+		size_t begin = count > TRACE_BUFFER_SIZE ? count - TRACE_BUFFER_SIZE : 0;
+		lost += begin;
+		for(size_t j = begin; j < count; ++j) {
+			const Event &e = buffer.events[j % TRACE_BUFFER_SIZE];
+			fprintf( f, ",\n{\"name\":\"%s\",\"cat\":\"synfig\",\"ph\":\"X\",\"pid\":1,\"tid\":%d,\"ts\":%lld,\"dur\":%lld",
+					 escape(e.name).c_str(), buffer.tid, e.begin, e.end - e.begin );
+			String args;
+			if (e.batch >= 0) args += strprintf(",\"batch\":%d", e.batch);
+			if (e.index >= 0) args += strprintf(",\"index\":%d", e.index);
+			if (e.width || e.height) args += strprintf(",\"width\":%d,\"height\":%d", e.width, e.height);
+			if (e.bytes) args += strprintf(",\"bytes\":%lld", e.bytes);
+			if (!args.empty()) fprintf(f, ",\"args\":{%s}", args.c_str() + 1);
+			fprintf(f, "}");
+		}
+	}
+
+	long long ts = now();
+	for(std::map<String, std::map<String, long long> >::const_iterator i = counters.begin(); i != counters.end(); ++i) {
+		String args;
+		for(std::map<String, long long>::const_iterator j = i->second.begin(); j != i->second.end(); ++j)
+			args += strprintf(",\"%s\":%lld", escape(j->first.c_str()).c_str(), j->second);
+		fprintf( f, "%s{\"name\":\"%s\",\"cat\":\"synfig\",\"ph\":\"C\",\"pid\":1,\"ts\":%lld,\"args\":{%s}}",
+				 first ? "" : ",\n", escape(i->first.c_str()).c_str(), ts, args.c_str() + 1 );
+		first = false;
+	}
+	fprintf(f, "\n]}\n");
+
+	bool success = !ferror(f);
+	if (fclose(f)) success = false;
+	if (lost)
+		warning("Trace: %zu oldest events were dropped from the ring buffers", lost);
+	if (!success)
+		error("Trace: cannot write to file \"%s\"", filename.c_str());
+	return success;
+}
+
+/* === E N T R Y P O I N T ================================================= */
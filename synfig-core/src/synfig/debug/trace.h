@@ -0,0 +1,139 @@
+/* === S Y N F I G ========================================================= */
+/*!	\file trace.h
+**	\brief Per-thread tracing of render stages
+**
+**	$Id$
+**
+**	\legal
+**	......... ... 2026 Synfig contributors
+**
+**	This package is free software; you can redistribute it and/or
+**	modify it under the terms of the GNU General Public License as
+**	published by the Free Software Foundation; either version 2 of
+**	the License, or (at your option) any later version.
+**
+**	This package is distributed in the hope that it will be useful,
+**	but WITHOUT ANY WARRANTY; without even the implied warranty of
+**	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+**	General Public License for more details.
+**	\endlegal
+*/
+/* ========================================================================= */
+
+/* === S T A R T =========================================================== */
+
+#ifndef __SYNFIG_DEBUG_TRACE_H
+#define __SYNFIG_DEBUG_TRACE_H
+
+/* === H E A D E R S ======================================================= */
+
+#include <atomic>
+
+#include <synfig/string.h>
+
+/* === M A C R O S ========================================================= */
+
+//! Define SYNFIG_NO_TRACE to compile out all of the trace scopes
+#ifndef SYNFIG_NO_TRACE
+#define SYNFIG_DEBUG_TRACE
+#endif
+
+#define SYNFIG_TRACE_JOIN_(a, b) a##b
+#define SYNFIG_TRACE_JOIN(a, b) SYNFIG_TRACE_JOIN_(a, b)
+
+#ifdef SYNFIG_DEBUG_TRACE
+//! Records scope until the end of block, arguments are the same as for Trace::Scope
+#define SYNFIG_TRACE_SCOPE(...) \
+	::synfig::debug::Trace::Scope SYNFIG_TRACE_JOIN(synfig_trace_scope_, __LINE__)(__VA_ARGS__)
+#define SYNFIG_TRACE_THREAD_NAME(name) \
+	::synfig::debug::Trace::set_thread_name(name)
+#else
+#define SYNFIG_TRACE_SCOPE(...)
+#define SYNFIG_TRACE_THREAD_NAME(name)
+#endif
+
+/* === T Y P E D E F S ===================================================== */
+
+/* === C L A S S E S & S T R U C T S ======================================= */
+
+namespace synfig {
+namespace debug {
+
+//! Collects timed events of each thread into its own ring buffer
+/*! Nothing is recorded until enable() is called, so disabled scope
+**  costs only one atomic read. Events may be saved in Chrome trace event
+**  format, which is understood by chrome://tracing and Perfetto. */
+class Trace {
+public:
+	struct Event {
+		const char *name;	//!< should stay valid until save(), e.g. static string or token name
+		long long begin;	//!< microseconds
+		long long end;
+		int batch;			//!< batch and index of task, -1 if not set
+		int index;
+		int width;			//!< size of processed surface
+		int height;
+		long long bytes;	//!< processed memory
+	};
+
+	class Scope {
+	private:
+		Event event;
+		bool active;
+
+		Scope(const Scope&);
+		Scope& operator= (const Scope&);
+
+	public:
+		explicit Scope(
+			const char *name,
+			int batch = -1,
+			int index = -1,
+			int width = 0,
+			int height = 0,
+			long long bytes = 0 ):
+			active(Trace::is_enabled())
+		{
+			if (!active) return;
+			event.name = name;
+			event.batch = batch;
+			event.index = index;
+			event.width = width;
+			event.height = height;
+			event.bytes = bytes;
+			event.begin = Trace::now();
+			event.end = event.begin;
+		}
+
+		~Scope()
+			{ if (active) { event.end = Trace::now(); Trace::add(event); } }
+	};
+
+private:
+	static std::atomic<bool> enabled;
+
+public:
+	static bool is_enabled()
+		{ return enabled.load(std::memory_order_relaxed); }
+	static void enable(bool x = true)
+		{ enabled = x; }
+
+	//! Name of the current thread in the saved trace
+	static void set_thread_name(const String &name);
+
+	static long long now();
+	static void add(const Event &event);
+	//! Sets total \a value of counter, counters are written once by save()
+	static void set_counter(const String &name, const String &series, long long value);
+
+	//! Writes events of all threads in Chrome trace event format,
+	//! call it when rendering is finished
+	static bool save(const String &filename);
+};
+
+}; // END of namespace debug
+}; // END of namespace synfig
+
+/* === E N D =============================================================== */
+
+#endif
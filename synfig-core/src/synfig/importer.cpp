@@ -41,6 +41,7 @@
 
 #include "general.h"
 #include <synfig/localization.h>
+#include <synfig/debug/trace.h>
 
 #include "canvas.h"
 #include "importer.h"
@@ -63,6 +64,8 @@ using namespace synfig;
 Importer::Book* synfig::Importer::book_;
 
 static map<FileSystem::Identifier,Importer::LooseHandle> *__open_importers;
+//! guards __open_importers, importers are opened and released from render threads
+static std::recursive_mutex __open_importers_mutex;
 
 /* === P R O C E D U R E S ================================================= */
 
@@ -93,6 +96,7 @@ Importer::book()
 Importer::Handle
 Importer::open(const FileSystem::Identifier &identifier, bool force)
 {
+	std::lock_guard<std::recursive_mutex> lock(__open_importers_mutex);
 	if (force) forget(identifier); // force reload
 
 	if(identifier.filename.empty())
@@ -127,6 +131,7 @@ Importer::open(const FileSystem::Identifier &identifier, bool force)
 	}
 
 	try {
+		SYNFIG_TRACE_SCOPE("Importer::open");
 		Importer::Handle importer;
 		importer=Importer::book()[ext].factory(identifier);
 		(*__open_importers)[identifier]=importer;
@@ -141,6 +146,7 @@ Importer::open(const FileSystem::Identifier &identifier, bool force)
 
 void Importer::forget(const FileSystem::Identifier &identifier)
 {
+	std::lock_guard<std::recursive_mutex> lock(__open_importers_mutex);
 	__open_importers->erase(identifier);
 }
 
@@ -153,18 +159,28 @@ Importer::Importer(const FileSystem::Identifier &identifier):
 Importer::~Importer()
 {
 	// Remove ourselves from the open importer list
+	std::lock_guard<std::recursive_mutex> lock(__open_importers_mutex);
 	map<FileSystem::Identifier,Importer::LooseHandle>::iterator iter;
 	for(iter=__open_importers->begin();iter!=__open_importers->end();)
 		if(iter->second==this)
 			__open_importers->erase(iter++); else ++iter;
 }
 
+bool
+Importer::unref() const
+{
+	std::lock_guard<std::recursive_mutex> lock(__open_importers_mutex);
+	return shared_object::unref();
+}
+
 rendering::Surface::Handle
 Importer::get_frame(const RendDesc & /* renddesc */, const Time &time)
 {
+	std::lock_guard<std::recursive_mutex> lock(frame_mutex);
 	if (last_surface_ && last_surface_->is_exists() && !is_animated())
 		return last_surface_;
 
+	SYNFIG_TRACE_SCOPE("Importer::get_frame");
 	Surface surface;
 	if(!get_frame(surface, RendDesc(), time))
 		warning(strprintf("Unable to get frame from \"%s\"", identifier.filename.c_str()));
@@ -30,6 +30,7 @@
 #include <cstdio>
 
 #include <map>
+#include <mutex>
 
 #include <ETL/handle>
 
@@ -146,6 +147,9 @@ private:
 	rendering::Surface::Handle last_surface_;
 
 protected:
+	//! One importer is shared by all layers which use the file,
+	//! so frames are decoded by one thread at a time
+	std::recursive_mutex frame_mutex;
 
 	Importer(const FileSystem::Identifier &identifier);
 
@@ -154,6 +158,10 @@ public:
 
 	virtual ~Importer();
 
+	//! Removes the last reference under the lock of open importers,
+	//! so Importer::open() never returns importer which is being destroyed
+	virtual bool unref() const;
+
 	//! Gets a frame and puts it into \a surface
 	/*!	\param	surface Reference to surface to put frame into
 	**	\param	time	For animated importers, determines which frame to get.
@@ -166,7 +166,8 @@ Layer::Layer():
 	exclude_from_rendering_(false),
 	param_z_depth(Real(0.0f)),
 	time_mark(Time::end()),
-	outline_grow_mark(0.0)
+	outline_grow_mark(0.0),
+	time_deferred(false)
 {
 	_layer_counter.counter++;
 	SET_INTERPOLATION_DEFAULTS();
@@ -453,6 +454,55 @@ Layer::simple_clone()const
 	return ret;
 }
 
+Layer::Handle
+Layer::get_rendering_snapshot(const ParamList &params)const
+{
+	// inline canvases must be cloned, see clone()
+	for(ParamList::const_iterator i = params.begin(); i != params.end(); ++i)
+		if (i->second.get_type() == type_canvas) {
+			Handle ret = clone(NULL);
+			if (!ret) return ret;
+			ret->set_canvas(get_canvas());
+			for(ParamList::const_iterator j = params.begin(); j != params.end(); ++j)
+				if (j->second.get_type() != type_canvas)
+					ret->set_param(j->first, j->second);
+			return ret;
+		}
+
+	std::lock_guard<std::mutex> lock(rendering_snapshot_mutex);
+	// layers read time and outline grow marks while rendering (noise, distort, etc),
+	// so snapshot is shared only between tasks of the same marks
+	if ( rendering_snapshot
+	  && rendering_snapshot->get_canvas() == get_canvas()
+	  && rendering_snapshot->get_time_mark() == get_time_mark()
+	  && rendering_snapshot->get_outline_grow_mark() == get_outline_grow_mark()
+	  && rendering_snapshot->active() == active()
+	  && rendering_snapshot->optimized() == optimized()
+	  && rendering_snapshot->get_exclude_from_rendering() == get_exclude_from_rendering()
+	  && rendering_snapshot->is_time_deferred() == is_time_deferred()
+	  && (!is_time_deferred() || rendering_snapshot->is_time_deferred(deferred_time))
+	  && rendering_snapshot_params == params )
+		return rendering_snapshot;
+
+	// tasks of previous frames may still use old copy, so don't touch it
+	if(!book().count(get_name())) return 0;
+	Handle ret = create(get_name()).get();
+	ret->group_ = group_;
+	ret->set_active(active());
+	ret->set_optimized(optimized());
+	ret->set_exclude_from_rendering(get_exclude_from_rendering());
+	ret->set_time_mark(get_time_mark());
+	ret->set_outline_grow_mark(get_outline_grow_mark());
+	if (is_time_deferred())
+		ret->defer_time(deferred_time);
+	ret->set_canvas(get_canvas());
+	ret->set_param_list(params);
+
+	rendering_snapshot = ret;
+	rendering_snapshot_params = params;
+	return ret;
+}
+
 Layer::Handle
 Layer::clone(Canvas::LooseHandle canvas, const GUID& deriv_guid) const
 {
@@ -471,6 +521,8 @@ Layer::clone(Canvas::LooseHandle canvas, const GUID& deriv_guid) const
 
 	ret->set_time_mark(get_time_mark());
 	ret->set_outline_grow_mark(get_outline_grow_mark());
+	if (is_time_deferred())
+		ret->defer_time(deferred_time);
 
 	//ret->set_param_list(get_param_list());
 	// Process the parameter list so that
@@ -535,6 +587,12 @@ Layer::reads_context() const
 	return false;
 }
 
+Real
+Layer::get_rendering_neighbourhood() const
+{
+	return -1.0;
+}
+
 Rect
 Layer::get_full_bounding_rect(Context context)const
 {
@@ -607,6 +665,8 @@ Layer::reset_version()
 void
 Layer::set_time(IndependentContext context, Time time)const
 {
+	time_deferred = false;
+
 	Layer::ParamList params;
 	Layer::DynamicParamList::const_iterator iter;
 	// For each parameter of the layer sets the time by the operator()(time)
@@ -620,6 +680,18 @@ Layer::set_time(IndependentContext context, Time time)const
 	set_time_vfunc(context, time);
 }
 
+void
+Layer::sync_time()const
+{
+	if (!time_deferred) return;
+
+	// set time only for this layer
+	CanvasBase queue;
+	queue.push_back(Layer::Handle());
+	Glib::Threads::RWLock::WriterLock lock(get_rw_lock());
+	set_time(IndependentContext(queue.begin()), deferred_time);
+}
+
 void
 Layer::load_resources(IndependentContext context, Time time)const
 {
@@ -657,6 +729,14 @@ Layer::get_color(Context context, const Point &pos)const
 	return context.get_color(pos);
 }
 
+void
+Layer::get_color_span(Context context, const Point &start, const Vector &step, int count, Color *out)const
+{
+	Point pos = start;
+	for(Color *i = out, *end = out + count; i != end; ++i, pos += step)
+		*i = get_color(context, pos);
+}
+
 
 
 synfig::Layer::Handle
@@ -889,18 +969,15 @@ rendering::Task::Handle
 Layer::build_rendering_task_vfunc(Context context)const
 {
 	rendering::TaskLayer::Handle task = new rendering::TaskLayer();
-	// TODO: This is not thread-safe
-	//task->layer = const_cast<Layer*>(this);//clone(NULL);
-	task->layer = clone(NULL);
-	task->layer->set_canvas(get_canvas());
 
+	ParamList params = get_param_list();
 	Real amount = Context::z_depth_visibility(context.get_params(), *this);
-	if (approximate_not_equal(amount, 1.0) && task->layer.type_is<Layer_Composite>())
+	if (approximate_not_equal(amount, 1.0) && dynamic_cast<const Layer_Composite*>(this))
 	{
-		//task->layer = task->layer->clone(NULL);
-		etl::handle<Layer_Composite> composite = etl::handle<Layer_Composite>::cast_dynamic(task->layer);
-		composite->set_amount( composite->get_amount()*amount );
+		const Layer_Composite *composite = static_cast<const Layer_Composite*>(this);
+		params["amount"] = ValueBase(Real(composite->get_amount()*amount));
 	}
+	task->layer = get_rendering_snapshot(params);
 
 	task->sub_task() = context.build_rendering_task();
 	return task;
@@ -30,6 +30,7 @@
 /* === H E A D E R S ======================================================= */
 
 #include <map>
+#include <mutex>
 
 #include <ETL/handle>
 
@@ -303,6 +304,15 @@ private:
 	mutable Time time_mark;
 	mutable Real outline_grow_mark;
 
+	//! Time requested while the layer was invisible, see defer_time()
+	mutable Time deferred_time;
+	mutable bool time_deferred;
+
+	//! Copy of the layer shared by rendering tasks, see get_rendering_snapshot()
+	mutable etl::handle<Layer> rendering_snapshot;
+	mutable ParamList rendering_snapshot_params;
+	mutable std::mutex rendering_snapshot_mutex;
+
 	//! Contains the name of the group that this layer belongs to
 	String group_;
 
@@ -501,6 +511,11 @@ public:
 	//!\see synfig::Rect synfig::Context
 	virtual Rect get_full_bounding_rect(Context context)const;
 
+	//! Returns \c true if the layer blends own content onto the context
+	//! and renders the context in the same coordinates without changes
+	//! \see Canvas::get_context_sorted()
+	virtual bool is_context_preserved()const { return false; }
+
 	//! Returns a string containing the name of the Layer
 	virtual String get_name()const;
 
@@ -554,6 +569,14 @@ public:
 	void set_time_mark(Time time) const { time_mark = time; }
 	void clear_time_mark() const { time_mark = Time::end(); }
 
+	//! Remembers the \a time for the invisible Layer without evaluation of parameters,
+	//! they will be evaluated by sync_time() when the Layer is used
+	void defer_time(Time time) const { deferred_time = time; time_deferred = true; }
+	bool is_time_deferred() const { return time_deferred; }
+	bool is_time_deferred(Time time) const { return time_deferred && deferred_time.is_equal(time); }
+	//! Evaluates parameters at the deferred time, if any
+	void sync_time() const;
+
 	Real get_outline_grow_mark() const { return outline_grow_mark; }
 	void set_outline_grow_mark(Real outline_grow) const { outline_grow_mark = outline_grow; }
 	void clear_outline_grow_mark() const { outline_grow_mark = 0.0; }
@@ -586,6 +609,17 @@ public:
 	*/
 	virtual Color get_color(Context context, const Point &pos)const;
 
+	//! Gets the blend colors of the Layer in the context for a row of points
+	/*!	\param context		Context iterator referring to next Layer.
+	**	\param start		Position of the first point
+	**	\param step		Distance between neighbouring points
+	**	\param count		Count of points
+	**	\param out		Buffer for \a count colors
+	**	Default implementation calls get_color() for each point.
+	**	\see Context::get_color_span()
+	*/
+	virtual void get_color_span(Context context, const Point &start, const Vector &step, int count, Color *out)const;
+
 	// Temporary function to render transformed layer for layers which yet not support transformed rendering
 	static bool render_transformed(const Layer *layer, Context context,Surface *surface,int quality, const RendDesc &renddesc, ProgressCallback *cb, const char *file, int line);
 
@@ -640,9 +674,21 @@ public:
 	**  context until the final blend operation. */
 	virtual bool reads_context()const;
 
+	//! Returns radius (in units) of area around the pixel which affects it in accelerated_render().
+	/*! Zero means that layer may be rendered by independent parts (bands),
+	**  positive value means that each part should be rendered with such margins,
+	**  negative value (default) means that layer must be rendered at once. */
+	virtual Real get_rendering_neighbourhood()const;
+
 	//! Duplicates the Layer without duplicating the value nodes
 	virtual Handle simple_clone()const;
 
+	//! Returns read-only copy of the layer with parameters \a params for use in rendering tasks.
+	/*! Copy has no value nodes and GUID. It is reused while parameters stay the same,
+	**  so caches built by the copy survive between frames. Returns full clone
+	**  if parameters contain canvas. Returned layer must not be modified. */
+	Handle get_rendering_snapshot(const ParamList &params)const;
+
 	//! Connects the parameter to another Value Node
 	virtual bool connect_dynamic_param(const String& param, etl::loose_handle<ValueNode>);
 
@@ -86,6 +86,7 @@ public:
 	virtual Vocab get_param_vocab()const;
 
 	virtual Rect get_bounding_rect()const;
+	virtual bool is_context_preserved()const { return true; }
 
 	virtual synfig::Layer::Handle hit_check(synfig::Context context, const synfig::Point &point)const;
 	
@@ -53,6 +53,8 @@ public:
 	virtual Vocab get_param_vocab()const;
 	//! Get the value of the specified parameter. \see Layer::get_param
 	virtual ValueBase get_param(const String & param)const;
+	//! Filters inside of the group are applied to the context
+	virtual bool is_context_preserved()const { return false; }
 
 protected:
 	virtual Context build_context_queue(Context context, CanvasBase &queue)const;
@@ -313,7 +313,9 @@ Layer_PasteCanvas::set_time_vfunc(IndependentContext context, Time time)const
 
 	Real time_dilation = param_time_dilation.get(Real());
 	Time time_offset = param_time_offset.get(Time());
-	sub_canvas->set_time(time*time_dilation + time_offset);
+	ContextParams params;
+	apply_z_range_to_params(params);
+	sub_canvas->set_time(time*time_dilation + time_offset, params);
 }
 
 void
@@ -501,6 +503,14 @@ Layer_PasteCanvas::build_context_queue(Context context, CanvasBase &out_queue)co
 	ContextParams params(context.get_params());
 	apply_z_range_to_params(params);
 
+	if (!params.render_rect.is_full_infinite())
+	{
+		Matrix matrix = get_summary_transformation().get_matrix();
+		params.render_rect = matrix.is_invertible()
+		                   ? Transformation::transform_bounds(matrix.get_inverted(), params.render_rect)
+		                   : Rect::infinite();
+	}
+
 	if (sub_canvas)
 		return sub_canvas->get_context_sorted(params, out_queue);
 
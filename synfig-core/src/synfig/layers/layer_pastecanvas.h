@@ -177,6 +177,7 @@ public:
 	//!Returns the rectangle that includes the context of the layer and
 	//! the intersection of the layer in case it is active and not onto
 	virtual Rect get_full_bounding_rect(Context context)const;
+	virtual bool is_context_preserved()const { return true; }
 	//! Gets the parameter vocabulary
 	virtual Vocab get_param_vocab()const;
 	//! Checks to see if a part of the Paste Canvas Layer is directly under \a point
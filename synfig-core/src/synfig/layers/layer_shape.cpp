@@ -384,7 +384,7 @@ Layer_Shape::get_bounding_rect()const
 	bounds += origin;
 	bounds.expand((bounds.get_min() - bounds.get_max()).mag()*0.01);
 	bounds.expand_x( fabs(feather_amplifier * feather[0]) );
-	bounds.expand_x( fabs(feather_amplifier * feather[1]) );
+	bounds.expand_y( fabs(feather_amplifier * feather[1]) );
 
 	return bounds;
 }
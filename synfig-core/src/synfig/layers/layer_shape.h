@@ -122,6 +122,7 @@ public:
 	virtual Color get_color(Context context, const Point &pos)const;
 	virtual synfig::Layer::Handle hit_check(synfig::Context context, const synfig::Point &point)const;
 	virtual Rect get_bounding_rect()const;
+	virtual bool is_context_preserved()const { return true; }
 
 protected:
 	virtual void sync_vfunc();
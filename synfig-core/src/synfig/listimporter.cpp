@@ -192,6 +192,7 @@ ListImporter::get_sub_importer(const RendDesc &renddesc, Time time, ProgressCall
 bool
 ListImporter::get_frame(Surface &surface, const RendDesc &renddesc, Time time, ProgressCallback *cb)
 {
+	std::lock_guard<std::recursive_mutex> lock(frame_mutex);
 	Importer::Handle importer = get_sub_importer(renddesc, time, cb);
 	return importer && importer->get_frame(surface, renddesc, 0, cb);
 }
@@ -199,6 +200,7 @@ ListImporter::get_frame(Surface &surface, const RendDesc &renddesc, Time time, P
 rendering::Surface::Handle
 ListImporter::get_frame(const RendDesc &renddesc, const Time &time)
 {
+	std::lock_guard<std::recursive_mutex> lock(frame_mutex);
 	Importer::Handle importer = get_sub_importer(renddesc, time, NULL);
 	return importer ? importer->get_frame(renddesc, 0) : new rendering::SurfaceSW();
 }
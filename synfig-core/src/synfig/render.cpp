@@ -31,6 +31,8 @@
 #endif
 
 #include <cassert>
+#include <algorithm>
+#include <vector>
 
 #include "render.h"
 
@@ -57,7 +59,7 @@ synfig::render(
 	ProgressCallback *callback)
 {
 	Point::value_type
-		u,v,		// Current location in image
+		v,			// Current location in image
 		su,sv,		// Starting locations
 		du, dv,		// Distance between pixels
 		dsu,dsv;	// Distance between subpixels
@@ -81,8 +83,11 @@ synfig::render(
 		x,y,		// Current location on output bitmap
 		x2,y2;		// Subpixel counters
 
-	Color::value_type
-		pool;		// Alpha pool (for correct alpha antialiasing)
+	std::vector<Color>
+		span(std::max(w, 1));	// Colors of the subpixels of the row
+
+	std::vector<Color::value_type>
+		pool(std::max(w, 1));	// Alpha pools (for correct alpha antialiasing)
 
 	assert(target);
 
@@ -137,37 +142,37 @@ synfig::render(
 				return false;
 			}
 
-		// Loop through every pixel in row
-		for(x=0,u=su;x<w;x++,u+=du)
-		{
-			Color &c(*(colordata++));
-			c=Color::alpha();
+		// Clear the row
+		for(x=0;x<w;x++)
+			{ colordata[x]=Color::alpha(); pool[x]=0; }
 
-			// Loop through all subpixels
-			for(y2=0,pool=0;y2<a;y2++)
-				for(x2=0;x2<a;x2++)
+		// Loop through all subpixels, each of them
+		// is fetched for the whole row at once
+		for(y2=0;y2<a;y2++)
+			for(x2=0;x2<a;x2++)
+			{
+				context.get_color_span(
+					Point(
+						su+(Point::value_type)(x2)*dsu,
+						v+(Point::value_type)(y2)*dsv
+						),
+					Vector(du, 0),
+					w,
+					&span.front()
+					);
+				for(x=0;x<w;x++)
 				{
-					Color color=context.get_color(
-						Point(
-							u+(Point::value_type)(x2)*dsu,
-							v+(Point::value_type)(y2)*dsv
-							)
-						);
+					Color color=span[x];
 					if(!no_clamp)
-					{
 						color=color.clamped();
-						c+=color*color.get_a();
-						pool+=color.get_a();
-					}
-					else
-					{
-						c+=color*color.get_a();
-						pool+=color.get_a();
-					}
+					colordata[x]+=color*color.get_a();
+					pool[x]+=color.get_a();
 				}
-			if(pool)
-				c/=pool;
-		}
+			}
+
+		for(x=0;x<w;x++)
+			if(pool[x])
+				colordata[x]/=pool[x];
 
 		// Send the buffer to the render target.
 		// If anything goes wrong, cleanup and bail.
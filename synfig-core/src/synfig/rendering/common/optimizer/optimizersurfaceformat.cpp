@@ -0,0 +1,141 @@
+/* === S Y N F I G ========================================================= */
+/*!	\file synfig/rendering/common/optimizer/optimizersurfaceformat.cpp
+**	\brief OptimizerSurfaceFormat
+**
+**	$Id$
+**
+**	\legal
+**	......... ... 2026 Synfig contributors
+**
+**	This package is free software; you can redistribute it and/or
+**	modify it under the terms of the GNU General Public License as
+**	published by the Free Software Foundation; either version 2 of
+**	the License, or (at your option) any later version.
+**
+**	This package is distributed in the hope that it will be useful,
+**	but WITHOUT ANY WARRANTY; without even the implied warranty of
+**	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+**	General Public License for more details.
+**	\endlegal
+*/
+/* ========================================================================= */
+
+/* === H E A D E R S ======================================================= */
+
+#ifdef USING_PCH
+#	include "pch.h"
+#else
+#ifdef HAVE_CONFIG_H
+#	include <config.h>
+#endif
+
+#include <map>
+#include <set>
+
+#include <synfig/general.h>
+#include <synfig/localization.h>
+
+#include "optimizersurfaceformat.h"
+
+#include "../task/taskcontour.h"
+#include "../task/taskpixelprocessor.h"
+#include "../task/tasktransformation.h"
+
+#endif
+
+using namespace synfig;
+using namespace rendering;
+
+/* === M A C R O S ========================================================= */
+
+/* === G L O B A L S ======================================================= */
+
+/* === P R O C E D U R E S ================================================= */
+
+namespace {
+
+typedef std::map<SurfaceResource::Handle, int> Counters;
+typedef std::set<SurfaceResource::Handle> Surfaces;
+
+//! Transformation of image from Layer_Bitmap (non-temporary surface),
+//! or pixel processor (gamma, color matrix) applied to such result
+bool
+is_bitmap(const Task::Handle &task, const Surfaces &bitmaps)
+{
+	if (!task.type_is<TaskTransformation>() && !task.type_is<TaskPixelProcessor>())
+		return false;
+	if (task->sub_tasks.size() != 1 || !task->sub_task(0) || !task->sub_task(0)->target_surface)
+		return false;
+	const SurfaceResource::Handle &surface = task->sub_task(0)->target_surface;
+	return !surface->is_temporary() || bitmaps.count(surface);
+}
+
+} // end of anonimous namespace
+
+/* === M E T H O D S ======================================================= */
+
+OptimizerSurfaceFormat::OptimizerSurfaceFormat(
+	const Surface::Token::Handle &contour_token,
+	const Surface::Token::Handle &bitmap_token,
+	const Surface::Token::Handle &other_token
+):
+	contour_token(contour_token),
+	bitmap_token(bitmap_token),
+	other_token(other_token)
+{
+	category_id = CATEGORY_ID_LIST;
+	depends_from = CATEGORY_SPECIALIZED;
+	for_list = true;
+}
+
+void
+OptimizerSurfaceFormat::run(const RunParams &params) const
+{
+	if (!params.list) return;
+
+	// list is linear, so sub-tasks are TaskSurface which refers to results of previous tasks
+	Counters writers, readers;
+	for(Task::List::const_iterator i = params.list->begin(); i != params.list->end(); ++i)
+	{
+		if (!*i) continue;
+		if ((*i)->target_surface)
+			++writers[(*i)->target_surface];
+		for(Task::List::const_iterator j = (*i)->sub_tasks.begin(); j != (*i)->sub_tasks.end(); ++j)
+			if (*j && (*j)->target_surface)
+				++readers[(*j)->target_surface];
+	}
+
+	Surfaces bitmaps;
+	bool changed = false;
+	for(Task::List::iterator i = params.list->begin(); i != params.list->end(); ++i)
+	{
+		if (!*i || !(*i)->target_surface || (*i)->target_storage_token)
+			continue;
+		SurfaceResource::Handle surface = (*i)->target_surface;
+
+		Surface::Token::Handle token = other_token;
+		if (i->type_is<TaskContour>()) {
+			token = contour_token;
+		} else
+		if (is_bitmap(*i, bitmaps)) {
+			bitmaps.insert(surface);
+			token = bitmap_token;
+		}
+
+		// surface written by several tasks may be still in use as target
+		if ( !token
+		  || !surface->is_temporary()
+		  || writers[surface] != 1
+		  || !readers[surface] )
+			continue;
+
+		*i = (*i)->clone();
+		(*i)->target_storage_token = token;
+		changed = true;
+	}
+
+	if (changed)
+		apply(params);
+}
+
+/* === E N T R Y P O I N T ================================================= */
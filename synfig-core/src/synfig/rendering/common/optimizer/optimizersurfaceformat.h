@@ -0,0 +1,68 @@
+/* === S Y N F I G ========================================================= */
+/*!	\file synfig/rendering/common/optimizer/optimizersurfaceformat.h
+**	\brief OptimizerSurfaceFormat Header
+**
+**	$Id$
+**
+**	\legal
+**	......... ... 2026 Synfig contributors
+**
+**	This package is free software; you can redistribute it and/or
+**	modify it under the terms of the GNU General Public License as
+**	published by the Free Software Foundation; either version 2 of
+**	the License, or (at your option) any later version.
+**
+**	This package is distributed in the hope that it will be useful,
+**	but WITHOUT ANY WARRANTY; without even the implied warranty of
+**	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+**	General Public License for more details.
+**	\endlegal
+*/
+/* ========================================================================= */
+
+/* === S T A R T =========================================================== */
+
+#ifndef __SYNFIG_RENDERING_OPTIMIZERSURFACEFORMAT_H
+#define __SYNFIG_RENDERING_OPTIMIZERSURFACEFORMAT_H
+
+/* === H E A D E R S ======================================================= */
+
+#include "../../optimizer.h"
+
+/* === M A C R O S ========================================================= */
+
+/* === T Y P E D E F S ===================================================== */
+
+/* === C L A S S E S & S T R U C T S ======================================= */
+
+namespace synfig
+{
+namespace rendering
+{
+
+//! Chooses format to keep intermediate result of each task in (Task::target_storage_token).
+//! Only temporary surfaces written by one task and read by others are changed,
+//! tasks still render in their own format, RenderQueue converts result when task is done.
+class OptimizerSurfaceFormat: public Optimizer
+{
+public:
+	//! format for shapes and masks (results of TaskContour)
+	const Surface::Token::Handle contour_token;
+	//! format for transformed images (Layer_Bitmap) and their pixel corrections
+	const Surface::Token::Handle bitmap_token;
+	//! format for all other intermediate results, null keeps the format of task
+	const Surface::Token::Handle other_token;
+
+	OptimizerSurfaceFormat(
+		const Surface::Token::Handle &contour_token,
+		const Surface::Token::Handle &bitmap_token,
+		const Surface::Token::Handle &other_token = Surface::Token::Handle() );
+	virtual void run(const RunParams &params) const;
+};
+
+} /* end namespace rendering */
+} /* end namespace synfig */
+
+/* -- E N D ----------------------------------------------------------------- */
+
+#endif
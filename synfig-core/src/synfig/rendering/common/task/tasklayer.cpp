@@ -129,4 +129,8 @@ TaskLayer::set_coords_sub_tasks()
 	}
 }
 
+bool
+TaskLayer::is_splittable() const
+	{ return layer && layer->get_rendering_neighbourhood() >= 0.0; }
+
 /* === E N T R Y P O I N T ================================================= */
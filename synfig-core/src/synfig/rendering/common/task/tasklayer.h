@@ -42,7 +42,8 @@ namespace synfig
 namespace rendering
 {
 
-class TaskLayer: public Task
+class TaskLayer: public Task,
+	public TaskInterfaceSplit
 {
 public:
 	typedef etl::handle<TaskLayer> Handle;
@@ -56,6 +57,7 @@ public:
 
 	virtual Rect calc_bounds() const;
 	virtual void set_coords_sub_tasks();
+	virtual bool is_splittable() const;
 
 private:
 	static bool renddesc_less(const RendDesc &a, const RendDesc &b);
@@ -25,6 +25,8 @@
 #ifndef __SYNFIG_RENDERING_OPTIMIZER_H
 #define __SYNFIG_RENDERING_OPTIMIZER_H
 
+#include <atomic>
+
 #include "task.h"
 
 /* === M A C R O S ========================================================= */
@@ -212,8 +214,15 @@ public:
 	//! Optimizer runs for task after all of sub-tasks are processed
 	bool deep_first;
 
+	//! Count of calls and applied changes, counted only while tracing is enabled
+	mutable std::atomic<long long> stats_calls;
+	mutable std::atomic<long long> stats_changes;
+
 
-	Optimizer(): category_id(), order(), index(), depends_from(), affects_to(), mode(), for_list(), for_task(), for_root_task(), deep_first() { }
+	Optimizer():
+		category_id(), order(), index(), depends_from(), affects_to(), mode(),
+		for_list(), for_task(), for_root_task(), deep_first(),
+		stats_calls(0), stats_changes(0) { }
 	virtual ~Optimizer();
 
 	static bool less(const Handle &a, const Handle &b)
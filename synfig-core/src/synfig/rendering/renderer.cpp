@@ -30,11 +30,17 @@
 #endif
 
 #include <algorithm> // std::sort
+#include <iterator>
 #include <cstdlib>
 #include <climits>
 
+#include <set>
 #include <typeinfo>
 
+#ifdef __GNUG__
+#include <cxxabi.h>
+#endif
+
 #include <ETL/stringf>
 
 #include <synfig/general.h>
@@ -43,6 +49,7 @@
 #include <synfig/debug/debugsurface.h>
 #include <synfig/debug/log.h>
 #include <synfig/debug/measure.h>
+#include <synfig/debug/trace.h>
 
 #include "renderer.h"
 #include "renderqueue.h"
@@ -80,6 +87,33 @@ using namespace rendering;
 
 /* === P R O C E D U R E S ================================================= */
 
+namespace {
+	//! Sorted array of task indices, used by Renderer::find_deps
+	class IndexSet: public std::vector<int>
+	{
+	public:
+		bool contains(int x) const
+			{ return std::binary_search(begin(), end(), x); }
+		void insert(int x) {
+			iterator i = std::lower_bound(begin(), end(), x);
+			if (i == end() || *i != x) std::vector<int>::insert(i, x);
+		}
+		void erase(int x) {
+			iterator i = std::lower_bound(begin(), end(), x);
+			if (i != end() && *i == x) std::vector<int>::erase(i);
+		}
+	};
+
+	String format_deps(TaskGraph::Iterator begin, TaskGraph::Iterator end)
+	{
+		if (begin == end) return String();
+		String s;
+		for(TaskGraph::Iterator i = begin; i != end; ++i)
+			s += etl::strprintf("%d ", *i + 1);
+		return "(" + s.substr(0, s.size()-1) + ") ";
+	}
+}
+
 /* === M E T H O D S ======================================================= */
 
 Renderer::Handle Renderer::blank;
@@ -313,6 +347,20 @@ Renderer::subtasks_count(const Task::Handle &task, int max_count) const {
 	return count;
 }
 
+Real
+Renderer::get_optimization_weight(const Optimizer::List &optimizers, const Task::Handle &task) const
+{
+	int counter_limit = 32;
+	int counter_prophecy = 256;
+	Real counter_weight = (Real)optimizers.size()/(Real)1024;
+	if (counter_prophecy * counter_weight < 0.75)
+		{ counter_limit = 0; counter_prophecy = 0; }
+
+	int cnt = task ? subtasks_count(task, counter_limit) : 0;
+	if (cnt >= counter_limit && cnt < counter_prophecy) cnt = counter_prophecy;
+	return (Real)cnt*counter_weight;
+}
+
 
 bool
 Renderer::call_optimizers(
@@ -334,9 +382,12 @@ Renderer::call_optimizers(
 				p.ref_affects_to = 0;
 				(*i)->run(p);
 
+				bool stats = debug::Trace::is_enabled();
+				if (stats) ++(*i)->stats_calls;
 				if (calls_count) ++(*calls_count);
 				if (params.ref_task != p.ref_task)
 				{
+					if (stats) ++(*i)->stats_changes;
 					if (optimizations_count) ++(*optimizations_count);
 					#ifdef DEBUG_OPTIMIZATION_EACH_CHANGE
 					log("", *params.list, (typeid(**i).name() + 19), &p);
@@ -384,12 +435,6 @@ Renderer::optimize_recursive(
 	int count = max_level > 0 ? params->ref_task->sub_tasks.size() : 0;
 	if (count > 0)
 	{
-		int counter_limit = 32;
-		int counter_prophecy = 256;
-		Real counter_weight = (Real)optimizers->size()/(Real)1024;
-		if (counter_prophecy * counter_weight < 0.75)
-			{ counter_limit = 0; counter_prophecy = 0; }
-
 		// prepare params
 		bool task_clonned = false;
 		std::vector<Optimizer::RunParams> sub_params(count);
@@ -413,10 +458,7 @@ Renderer::optimize_recursive(
 							  : (sp.ref_mode & Optimizer::MODE_RECURSIVE) ? INT_MAX : 0;
 				sp.ref_mode = 0;
 
-				int cnt = subtasks_count(sp.ref_task, counter_limit);
-				if (cnt >= counter_limit && cnt < counter_prophecy) cnt = counter_prophecy;
-				Real weight = (Real)cnt*counter_weight;
-
+				Real weight = get_optimization_weight(*optimizers, sp.ref_task);
 				group.enqueue( sigc::bind( sigc::mem_fun(this, &Renderer::optimize_recursive),
 					optimizers,
 					&sp,
@@ -484,12 +526,45 @@ Renderer::optimize_recursive(
 		return;
 }
 
+void
+Renderer::optimize_root(
+	const Optimizer::List *optimizers,
+	Optimizer::RunParams *params,
+	bool for_task,
+	std::atomic<int> *calls_count,
+	std::atomic<int> *optimizations_count ) const
+{
+	// repeat optimization of the root task while optimizers ask for it (see Optimizer::MODE_REPEAT_LAST)
+	Optimizer::Category affected = 0;
+	bool nonrecursive = false;
+	while(params->ref_task && !(affected & params->depends_from))
+	{
+		Optimizer::RunParams p(params->depends_from, params->ref_task, params->list);
+		optimize_recursive(
+			optimizers,
+			&p,
+			calls_count,
+			optimizations_count,
+			!for_task ? 0 : nonrecursive ? 1 : INT_MAX );
+		affected |= p.ref_affects_to;
+
+		bool changed = p.ref_task != params->ref_task;
+		params->ref_task = p.ref_task;
+		if (!changed || (p.ref_mode & Optimizer::MODE_REPEAT_LAST) != Optimizer::MODE_REPEAT_LAST)
+			break;
+		// check non-recursive flag (see Optimizer::MODE_RECURSIVE)
+		nonrecursive = !(p.ref_mode & Optimizer::MODE_RECURSIVE);
+	}
+	params->ref_affects_to = affected;
+}
+
 void
 Renderer::optimize(Task::List &list) const
 {
 	#ifdef DEBUG_TASK_MEASURE
 	debug::Measure t("Renderer::optimize");
 	#endif
+	SYNFIG_TRACE_SCOPE("Renderer::optimize");
 
 	#ifdef DEBUG_OPTIMIZATION_COUNTERS
 	debug::Log::info("", "optimize %d tasks", count_tasks(list));
@@ -601,10 +676,45 @@ Renderer::optimize(Task::List &list) const
 
 					if (calls_count_ptr) ++(*calls_count_ptr);
 					if (optimizations_count_ptr && params.ref_affects_to) ++(*optimizations_count_ptr);
+					if (debug::Trace::is_enabled()) {
+						++(*i)->stats_calls;
+						if (params.ref_affects_to) ++(*i)->stats_changes;
+					}
 				}
 			}
 		}
 
+		if ((for_task || for_root_task) && list.size() > 1 && !(categories_to_process & depends_from))
+		{
+			// optimize independent roots simultaneously,
+			// results are merged in order of the list, so it's the same for any count of threads
+			std::vector<Optimizer::RunParams> roots;
+			roots.reserve(list.size());
+			ThreadPool::Group group;
+			for(Task::List::const_iterator j = list.begin(); j != list.end(); ++j)
+			{
+				if (!*j) continue;
+				roots.push_back(Optimizer::RunParams(depends_from, *j, &list));
+				group.enqueue( sigc::bind( sigc::mem_fun(this, &Renderer::optimize_root),
+					&current_optimizers,
+					&roots.back(),
+					for_task,
+					calls_count_ptr,
+					optimizations_count_ptr ), get_optimization_weight(current_optimizers, *j) );
+			}
+			group.run();
+
+			Task::List optimized_list;
+			optimized_list.reserve(roots.size());
+			for(std::vector<Optimizer::RunParams>::const_iterator j = roots.begin(); j != roots.end(); ++j)
+			{
+				if (j->ref_task)
+					optimized_list.push_back(j->ref_task);
+				categories_to_process |= current_affected |= j->ref_affects_to;
+			}
+			list.swap(optimized_list);
+		}
+		else
 		if (for_task || for_root_task)
 		{
 			bool nonrecursive = false;
@@ -671,47 +781,116 @@ Renderer::optimize(Task::List &list) const
 	remove_dummy(list);
 }
 
+String
+Renderer::get_deps_plan_key(const Task::List &list)
+{
+	// key contains everything what find_deps and Task::allow_run_before look at,
+	// surfaces are numbered in order of the first use
+	std::map<SurfaceResource*, int> surfaces;
+	std::vector<long long> key;
+	key.reserve(list.size()*16);
+	for(Task::List::const_iterator i = list.begin(); i != list.end(); ++i)
+	{
+		const Task &task = **i;
+		key.push_back((long long)(size_t)task.get_token().operator->());
+		Surface::Token::Handle target_token = task.get_target_token();
+		key.push_back(target_token ? (long long)(size_t)target_token.operator->() : 0);
+		key.push_back(task.get_allow_multithreading());
+		key.push_back(task.get_mode_allow_simultaneous_write());
+
+		Task::List::const_iterator sub = task.sub_tasks.begin();
+		for(int j = -1; j < (int)task.sub_tasks.size(); ++j)
+		{
+			const Task *t = j < 0 ? &task : sub++->get();
+			if (!t) { key.push_back(-1); continue; }
+			key.push_back(t->is_valid());
+			int index = (int)surfaces.size();
+			key.push_back(surfaces.insert(std::make_pair(t->target_surface.get(), index)).first->second);
+			key.push_back(t->target_rect.minx);
+			key.push_back(t->target_rect.miny);
+			key.push_back(t->target_rect.maxx);
+			key.push_back(t->target_rect.maxy);
+		}
+		key.push_back(-2);
+	}
+	return key.empty() ? String() : String((const char*)&key.front(), key.size()*sizeof(key.front()));
+}
+
+bool
+Renderer::apply_deps_plan(const String &key, DepsPlan &deps) const
+{
+	std::lock_guard<std::mutex> lock(plans_mutex);
+	DepsPlanMap::const_iterator plan = plans.find(key);
+	if (plan == plans.end())
+		return false;
+	deps = plan->second;
+	return true;
+}
+
 void
-Renderer::find_deps(const Task::List &list, long long batch_index) const
+Renderer::store_deps_plan(const String &key, const DepsPlan &deps) const
+{
+	const size_t max_plans = 16;
+
+	std::lock_guard<std::mutex> lock(plans_mutex);
+	if (!plans.insert(DepsPlanMap::value_type(key, deps)).second)
+		return;
+	plans_order.push_back(key);
+	while(plans_order.size() > max_plans)
+		{ plans.erase(plans_order.front()); plans_order.pop_front(); }
+}
+
+void
+Renderer::find_deps(const Task::List &list, long long batch_index, DepsPlan &deps) const
 {
 	#ifdef DEBUG_TASK_MEASURE
 	debug::Measure t("Renderer::find_deps");
 	#endif
+	SYNFIG_TRACE_SCOPE("Renderer::find_deps", (int)batch_index);
+
+	// in animation the same set of tasks usually comes from frame to frame,
+	// so reuse dependencies found for one of the previous batches
+	String plan_key = get_deps_plan_key(list);
+	deps.clear();
+	if (apply_deps_plan(plan_key, deps)) {
+		assert(deps.size() == list.size());
+		return;
+	}
 
-	typedef std::map<SurfaceResource::Handle, Task::Handle> DepTargetPrevMap;
-	DepTargetPrevMap target_prev_map;
-	Task::Set tasks_to_process;
+	// tasks are addressed by their indices in the list
+	const int count = (int)list.size();
+	std::vector<IndexSet> hard_deps(count);
+	std::vector<IndexSet> hard_back_deps(count);
+	std::vector<IndexSet> tmp_deps(count);
+	std::vector<IndexSet> tmp_back_deps(count);
+
+	std::map<const SurfaceResource*, int> target_prev_map;
+	std::set<int> tasks_to_process;
 	const int max_iterations = 50000;
 
 	// find dependencies by target surface
-	for(Task::List::const_iterator i = list.begin(); i != list.end(); ++i)
+	for(int i = 0; i < count; ++i)
 	{
-		Task::Handle task = *i;
-		Task::RendererData &task_rd = task->renderer_data;
-
-		assert(task_rd.index == 0);
-		assert(task_rd.batch_index == 0);
-		task_rd.batch_index = batch_index;
-		task_rd.index = i - list.begin() + 1;
-
-		task_rd.deps.clear();
-		task_rd.back_deps.clear();
-
-		if ((*i)->is_valid()) {
-			for(Task::List::const_iterator j = (*i)->sub_tasks.begin(); j != (*i)->sub_tasks.end(); ++j)
-				if (*j && (*j)->is_valid())
-					if (Task::Handle dep = target_prev_map[(*j)->target_surface]) {
-						if (task_rd.tmp_deps.empty()) tasks_to_process.insert(*i);
-						task_rd.tmp_deps.insert(dep);
-						dep->renderer_data.tmp_back_deps.insert(*i);
+		const Task &task = *list[i];
+		if (task.is_valid()) {
+			for(Task::List::const_iterator j = task.sub_tasks.begin(); j != task.sub_tasks.end(); ++j)
+				if (*j && (*j)->is_valid()) {
+					std::map<const SurfaceResource*, int>::const_iterator k = target_prev_map.find((*j)->target_surface.get());
+					if (k != target_prev_map.end()) {
+						if (tmp_deps[i].empty()) tasks_to_process.insert(i);
+						tmp_deps[i].insert(k->second);
+						tmp_back_deps[k->second].insert(i);
 					}
-			Task::Handle &dep = target_prev_map[(*i)->target_surface];
-			if (dep) {
-				if (task_rd.tmp_deps.empty()) tasks_to_process.insert(*i);
-				task_rd.tmp_deps.insert(dep);
-				dep->renderer_data.tmp_back_deps.insert(*i);
+				}
+			std::pair<std::map<const SurfaceResource*, int>::iterator, bool> k =
+				target_prev_map.insert(std::make_pair(task.target_surface.get(), i));
+			if (!k.second) {
+				int dep = k.first->second;
+				if (tmp_deps[i].empty()) tasks_to_process.insert(i);
+				tmp_deps[i].insert(dep);
+				tmp_back_deps[dep].insert(i);
+				k.first->second = i;
 			}
-			dep = *i;
 		}
 	}
 
@@ -719,69 +898,95 @@ Renderer::find_deps(const Task::List &list, long long batch_index) const
 	int iterations = 0;
 	while(iterations < max_iterations && !tasks_to_process.empty())
 	{
-		for(Task::Set::iterator i = tasks_to_process.begin(); i != tasks_to_process.end();)
+		for(std::set<int>::iterator i = tasks_to_process.begin(); i != tasks_to_process.end();)
 		{
-			Task::Handle task = *i;
-			Task::RendererData &task_rd = task->renderer_data;
-			assert(!task_rd.tmp_deps.empty());
-
-			Task::Handle dep = *task_rd.tmp_deps.begin();
-			Task::RendererData &dep_rd = dep->renderer_data;
-			task_rd.tmp_deps.erase( task_rd.tmp_deps.begin() );
-			dep_rd.tmp_back_deps.erase(task);
-
-			if (!task->allow_run_before(*dep)) {
-				task_rd.deps.insert(dep);
-				dep_rd.back_deps.insert(task);
+			const int task = *i;
+			assert(!tmp_deps[task].empty());
+
+			const int dep = tmp_deps[task].front();
+			tmp_deps[task].erase(dep);
+			tmp_back_deps[dep].erase(task);
+
+			if (!list[task]->allow_run_before(*list[dep])) {
+				hard_deps[task].insert(dep);
+				hard_back_deps[dep].insert(task);
 				++iterations;
 			} else {
-				iterations += dep_rd.deps.size() + dep_rd.tmp_deps.size() + task_rd.back_deps.size() + task_rd.tmp_back_deps.size();
-				for(Task::Set::iterator j = dep_rd.deps.begin(); j != dep_rd.deps.end(); ++j)
-					if (task_rd.deps.count(*j) == 0) {
-						task_rd.tmp_deps.insert(*j);
-						(*j)->renderer_data.tmp_back_deps.insert(task);
+				iterations += hard_deps[dep].size() + tmp_deps[dep].size() + hard_back_deps[task].size() + tmp_back_deps[task].size();
+				for(IndexSet::const_iterator j = hard_deps[dep].begin(); j != hard_deps[dep].end(); ++j)
+					if (!hard_deps[task].contains(*j)) {
+						tmp_deps[task].insert(*j);
+						tmp_back_deps[*j].insert(task);
 					}
-				for(Task::Set::iterator j = dep_rd.tmp_deps.begin(); j != dep_rd.tmp_deps.end(); ++j)
-					if (task_rd.deps.count(*j) == 0) {
-						task_rd.tmp_deps.insert(*j);
-						(*j)->renderer_data.tmp_back_deps.insert(task);
+				for(IndexSet::const_iterator j = tmp_deps[dep].begin(); j != tmp_deps[dep].end(); ++j)
+					if (!hard_deps[task].contains(*j)) {
+						tmp_deps[task].insert(*j);
+						tmp_back_deps[*j].insert(task);
 					}
-				for(Task::Set::iterator j = task_rd.back_deps.begin(); j != task_rd.back_deps.end(); ++j)
-					if ((*j)->renderer_data.deps.count(dep) == 0) {
-						if ((*j)->renderer_data.tmp_deps.empty()) tasks_to_process.insert(*j);
-						(*j)->renderer_data.tmp_deps.insert(dep);
-						dep_rd.tmp_back_deps.insert(*j);
+				for(IndexSet::const_iterator j = hard_back_deps[task].begin(); j != hard_back_deps[task].end(); ++j)
+					if (!hard_deps[*j].contains(dep)) {
+						if (tmp_deps[*j].empty()) tasks_to_process.insert(*j);
+						tmp_deps[*j].insert(dep);
+						tmp_back_deps[dep].insert(*j);
 					}
-				for(Task::Set::iterator j = task_rd.tmp_back_deps.begin(); j != task_rd.tmp_back_deps.end(); ++j)
-					if ((*j)->renderer_data.deps.count(dep) == 0) {
-						(*j)->renderer_data.tmp_deps.insert(dep);
-						dep_rd.tmp_back_deps.insert(*j);
+				for(IndexSet::const_iterator j = tmp_back_deps[task].begin(); j != tmp_back_deps[task].end(); ++j)
+					if (!hard_deps[*j].contains(dep)) {
+						tmp_deps[*j].insert(dep);
+						tmp_back_deps[dep].insert(*j);
 					}
 			}
 
-			Task::Set::iterator j = i;
+			std::set<int>::iterator j = i;
 			++i;
 			++iterations;
 
-			if (task_rd.tmp_deps.empty())
+			if (tmp_deps[task].empty())
 				tasks_to_process.erase(j);
 		}
 	}
 
 	#ifdef DEBUG_TASK_MEASURE
-	info("find deps iterations: %d (%d from %d tasks not optimized)", iterations, (int)tasks_to_process.size(), (int)list.size());
+	info("find deps iterations: %d (%d from %d tasks not optimized)", iterations, (int)tasks_to_process.size(), count);
 	#endif
 
-	// copy tmp_deps to deps
-	for(Task::List::const_iterator i = list.begin(); i != list.end(); ++i) {
-		Task::Handle task = *i;
-		Task::RendererData &task_rd = task->renderer_data;
+	// merge tmp_deps into deps
+	deps.resize(count);
+	for(int i = 0; i < count; ++i) {
+		deps[i].reserve(hard_deps[i].size() + tmp_deps[i].size());
+		std::set_union(
+			hard_deps[i].begin(), hard_deps[i].end(),
+			tmp_deps[i].begin(), tmp_deps[i].end(),
+			std::back_inserter(deps[i]) );
+	}
+
+	store_deps_plan(plan_key, deps);
+}
 
-		task_rd.deps     .insert(task_rd.tmp_deps     .begin(), task_rd.tmp_deps     .end());
-		task_rd.back_deps.insert(task_rd.tmp_back_deps.begin(), task_rd.tmp_back_deps.end());
+void
+Renderer::find_last_use(const Task::List &list, const Task::List &outputs) const
+{
+	// results of the batch are used by caller after rendering
+	std::set<SurfaceResource::Handle> protect;
+	for(Task::List::const_iterator i = outputs.begin(); i != outputs.end(); ++i)
+		if (*i) protect.insert((*i)->target_surface);
 
-		task_rd.tmp_deps.clear();
-		task_rd.tmp_back_deps.clear();
+	// every task holds one reference to each temporary surface which it writes or reads,
+	// the surface is released when the last of these tasks is done
+	for(Task::List::const_iterator i = list.begin(); i != list.end(); ++i)
+	{
+		std::vector<SurfaceResource::Handle> &surfaces = (*i)->renderer_data.surfaces_to_release;
+		surfaces.clear();
+		if ((*i)->target_surface)
+			surfaces.push_back((*i)->target_surface);
+		for(Task::List::const_iterator j = (*i)->sub_tasks.begin(); j != (*i)->sub_tasks.end(); ++j)
+			if (*j && (*j)->target_surface)
+				surfaces.push_back((*j)->target_surface);
+
+		std::sort(surfaces.begin(), surfaces.end());
+		surfaces.erase(std::unique(surfaces.begin(), surfaces.end()), surfaces.end());
+		for(std::vector<SurfaceResource::Handle>::iterator j = surfaces.begin(); j != surfaces.end();)
+			if (!(*j)->is_temporary() || protect.count(*j))
+				j = surfaces.erase(j); else (*j++)->add_user();
 	}
 }
 
@@ -839,7 +1044,21 @@ Renderer::enqueue(const Task::List &list, const TaskEvent::Handle &finish_event_
 
 	Task::List optimized_list(list);
 	optimize(optimized_list);
-	find_deps(optimized_list, ++last_batch_index);
+	long long batch_index = ++last_batch_index;
+	DepsPlan deps;
+	find_deps(optimized_list, batch_index, deps);
+	find_last_use(optimized_list, list);
+
+	// finish event depends on all tasks of the batch
+	deps.push_back(std::vector<int>(optimized_list.size()));
+	for(int i = 0; i < (int)optimized_list.size(); ++i)
+		deps.back()[i] = i;
+	optimized_list.push_back(finish_event_task);
+	TaskGraph::create(optimized_list, deps, batch_index);
+
+	MemoryMeter::Handle memory_meter = MemoryMeter::get_current();
+	for(Task::List::const_iterator i = optimized_list.begin(); i != optimized_list.end(); ++i)
+		(*i)->renderer_data.memory_meter = memory_meter;
 
 	#ifdef DEBUG_TASK_LIST
 	if (!quiet) log("", optimized_list, "optimized list");
@@ -848,14 +1067,6 @@ Renderer::enqueue(const Task::List &list, const TaskEvent::Handle &finish_event_
 	if (!quiet && !get_debug_options().task_list_optimized_log.empty())
 		log(get_debug_options().task_list_optimized_log, optimized_list, "optimized list");
 
-	if (finish_event_task)
-	{
-		finish_event_task->renderer_data.deps.insert(optimized_list.begin(), optimized_list.end());
-		for(Task::List::const_iterator i = optimized_list.begin(); i != optimized_list.end(); ++i)
-			(*i)->renderer_data.back_deps.insert(finish_event_task);
-		optimized_list.push_back(finish_event_task);
-	}
-
 	// try to find existing handle to this renderer instead,
 	// because creation and destruction of handle may cause destruction of renderer
 	// if it never stored in handles before
@@ -886,25 +1097,10 @@ Renderer::log(
 		const Task::RendererData &trd = t->renderer_data;
 
 		String deps;
-		if (!trd.deps.empty())
-		{
-			std::multiset<int> deps_set;
-			for(Task::Set::const_iterator i = trd.deps.begin(); i != trd.deps.end(); ++i)
-				deps_set.insert((*i)->renderer_data.index);
-			for(std::multiset<int>::const_iterator i = deps_set.begin(); i != deps_set.end(); ++i)
-				deps += etl::strprintf("%d ", *i);
-			deps = "(" + deps.substr(0, deps.size()-1) + ") ";
-		}
-
 		String back_deps;
-		if (!trd.back_deps.empty())
-		{
-			std::multiset<int> back_deps_set;
-			for(Task::Set::const_iterator i = trd.back_deps.begin(); i != trd.back_deps.end(); ++i)
-				back_deps_set.insert((*i)->renderer_data.index);
-			for(std::multiset<int>::const_iterator i = back_deps_set.begin(); i != back_deps_set.end(); ++i)
-				back_deps += etl::strprintf("%d ", *i);
-			back_deps = "(" + back_deps.substr(0, back_deps.size()-1) + ") ";
+		if (trd.graph) {
+			deps = format_deps(trd.graph->deps_begin(trd.index - 1), trd.graph->deps_end(trd.index - 1));
+			back_deps = format_deps(trd.graph->back_deps_begin(trd.index - 1), trd.graph->back_deps_end(trd.index - 1));
 		}
 
 		String surfaces;
@@ -1043,4 +1239,42 @@ Renderer::get_renderers()
 	return *renderers;
 }
 
+void
+Renderer::trace_optimizers()
+{
+	if (!debug::Trace::is_enabled() || !renderers)
+		return;
+
+	// same optimizer may be registered in several renderers,
+	// and several optimizers may have the same class
+	std::set<const Optimizer*> visited;
+	std::map<String, std::pair<long long, long long> > stats;
+	for(std::map<String, Handle>::const_iterator r = renderers->begin(); r != renderers->end(); ++r)
+		for(int i = 0; i < Optimizer::CATEGORIES_COUNT; ++i)
+			for(Optimizer::List::const_iterator j = r->second->optimizers[i].begin(); j != r->second->optimizers[i].end(); ++j)
+			{
+				if (!visited.insert(j->get()).second) continue;
+
+				const char *mangled = typeid(**j).name();
+				String name = mangled;
+				#ifdef __GNUG__
+				int status = 0;
+				if (char *demangled = abi::__cxa_demangle(mangled, NULL, NULL, &status))
+					{ name = demangled; free(demangled); }
+				#endif
+				if (name.compare(0, 19, "synfig::rendering::") == 0)
+					name = name.substr(19);
+
+				std::pair<long long, long long> &s = stats[name];
+				s.first += (*j)->stats_calls;
+				s.second += (*j)->stats_changes;
+			}
+
+	for(std::map<String, std::pair<long long, long long> >::const_iterator i = stats.begin(); i != stats.end(); ++i)
+	{
+		debug::Trace::set_counter(i->first, "calls", i->second.first);
+		debug::Trace::set_counter(i->first, "changes", i->second.second);
+	}
+}
+
 /* === E N T R Y P O I N T ================================================= */
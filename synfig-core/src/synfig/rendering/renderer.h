@@ -29,7 +29,10 @@
 
 #include <cstdio>
 
+#include <list>
 #include <map>
+#include <mutex>
+#include <vector>
 #include <atomic>
 
 #include "optimizer.h"
@@ -70,6 +73,15 @@ private:
 	ModeList modes;
 	Optimizer::List optimizers[Optimizer::CATEGORIES_COUNT];
 
+	//! Dependencies found for the optimized list of tasks,
+	//! stored as indices of the tasks in the list
+	typedef TaskGraph::DepsList DepsPlan;
+	typedef std::map<String, DepsPlan> DepsPlanMap;
+
+	mutable std::mutex plans_mutex;
+	mutable DepsPlanMap plans;
+	mutable std::list<String> plans_order;
+
 public:
 
 	virtual ~Renderer();
@@ -99,6 +111,8 @@ private:
 	void linearize(Task::List &list) const;
 
 	int subtasks_count(const Task::Handle &task, int max_count) const;
+	//! Estimated cost of optimization of the task tree, used to decide how to share work between threads
+	Real get_optimization_weight(const Optimizer::List &optimizers, const Task::Handle &task) const;
 
 	bool
 	call_optimizers(
@@ -115,6 +129,13 @@ private:
 		std::atomic<int> *optimizations_count,
 		int max_level ) const;
 
+	void optimize_root(
+		const Optimizer::List *optimizers,  // pass by pointer for use with sigc::bind
+		Optimizer::RunParams *params,
+		bool for_task,
+		std::atomic<int> *calls_count,
+		std::atomic<int> *optimizations_count ) const;
+
 	void optimize(Optimizer::Category category, Task::List &list) const;
 
 	void log(
@@ -136,7 +157,13 @@ private:
 	typedef std::multimap<DepTargetKey, DepTargetValue> DepTargetMap;
 	typedef DepTargetMap::value_type                    DepTargetPair;
 
-	void find_deps(const Task::List &list, long long batch_index) const;
+protected:
+	// steps of enqueue() after optimization, available for tests
+	static String get_deps_plan_key(const Task::List &list);
+	bool apply_deps_plan(const String &key, DepsPlan &deps) const;
+	void store_deps_plan(const String &key, const DepsPlan &deps) const;
+	void find_deps(const Task::List &list, long long batch_index, DepsPlan &deps) const;
+	void find_last_use(const Task::List &list, const Task::List &outputs) const;
 
 public:
 	int get_max_simultaneous_threads() const;
@@ -180,6 +207,10 @@ public:
 	static const Renderer::Handle& get_renderer(const String &name);
 	static const std::map<String, Handle>& get_renderers();
 
+	//! Writes total counts of calls and changes of optimizers of all renderers to the trace,
+	//! call it when rendering is finished
+	static void trace_optimizers();
+
 	static const DebugOptions& get_debug_options()
 		{ return debug_options; }
 
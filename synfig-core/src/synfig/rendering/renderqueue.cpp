@@ -31,12 +31,15 @@
 
 #include <cstdlib>
 
+#include <ETL/stringf>
 
 #include <synfig/general.h>
 #include <synfig/localization.h>
+#include <synfig/threadpool.h>
 #include <synfig/debug/debugsurface.h>
 #include <synfig/debug/log.h>
 #include <synfig/debug/measure.h>
+#include <synfig/debug/trace.h>
 
 #include "renderqueue.h"
 #include "renderer.h"
@@ -95,7 +98,7 @@ RenderQueue::start()
 	// one thread reserved for non-multithreading tasks (OpenGL)
 	// also this thread almost don't use CPU time
 	// so we have ~50% of one core for GUI
-	unsigned int count = std::thread::hardware_concurrency();
+	unsigned int count = ThreadPool::get_cpu_count();
 
 	#ifdef DEBUG_TASK_SURFACE
 	count = 2;
@@ -131,6 +134,10 @@ RenderQueue::stop()
 void
 RenderQueue::process(int thread_index)
 {
+	SYNFIG_TRACE_THREAD_NAME(etl::strprintf("render %d", thread_index));
+	// thread for non-multithreading tasks stays unbound
+	if (thread_index > 0)
+		ThreadPool::bind_thread(thread_index - 1);
 	while(Task::Handle task = get(thread_index))
 	{
 		#ifdef DEBUG_THREAD_TASK
@@ -149,9 +156,19 @@ RenderQueue::process(int thread_index)
 		}
 
 		bool success = false;
-		try {
-			success = task->run(task->renderer_data.params);
-		} catch(...) { }
+		{
+			VectorInt size = task->target_rect.get_size();
+			SYNFIG_TRACE_SCOPE(
+				task->get_token()->name.c_str(),
+				task->renderer_data.batch_index,
+				task->renderer_data.index,
+				size[0], size[1],
+				(long long)size[0]*size[1]*sizeof(Color) );
+			MemoryMeter::Scope memory_scope(task->renderer_data.memory_meter);
+			try {
+				success = task->run(task->renderer_data.params);
+			} catch(...) { }
+		}
 		if (!success)
 			task->renderer_data.success = false;
 
@@ -179,6 +196,7 @@ RenderQueue::process(int thread_index)
 			{
 				TaskSubQueue::Handle task_sub_queue(new TaskSubQueue());
 				task_sub_queue->sub_task() = task;
+				MemoryMeter::Scope memory_scope(task->renderer_data.memory_meter);
 				task->renderer_data.params.renderer->enqueue(task->renderer_data.params.sub_queue, task_sub_queue, true);
 				continue;
 			}
@@ -193,24 +211,36 @@ void
 RenderQueue::done(int thread_index, const Task::Handle &task)
 {
 	assert(task);
+
+	// return memory of intermediate surfaces to the pool
+	std::vector<SurfaceResource::Handle> &surfaces = task->renderer_data.surfaces_to_release;
+	for(std::vector<SurfaceResource::Handle>::iterator i = surfaces.begin(); i != surfaces.end(); ++i)
+		if ((*i)->release_user())
+			(*i)->clear();
+	surfaces.clear();
+
+	// keep finished result in format chosen by OptimizerSurfaceFormat
+	if (task->target_storage_token && task->target_surface && task->renderer_data.success) {
+		MemoryMeter::Scope memory_scope(task->renderer_data.memory_meter);
+		task->target_surface->compact(task->target_storage_token);
+	}
+
 	int single_signals = 0;
 	int signals = 0;
+	TaskGraph::TaskList ready;
 	std::lock_guard<std::mutex> lock(mutex);
-	for(Task::Set::iterator i = task->renderer_data.back_deps.begin(); i != task->renderer_data.back_deps.end(); ++i)
+	if (task->renderer_data.graph)
+		task->renderer_data.graph->set_done(task->renderer_data.index - 1, ready);
+	for(TaskGraph::TaskList::const_iterator i = ready.begin(); i != ready.end(); ++i)
 	{
-		assert(*i);
-		(*i)->renderer_data.deps.erase(task);
-		if ((*i)->renderer_data.deps.empty())
-		{
-			bool mt = (*i)->get_allow_multithreading();
-			TaskQueue &queue = mt ? ready_tasks     : single_ready_tasks;
-			TaskSet   &wait  = mt ? not_ready_tasks : single_not_ready_tasks;
-			wait.erase(*i);
-			queue.push_back(*i);
-			++(mt ? signals : single_signals);
-		}
+		const Task::Handle &t = *i;
+		bool mt = t->get_allow_multithreading();
+		TaskQueue &queue = mt ? ready_tasks     : single_ready_tasks;
+		TaskSet   &wait  = mt ? not_ready_tasks : single_not_ready_tasks;
+		wait.erase(t);
+		queue.push_back(t);
+		++(mt ? signals : single_signals);
 	}
-	task->renderer_data.back_deps.clear();
 	assert( tasks_in_process.count(thread_index) == 1 );
 	tasks_in_process.erase(thread_index);
 	//info("rendering threads used %d", tasks_in_process.size());
@@ -299,22 +329,30 @@ RenderQueue::remove_if_orphan(const Task::Handle &task, bool in_queue)
 		if (!task_event->is_finished())
 			return false;
 
-	if (!task->renderer_data.back_deps.empty())
+	if (task->renderer_data.has_back_deps())
 		return false;
-		
-	for(TaskSet::iterator i = task->renderer_data.deps.begin(); i != task->renderer_data.deps.end(); ++i)
-		if (*i) {
-			(*i)->renderer_data.back_deps.erase(task);
-			if ((*i)->renderer_data.back_deps.empty())
-				remove_if_orphan(*i, false);
-		}
-	task->renderer_data.deps.clear();
+
+	remove_from_graph(task);
 
 	// don't remove task if 'in_queue' is set (it will removed by caller)
 	if (tasks) tasks->erase(ii);
 	return true;
 }
 
+void
+RenderQueue::remove_from_graph(const Task::Handle &task)
+{
+	// mutex must be already locked
+
+	// removed task must not be touched by its dependencies when they are done
+	const Task::RendererData &rd = task->renderer_data;
+	if (!rd.graph) return;
+	TaskGraph::TaskList orphans;
+	rd.graph->remove(rd.index - 1, orphans);
+	for(TaskGraph::TaskList::const_iterator i = orphans.begin(); i != orphans.end(); ++i)
+		remove_if_orphan(*i, false);
+}
+
 void
 RenderQueue::remove_orphans()
 {
@@ -342,7 +380,7 @@ RenderQueue::enqueue(const Task::Handle &task, const Task::RunParams &params)
 	bool mt = task->get_allow_multithreading();
 	TaskQueue &queue = mt ? ready_tasks     : single_ready_tasks;
 	TaskSet   &wait  = mt ? not_ready_tasks : single_not_ready_tasks;
-	if (task->renderer_data.deps.empty()) {
+	if (task->renderer_data.is_ready()) {
 		queue.push_back(task);
 		(mt ? cond : single_cond).notify_one();
 	}
@@ -374,7 +412,7 @@ RenderQueue::enqueue(const Task::List &tasks, const Task::RunParams &params)
 			bool mt = (*i)->get_allow_multithreading();
 			TaskQueue &queue = mt ? ready_tasks     : single_ready_tasks;
 			TaskSet   &wait  = mt ? not_ready_tasks : single_not_ready_tasks;
-			if ((*i)->renderer_data.deps.empty()) {
+			if ((*i)->renderer_data.is_ready()) {
 				queue.push_back(*i);
 				++(mt ? signals : single_signals);
 			} else {
@@ -413,6 +451,7 @@ RenderQueue::remove_task(const Task::Handle &task)
 			}
 		}
 		if (wait.erase(task)) found = true;
+		if (found) remove_from_graph(task);
 	}
 	return found;
 }
@@ -459,6 +498,17 @@ void
 RenderQueue::clear()
 {
 	std::lock_guard<std::mutex> lock(mutex);
+
+	// mark all pending tasks as removed, so done() of tasks in process will not touch them
+	Task::List tasks(ready_tasks.begin(), ready_tasks.end());
+	tasks.insert(tasks.end(), single_ready_tasks.begin(), single_ready_tasks.end());
+	tasks.insert(tasks.end(), not_ready_tasks.begin(), not_ready_tasks.end());
+	tasks.insert(tasks.end(), single_not_ready_tasks.begin(), single_not_ready_tasks.end());
+	TaskGraph::TaskList orphans;
+	for(Task::List::const_iterator i = tasks.begin(); i != tasks.end(); ++i)
+		if (*i && (*i)->renderer_data.graph)
+			(*i)->renderer_data.graph->remove((*i)->renderer_data.index - 1, orphans);
+
 	ready_tasks.clear();
 	single_ready_tasks.clear();
 	not_ready_tasks.clear();
@@ -81,6 +81,7 @@ private:
 
 	static void fix_task(const Task &task, const Task::RunParams &params);
 	bool remove_if_orphan(const Task::Handle &task, bool in_queue);
+	void remove_from_graph(const Task::Handle &task);
 	void remove_orphans();
 	bool remove_task(const Task::Handle &task);
 
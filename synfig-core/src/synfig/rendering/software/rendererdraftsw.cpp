@@ -33,6 +33,8 @@
 
 #include "rendererdraftsw.h"
 
+#include "surfaceswhalf.h"
+#include "surfaceswrgba8.h"
 #include "task/tasksw.h"
 
 #include "../common/optimizer/optimizerblendassociative.h"
@@ -41,6 +43,7 @@
 #include "../common/optimizer/optimizerdraft.h"
 #include "../common/optimizer/optimizerlist.h"
 #include "../common/optimizer/optimizersplit.h"
+#include "../common/optimizer/optimizersurfaceformat.h"
 #include "../common/optimizer/optimizertransformation.h"
 #include "../common/optimizer/optimizerpass.h"
 
@@ -99,6 +102,10 @@ RendererDraftSW::RendererDraftSW()
 	register_optimizer(new OptimizerList());
 	register_optimizer(new OptimizerBlendAssociative());
 	//register_optimizer(new OptimizerSplit());
+	register_optimizer(new OptimizerSurfaceFormat(
+		SurfaceSWRGBA8::token.handle(),
+		SurfaceSWRGBA8::token.handle(),
+		SurfaceSWHalf::token.handle() ));
 }
 
 String RendererDraftSW::get_name() const
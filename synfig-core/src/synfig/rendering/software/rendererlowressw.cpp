@@ -33,6 +33,8 @@
 
 #include "rendererlowressw.h"
 
+#include "surfaceswhalf.h"
+#include "surfaceswrgba8.h"
 #include "task/tasksw.h"
 
 #include "../common/optimizer/optimizerblendassociative.h"
@@ -41,6 +43,7 @@
 #include "../common/optimizer/optimizerdraft.h"
 #include "../common/optimizer/optimizerlist.h"
 #include "../common/optimizer/optimizersplit.h"
+#include "../common/optimizer/optimizersurfaceformat.h"
 #include "../common/optimizer/optimizertransformation.h"
 #include "../common/optimizer/optimizerpass.h"
 
@@ -74,6 +77,10 @@ RendererLowResSW::RendererLowResSW(int level):
 	register_optimizer(new OptimizerList());
 	register_optimizer(new OptimizerBlendAssociative());
 	//register_optimizer(new OptimizerSplit());
+	register_optimizer(new OptimizerSurfaceFormat(
+		SurfaceSWRGBA8::token.handle(),
+		SurfaceSWRGBA8::token.handle(),
+		SurfaceSWHalf::token.handle() ));
 }
 
 String RendererLowResSW::get_name() const
@@ -33,6 +33,8 @@
 
 #include "rendererpreviewsw.h"
 
+#include "surfaceswhalf.h"
+#include "surfaceswrgba8.h"
 #include  "task/tasksw.h"
 
 #include "../common/optimizer/optimizerblendassociative.h"
@@ -40,6 +42,7 @@
 #include "../common/optimizer/optimizerblendtotarget.h"
 #include "../common/optimizer/optimizerlist.h"
 #include "../common/optimizer/optimizersplit.h"
+#include "../common/optimizer/optimizersurfaceformat.h"
 #include "../common/optimizer/optimizertransformation.h"
 #include "../common/optimizer/optimizerpass.h"
 #include "../common/optimizer/optimizerdraft.h"
@@ -73,6 +76,10 @@ RendererPreviewSW::RendererPreviewSW()
 	register_optimizer(new OptimizerBlendToTarget());
 	register_optimizer(new OptimizerBlendAssociative());
 	//register_optimizer(new OptimizerSplit());
+	register_optimizer(new OptimizerSurfaceFormat(
+		SurfaceSWRGBA8::token.handle(),
+		SurfaceSWRGBA8::token.handle(),
+		SurfaceSWHalf::token.handle() ));
 }
 
 String RendererPreviewSW::get_name() const
@@ -33,6 +33,7 @@
 
 #include "renderersw.h"
 
+#include "surfaceswhalf.h"
 #include  "task/tasksw.h"
 
 #include "../common/optimizer/optimizerblendassociative.h"
@@ -40,6 +41,7 @@
 #include "../common/optimizer/optimizerblendtotarget.h"
 #include "../common/optimizer/optimizerlist.h"
 #include "../common/optimizer/optimizersplit.h"
+#include "../common/optimizer/optimizersurfaceformat.h"
 #include "../common/optimizer/optimizertransformation.h"
 #include "../common/optimizer/optimizerpass.h"
 
@@ -72,6 +74,9 @@ RendererSW::RendererSW()
 	register_optimizer(new OptimizerBlendToTarget());
 	register_optimizer(new OptimizerBlendAssociative());
 	//register_optimizer(new OptimizerSplit());
+	register_optimizer(new OptimizerSurfaceFormat(
+		SurfaceSWHalf::token.handle(),
+		SurfaceSWHalf::token.handle() ));
 }
 
 RendererSW::~RendererSW() { }
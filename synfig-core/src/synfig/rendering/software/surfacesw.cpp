@@ -29,6 +29,15 @@
 #	include <config.h>
 #endif
 
+#include <atomic>
+#include <cstdlib>
+#include <cstring>
+#include <map>
+#include <mutex>
+#include <vector>
+
+#include <synfig/threadpool.h>
+
 #include "surfacesw.h"
 
 #endif
@@ -38,8 +47,99 @@ using namespace rendering;
 
 /* === M A C R O S ========================================================= */
 
+//! Default limit of memory kept in the pool, in megabytes
+#define SURFACE_POOL_SIZE 256
+
 /* === G L O B A L S ======================================================= */
 
+namespace {
+	std::atomic<size_t> allocated_memory(0);
+	std::atomic<size_t> peak_memory(0);
+
+	//! Free pixel buffers grouped by size, keeps memory of released surfaces
+	//! to reuse it for the surfaces of the next tasks and frames.
+	//! Pages of the buffer are placed to NUMA node of the thread which writes it first,
+	//! so buffers are returned to the threads of the same node only
+	class SurfacePool {
+	private:
+		typedef std::map<size_t, std::vector<char*> > Buckets;
+
+		std::mutex mutex;
+		std::vector<Buckets> buckets;	//!< per NUMA node
+		size_t size;
+		size_t max_size;
+
+	public:
+		SurfacePool():
+			buckets(ThreadPool::get_nodes_count()),
+			size(),
+			max_size((size_t)SURFACE_POOL_SIZE << 20)
+		{
+			if (const char *s = getenv("SYNFIG_SURFACE_POOL_SIZE"))
+				max_size = (size_t)std::max(0, atoi(s)) << 20;
+		}
+
+		~SurfacePool()
+		{
+			for(std::vector<Buckets>::iterator n = buckets.begin(); n != buckets.end(); ++n)
+				for(Buckets::iterator i = n->begin(); i != n->end(); ++i)
+					for(std::vector<char*>::iterator j = i->second.begin(); j != i->second.end(); ++j)
+						delete[] *j;
+		}
+
+		int current_node() const
+		{
+			int node = ThreadPool::get_thread_node();
+			return node < (int)buckets.size() ? node : 0;
+		}
+
+		//! rounds size up to one of eight steps between powers of two,
+		//! so surfaces of close sizes share the same bucket
+		static size_t bucket(size_t size)
+		{
+			size_t step = 64;
+			while(step*16 <= size) step *= 2;
+			return (size + step - 1)/step*step;
+		}
+
+		char* alloc(size_t bucket_size, int &node)
+		{
+			node = current_node();
+			{
+				std::lock_guard<std::mutex> lock(mutex);
+				Buckets::iterator i = buckets[node].find(bucket_size);
+				if (i != buckets[node].end() && !i->second.empty()) {
+					char *buffer = i->second.back();
+					i->second.pop_back();
+					size -= bucket_size;
+					return buffer;
+				}
+			}
+			return new char[bucket_size];
+		}
+
+		void free(char *buffer, size_t bucket_size, int node)
+		{
+			if (!buffer) return;
+			{
+				std::lock_guard<std::mutex> lock(mutex);
+				if (size + bucket_size <= max_size) {
+					buckets[node < (int)buckets.size() ? node : 0][bucket_size].push_back(buffer);
+					size += bucket_size;
+					return;
+				}
+			}
+			delete[] buffer;
+		}
+	};
+
+	SurfacePool& get_pool()
+	{
+		static SurfacePool pool;
+		return pool;
+	}
+}
+
 /* === P R O C E D U R E S ================================================= */
 
 /* === M E T H O D S ======================================================= */
@@ -51,16 +151,25 @@ rendering::Surface::Token SurfaceSW::token(
 
 SurfaceSW::SurfaceSW():
 	own_surface(true),
-	surface(new synfig::Surface())
+	surface(new synfig::Surface()),
+	memory_size(0),
+	buffer(),
+	buffer_size(0),
+	buffer_node(0)
 { }
 
 SurfaceSW::SurfaceSW(synfig::Surface &surface, bool own_surface):
 	own_surface(own_surface),
-	surface(&surface)
+	surface(&surface),
+	memory_size(0),
+	buffer(),
+	buffer_size(0),
+	buffer_node(0)
 {
 	assert(this->surface);
 	set_desc(this->surface->get_w(), this->surface->get_h(), false);
 	assert((int)this->surface->get_pitch() == (int)sizeof(Color)*get_width());
+	update_memory_size();
 }
 
 SurfaceSW::~SurfaceSW()
@@ -68,14 +177,106 @@ SurfaceSW::~SurfaceSW()
 	if (own_surface)
 		{ assert(surface); delete surface; }
 	surface = NULL;
+	free_buffer();
+	update_memory_size();
 	set_desc(0, 0, true);
 }
 
+void
+SurfaceSW::set_wh(int width, int height)
+{
+	assert(surface);
+	if (!own_surface || width <= 0 || height <= 0) {
+		surface->set_wh(width, height);
+		free_buffer();
+		update_memory_size();
+		return;
+	}
+
+	size_t size = SurfacePool::bucket((size_t)width*(size_t)height*sizeof(Color));
+	if ( buffer && size == buffer_size
+	  && surface->get_w() == width && surface->get_h() == height
+	  && (char*)&(*surface)[0][0] == buffer )
+		return;
+
+	char *prev_buffer = buffer;
+	size_t prev_buffer_size = buffer_size;
+	int prev_buffer_node = buffer_node;
+	buffer = get_pool().alloc(size, buffer_node);
+	buffer_size = size;
+	surface->set_wh(width, height, (unsigned char*)buffer, sizeof(Color)*width);
+	get_pool().free(prev_buffer, prev_buffer_size, prev_buffer_node);
+	update_memory_size();
+}
+
+void
+SurfaceSW::detach_buffer()
+{
+	// surface will live longer than this object,
+	// so move pixels into the memory owned by surface itself
+	if (!buffer) return;
+	assert(surface);
+	int width = surface->get_w();
+	int height = surface->get_h();
+	if (width > 0 && height > 0 && (char*)&(*surface)[0][0] == buffer) {
+		surface->set_wh(width, height);
+		memcpy(&(*surface)[0][0], buffer, (size_t)width*(size_t)height*sizeof(Color));
+	}
+	free_buffer();
+}
+
+void
+SurfaceSW::free_buffer()
+{
+	get_pool().free(buffer, buffer_size, buffer_node);
+	buffer = NULL;
+	buffer_size = 0;
+	buffer_node = 0;
+}
+
+void
+SurfaceSW::update_memory_size()
+{
+	size_t size = surface && own_surface
+	            ? (size_t)surface->get_w()*(size_t)surface->get_h()*sizeof(Color)
+	            : 0;
+	if (size == memory_size) return;
+
+	if (!memory_size)
+		memory_meter = MemoryMeter::get_current();
+
+	if (size > memory_size) {
+		size_t total = (allocated_memory += size - memory_size);
+		size_t peak = peak_memory;
+		while(peak < total && !peak_memory.compare_exchange_weak(peak, total));
+		if (memory_meter) memory_meter->add(size - memory_size);
+	} else {
+		allocated_memory -= memory_size - size;
+		if (memory_meter) memory_meter->remove(memory_size - size);
+	}
+	memory_size = size;
+
+	if (!memory_size)
+		memory_meter.reset();
+}
+
+size_t
+SurfaceSW::get_allocated_memory()
+	{ return allocated_memory; }
+
+size_t
+SurfaceSW::get_peak_memory()
+	{ return peak_memory; }
+
+void
+SurfaceSW::reset_peak_memory()
+	{ peak_memory = (size_t)allocated_memory; }
+
 bool
 SurfaceSW::create_vfunc(int width, int height)
 {
-	assert(surface);
-	surface->set_wh(width, height);
+	reset_coverage();
+	set_wh(width, height);
 	surface->clear();
 	return true;
 }
@@ -83,11 +284,11 @@ SurfaceSW::create_vfunc(int width, int height)
 bool
 SurfaceSW::assign_vfunc(const rendering::Surface &surface)
 {
-	assert(this->surface);
-	this->surface->set_wh(surface.get_width(), surface.get_height());
+	reset_coverage();
+	set_wh(surface.get_width(), surface.get_height());
 	if (surface.get_pixels(&(*this->surface)[0][0]))
 		return true;
-	this->surface->set_wh(0, 0);
+	set_wh(0, 0);
 	set_desc(0, 0, true);
 	return false;
 }
@@ -95,6 +296,7 @@ SurfaceSW::assign_vfunc(const rendering::Surface &surface)
 bool
 SurfaceSW::clear_vfunc()
 {
+	reset_coverage();
 	assert(surface);
 	surface->clear();
 	return true;
@@ -103,8 +305,8 @@ SurfaceSW::clear_vfunc()
 bool
 SurfaceSW::reset_vfunc()
 {
-	assert(surface);
-	surface->set_wh(0, 0);
+	reset_coverage();
+	set_wh(0, 0);
 	return true;
 }
 
@@ -116,11 +318,38 @@ SurfaceSW::get_pixels_pointer_vfunc() const
 	return &(*this->surface)[0][0];
 }
 
+void
+SurfaceSW::touch_vfunc(const RectInt &rect)
+{
+	std::lock_guard<std::mutex> lock(coverage_mutex);
+	// surface is still marked as blank while it is touched for the first time
+	if (!coverage && !is_blank())
+		return;
+
+	// tiles out of the written part keep their summary
+	Coverage &c = edit_coverage();
+	bool mixed_only = true;
+	for(int ty = 0; ty < c.height; ++ty) {
+		for(int tx = 0; tx < c.width; ++tx) {
+			Tile &tile = c.tiles[ty*c.width + tx];
+			RectInt r(tx*COVERAGE_TILE_SIZE, ty*COVERAGE_TILE_SIZE, (tx + 1)*COVERAGE_TILE_SIZE, (ty + 1)*COVERAGE_TILE_SIZE);
+			if (rect.minx < r.maxx && r.minx < rect.maxx && rect.miny < r.maxy && r.miny < rect.maxy)
+				tile = Tile();
+			if (tile.transparent || tile.constant)
+				mixed_only = false;
+		}
+	}
+	c.mixed_only = mixed_only;
+}
+
 void
 SurfaceSW::set_surface(synfig::Surface &surface, bool own_surface)
 {
+	reset_coverage();
 	if (&surface == this->surface) {
+		if (!own_surface) detach_buffer();
 		this->own_surface = own_surface;
+		update_memory_size();
 		return;
 	}
 
@@ -128,9 +357,12 @@ SurfaceSW::set_surface(synfig::Surface &surface, bool own_surface)
 		assert(this->surface);
 		delete(this->surface);
 	}
+	free_buffer();
 
+	this->own_surface = own_surface;
 	this->surface = &surface;
 	assert(this->surface);
+	update_memory_size();
 	set_desc(surface.get_w(), surface.get_h(), false);
 	assert((int)this->surface->get_pitch() == (int)sizeof(Color)*get_width());
 }
@@ -142,9 +374,78 @@ SurfaceSW::reset_surface()
 		assert(surface);
 		delete(surface);
 	}
+	free_buffer();
 	own_surface = true;
 	surface = new synfig::Surface();
+	update_memory_size();
 	set_desc(0, 0, true);
+	reset_coverage();
+}
+
+void
+SurfaceSW::reset_coverage()
+{
+	std::lock_guard<std::mutex> lock(coverage_mutex);
+	coverage.reset();
+}
+
+SurfaceSW::Coverage&
+SurfaceSW::edit_coverage() const
+{
+	if (!coverage) {
+		coverage = new Coverage();
+		coverage->width = (get_width() + COVERAGE_TILE_SIZE - 1)/COVERAGE_TILE_SIZE;
+		coverage->height = (get_height() + COVERAGE_TILE_SIZE - 1)/COVERAGE_TILE_SIZE;
+		Tile tile;
+		if (is_blank()) {
+			// created or cleared surface is filled by transparent color
+			tile.transparent = tile.constant = true;
+			tile.color = Color(0, 0, 0, 0);
+			coverage->mixed_only = false;
+		}
+		coverage->tiles.assign(coverage->width*coverage->height, tile);
+	} else
+	if (coverage->count() > 1) {
+		// readers keep the previous summary
+		coverage = new Coverage(*coverage);
+	}
+	return *coverage;
+}
+
+SurfaceSW::Coverage::Handle
+SurfaceSW::get_coverage() const
+{
+	if (!own_surface || !surface || !is_exists())
+		return Coverage::Handle();
+
+	std::lock_guard<std::mutex> lock(coverage_mutex);
+	if (!coverage && is_blank())
+		edit_coverage();
+	return coverage;
+}
+
+void
+SurfaceSW::set_constant_coverage(const RectInt &rect, const Color &color)
+{
+	if (!own_surface || !surface || !is_exists())
+		return;
+
+	std::lock_guard<std::mutex> lock(coverage_mutex);
+	Coverage &c = edit_coverage();
+	const int w = get_width();
+	const int h = get_height();
+	for(int ty = std::max(0, rect.miny/COVERAGE_TILE_SIZE); ty < c.height && ty*COVERAGE_TILE_SIZE < rect.maxy; ++ty) {
+		for(int tx = std::max(0, rect.minx/COVERAGE_TILE_SIZE); tx < c.width && tx*COVERAGE_TILE_SIZE < rect.maxx; ++tx) {
+			RectInt r(tx*COVERAGE_TILE_SIZE, ty*COVERAGE_TILE_SIZE, std::min(w, (tx + 1)*COVERAGE_TILE_SIZE), std::min(h, (ty + 1)*COVERAGE_TILE_SIZE));
+			if (!rect_contains(rect, r))
+				continue;
+			Tile &tile = c.tiles[ty*c.width + tx];
+			tile.transparent = color.get_a() == 0;
+			tile.constant = true;
+			tile.color = color;
+			c.mixed_only = false;
+		}
+	}
 }
 
 /* === E N T R Y P O I N T ================================================= */
@@ -27,6 +27,10 @@
 
 /* === H E A D E R S ======================================================= */
 
+#include <algorithm>
+#include <mutex>
+#include <vector>
+
 #include <synfig/surface.h>
 #include <synfig/synfig_export.h>
 
@@ -51,15 +55,56 @@ public:
 	virtual Token::Handle get_token() const
 		{ return token.handle(); }
 
+	enum { COVERAGE_TILE_SIZE = 64 };
+
+	//! Summary of pixels of one tile
+	struct Tile {
+		bool transparent;	//!< alpha of all pixels is zero
+		bool constant;		//!< all pixels are equal to color
+		Color color;
+		Tile(): transparent(), constant() { }
+	};
+
+	//! Summary of pixels of whole surface by tiles of COVERAGE_TILE_SIZE x COVERAGE_TILE_SIZE
+	class Coverage: public etl::shared_object {
+	public:
+		typedef etl::handle<Coverage> Handle;
+		int width;			//!< count of tiles in row
+		int height;			//!< count of rows
+		bool mixed_only;	//!< there are no transparent or constant tiles
+		std::vector<Tile> tiles;
+		Coverage(): width(), height(), mixed_only(true) { }
+		const Tile& get(int x, int y) const
+			{ return tiles[y*width + x]; }
+	};
+
 private:
 	bool own_surface;
 	synfig::Surface *surface;
+	size_t memory_size;
+	char *buffer;		//!< pixels of the own surface taken from the pool
+	size_t buffer_size;
+	int buffer_node;	//!< NUMA node of the thread which took the buffer first time
+
+	MemoryMeter::Handle memory_meter; //!< meter which was current when memory was allocated
+
+	mutable std::mutex coverage_mutex;
+	mutable Coverage::Handle coverage;
+
+	void reset_coverage();
+	//! Returns summary which is not shared with readers, call under coverage_mutex
+	Coverage& edit_coverage() const;
+	void update_memory_size();
+	void set_wh(int width, int height);
+	void detach_buffer();
+	void free_buffer();
 
 protected:
 	virtual bool create_vfunc(int width, int height);
 	virtual bool assign_vfunc(const Surface &surface);
 	virtual bool clear_vfunc();
 	virtual bool reset_vfunc();
+	virtual void touch_vfunc(const RectInt &rect);
 	virtual const Color* get_pixels_pointer_vfunc() const;
 
 public:
@@ -77,6 +122,53 @@ public:
 		{ return own_surface; }
 
 	void reset_surface();
+
+	//! Returns summary of pixels, pixels are never scanned for it: tiles are known
+	//! after create or clear, stay known until they are touched by a writer
+	//! and become constant by set_constant_coverage().
+	//! Returns null when nothing is known, or for surfaces which are not owned by this object.
+	Coverage::Handle get_coverage() const;
+	//! Marks tiles which lie entirely in \a rect as filled by \a color,
+	//! writers call it for the parts they filled by solid color
+	void set_constant_coverage(const RectInt &rect, const Color &color);
+
+	//! Calls \a func(const RectInt &part, const Tile *tile) for all parts of \a rect,
+	//! where \a tile is transparent or constant tile which contains the part,
+	//! or null for the part made of mixed tiles
+	template<typename T>
+	void for_each_tile(const RectInt &rect, const T &func) const
+	{
+		Coverage::Handle c = get_coverage();
+		if (!c || c->mixed_only) {
+			func(rect, (const Tile*)NULL);
+			return;
+		}
+		for(int ty = rect.miny/COVERAGE_TILE_SIZE; ty*COVERAGE_TILE_SIZE < rect.maxy; ++ty) {
+			int miny = std::max(rect.miny, ty*COVERAGE_TILE_SIZE);
+			int maxy = std::min(rect.maxy, (ty + 1)*COVERAGE_TILE_SIZE);
+			int run = rect.minx; // begin of the run of mixed tiles
+			for(int tx = rect.minx/COVERAGE_TILE_SIZE; tx*COVERAGE_TILE_SIZE < rect.maxx; ++tx) {
+				const Tile &tile = c->get(tx, ty);
+				if (!tile.transparent && !tile.constant)
+					continue;
+				int minx = std::max(rect.minx, tx*COVERAGE_TILE_SIZE);
+				if (run < minx)
+					func(RectInt(run, miny, minx, maxy), (const Tile*)NULL);
+				run = std::min(rect.maxx, (tx + 1)*COVERAGE_TILE_SIZE);
+				func(RectInt(minx, miny, run, maxy), &tile);
+			}
+			if (run < rect.maxx)
+				func(RectInt(run, miny, rect.maxx, maxy), (const Tile*)NULL);
+		}
+	}
+
+	//! Bytes of pixel memory currently owned by all SurfaceSW instances of the process,
+	//! memory of one render is counted by MemoryMeter
+	static size_t get_allocated_memory();
+	//! Largest value of get_allocated_memory() since last reset_peak_memory()
+	static size_t get_peak_memory();
+	//! Restarts peak tracking from the current allocation
+	static void reset_peak_memory();
 };
 
 } /* end namespace rendering */
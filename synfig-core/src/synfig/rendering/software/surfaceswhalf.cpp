@@ -0,0 +1,156 @@
+/* === S Y N F I G ========================================================= */
+/*!	\file synfig/rendering/software/surfaceswhalf.cpp
+**	\brief SurfaceSWHalf
+**
+**	$Id$
+**
+**	\legal
+**	......... ... 2026 Synfig contributors
+**
+**	This package is free software; you can redistribute it and/or
+**	modify it under the terms of the GNU General Public License as
+**	published by the Free Software Foundation; either version 2 of
+**	the License, or (at your option) any later version.
+**
+**	This package is distributed in the hope that it will be useful,
+**	but WITHOUT ANY WARRANTY; without even the implied warranty of
+**	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+**	General Public License for more details.
+**	\endlegal
+*/
+/* ========================================================================= */
+
+/* === H E A D E R S ======================================================= */
+
+#ifdef USING_PCH
+#	include "pch.h"
+#else
+#ifdef HAVE_CONFIG_H
+#	include <config.h>
+#endif
+
+#include "surfaceswhalf.h"
+
+#endif
+
+using namespace synfig;
+using namespace rendering;
+
+/* === M A C R O S ========================================================= */
+
+/* === G L O B A L S ======================================================= */
+
+/* === P R O C E D U R E S ================================================= */
+
+/* === M E T H O D S ======================================================= */
+
+
+rendering::Surface::Token SurfaceSWHalf::token(
+	Desc<SurfaceSWHalf>("SurfaceSWHalf") );
+
+
+bool
+SurfaceSWHalf::create_vfunc(int width, int height)
+{
+	data.clear();
+	data.resize(4*width*height, 0);
+	memory_usage.set(data.size()*sizeof(Channel));
+	return true;
+}
+
+bool
+SurfaceSWHalf::assign_vfunc(const rendering::Surface &surface)
+{
+	std::vector<Color> buffer;
+	const Color *pixels = surface.get_pixels_pointer();
+	if (!pixels) {
+		buffer.resize(surface.get_pixels_count());
+		if (!surface.get_pixels(&buffer.front()))
+			return false;
+		pixels = &buffer.front();
+	}
+
+	int count = surface.get_pixels_count();
+	data.resize(4*count);
+	Channel *dest = &data.front();
+	for(const Color *end = pixels + count; pixels < end; ++pixels, dest += 4)
+		pack(dest, *pixels);
+	memory_usage.set(data.size()*sizeof(Channel));
+	return true;
+}
+
+bool
+SurfaceSWHalf::clear_vfunc()
+{
+	if (!data.empty())
+		memset(&data.front(), 0, data.size()*sizeof(Channel));
+	return true;
+}
+
+bool
+SurfaceSWHalf::reset_vfunc()
+{
+	std::vector<Channel>().swap(data);
+	memory_usage.set(0);
+	return true;
+}
+
+bool
+SurfaceSWHalf::get_pixels_vfunc(Color *buffer) const
+{
+	for(int y = 0; y < get_height(); ++y, buffer += get_width())
+		read_row(buffer, 0, y, get_width());
+	return true;
+}
+
+SurfaceSWHalf::Channel
+SurfaceSWHalf::float_to_half(float x)
+{
+	unsigned int bits;
+	memcpy(&bits, &x, sizeof(bits));
+
+	Channel sign = (bits >> 16) & 0x8000;
+	bits &= 0x7fffffff;
+
+	if (bits >= 0x7f800000) // infinity or NaN
+		return sign | 0x7c00 | (bits > 0x7f800000 ? 0x200 : 0);
+	if (bits >= 0x477ff000) // too large, rounds to infinity
+		return sign | 0x7c00;
+
+	if (bits < 0x38800000) {
+		// subnormal
+		if (bits < 0x33000000) return sign;
+		unsigned int mantissa = (bits & 0x7fffff) | 0x800000;
+		int shift = 126 - (int)(bits >> 23);
+		unsigned int h = mantissa >> shift;
+		unsigned int rest = mantissa & ((1u << shift) - 1);
+		unsigned int middle = 1u << (shift - 1);
+		if (rest > middle || (rest == middle && (h & 1))) ++h;
+		return sign | Channel(h);
+	}
+
+	unsigned int h = (bits - 0x38000000) >> 13;
+	unsigned int rest = bits & 0x1fff;
+	if (rest > 0x1000 || (rest == 0x1000 && (h & 1))) ++h;
+	return sign | Channel(h);
+}
+
+void
+SurfaceSWHalf::read_row(Color *dest, int x, int y, int count) const
+{
+	assert(x >= 0 && count >= 0 && x + count <= get_width());
+	assert(y >= 0 && y < get_height());
+	for(const Channel *src = get_row(y) + 4*x, *end = src + 4*count; src < end; src += 4, ++dest)
+		*dest = unpack(src);
+}
+
+void
+SurfaceSWHalf::write_row(const Color *src, int x, int y, int count)
+{
+	assert(x >= 0 && count >= 0 && x + count <= get_width());
+	assert(y >= 0 && y < get_height());
+	for(Channel *dest = &data[4*(y*get_width() + x)], *end = dest + 4*count; dest < end; dest += 4, ++src)
+		pack(dest, *src);
+}
+
+/* === E N T R Y P O I N T ================================================= */
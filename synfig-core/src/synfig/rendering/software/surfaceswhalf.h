@@ -0,0 +1,119 @@
+/* === S Y N F I G ========================================================= */
+/*!	\file synfig/rendering/software/surfaceswhalf.h
+**	\brief SurfaceSWHalf Header
+**
+**	$Id$
+**
+**	\legal
+**	......... ... 2026 Synfig contributors
+**
+**	This package is free software; you can redistribute it and/or
+**	modify it under the terms of the GNU General Public License as
+**	published by the Free Software Foundation; either version 2 of
+**	the License, or (at your option) any later version.
+**
+**	This package is distributed in the hope that it will be useful,
+**	but WITHOUT ANY WARRANTY; without even the implied warranty of
+**	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+**	General Public License for more details.
+**	\endlegal
+*/
+/* ========================================================================= */
+
+/* === S T A R T =========================================================== */
+
+#ifndef __SYNFIG_RENDERING_SURFACESWHALF_H
+#define __SYNFIG_RENDERING_SURFACESWHALF_H
+
+/* === H E A D E R S ======================================================= */
+
+#include <cstring>
+#include <vector>
+
+#include "../surface.h"
+
+/* === M A C R O S ========================================================= */
+
+/* === T Y P E D E F S ===================================================== */
+
+/* === C L A S S E S & S T R U C T S ======================================= */
+
+namespace synfig
+{
+namespace rendering
+{
+
+//! RGBA storage with 16-bit floating point channels (IEEE 754 binary16),
+//! two times smaller than SurfaceSW. Keeps about three decimal digits.
+class SurfaceSWHalf: public Surface
+{
+public:
+	typedef etl::handle<SurfaceSWHalf> Handle;
+	typedef unsigned short Channel;
+	static Token token;
+	virtual Token::Handle get_token() const
+		{ return token.handle(); }
+
+protected:
+	virtual bool create_vfunc(int width, int height);
+	virtual bool assign_vfunc(const Surface &surface);
+	virtual bool clear_vfunc();
+	virtual bool reset_vfunc();
+	virtual bool get_pixels_vfunc(Color *buffer) const;
+
+private:
+	std::vector<Channel> data;
+	MemoryMeter::Usage memory_usage;
+
+public:
+	SurfaceSWHalf()
+		{ }
+	explicit SurfaceSWHalf(const Surface &other)
+		{ assign(other); }
+
+	const Channel* get_row(int y) const
+		{ return &data[4*y*get_width()]; }
+
+	//! Unpacks \a count pixels of row \a y starting from column \a x
+	void read_row(Color *dest, int x, int y, int count) const;
+	//! Packs \a count pixels into row \a y starting from column \a x
+	void write_row(const Color *src, int x, int y, int count);
+
+	static void pack(Channel *dest, const Color &color)
+	{
+		dest[0] = float_to_half(color.get_r());
+		dest[1] = float_to_half(color.get_g());
+		dest[2] = float_to_half(color.get_b());
+		dest[3] = float_to_half(color.get_a());
+	}
+
+	static Color unpack(const Channel *src)
+		{ return Color(half_to_float(src[0]), half_to_float(src[1]), half_to_float(src[2]), half_to_float(src[3])); }
+
+	//! Converts with rounding to nearest even, overflow becomes infinity
+	static Channel float_to_half(float x);
+	static float half_to_float(Channel x)
+	{
+		unsigned int sign = (unsigned int)(x & 0x8000) << 16;
+		unsigned int exponent = (x >> 10) & 0x1f;
+		unsigned int mantissa = x & 0x3ff;
+		if (!exponent) {
+			// zero or subnormal
+			float f = (float)mantissa*(1.f/16777216.f);
+			return sign ? -f : f;
+		}
+		unsigned int bits = exponent == 0x1f
+		                  ? sign | 0x7f800000 | (mantissa << 13)
+		                  : sign | ((exponent + 112) << 23) | (mantissa << 13);
+		float f;
+		memcpy(&f, &bits, sizeof(f));
+		return f;
+	}
+};
+
+} /* end namespace rendering */
+} /* end namespace synfig */
+
+/* -- E N D ----------------------------------------------------------------- */
+
+#endif
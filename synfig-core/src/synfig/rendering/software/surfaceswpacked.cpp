@@ -55,7 +55,7 @@ SurfaceSWPacked::assign_vfunc(const rendering::Surface &surface)
 	std::vector<Color> data;
 	const Color *pixels = surface.get_pixels_pointer();
 	if (!pixels) {
-		data.resize(get_pixels_count());
+		data.resize(surface.get_pixels_count());
 		if (!surface.get_pixels(&data.front()))
 			return false;
 		pixels = &data.front();
@@ -0,0 +1,126 @@
+/* === S Y N F I G ========================================================= */
+/*!	\file synfig/rendering/software/surfaceswrgba8.cpp
+**	\brief SurfaceSWRGBA8
+**
+**	$Id$
+**
+**	\legal
+**	......... ... 2026 Synfig contributors
+**
+**	This package is free software; you can redistribute it and/or
+**	modify it under the terms of the GNU General Public License as
+**	published by the Free Software Foundation; either version 2 of
+**	the License, or (at your option) any later version.
+**
+**	This package is distributed in the hope that it will be useful,
+**	but WITHOUT ANY WARRANTY; without even the implied warranty of
+**	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+**	General Public License for more details.
+**	\endlegal
+*/
+/* ========================================================================= */
+
+/* === H E A D E R S ======================================================= */
+
+#ifdef USING_PCH
+#	include "pch.h"
+#else
+#ifdef HAVE_CONFIG_H
+#	include <config.h>
+#endif
+
+#include <cstring>
+
+#include "surfaceswrgba8.h"
+
+#endif
+
+using namespace synfig;
+using namespace rendering;
+
+/* === M A C R O S ========================================================= */
+
+/* === G L O B A L S ======================================================= */
+
+/* === P R O C E D U R E S ================================================= */
+
+/* === M E T H O D S ======================================================= */
+
+
+rendering::Surface::Token SurfaceSWRGBA8::token(
+	Desc<SurfaceSWRGBA8>("SurfaceSWRGBA8") );
+
+
+bool
+SurfaceSWRGBA8::create_vfunc(int width, int height)
+{
+	data.clear();
+	data.resize(4*width*height, 0);
+	memory_usage.set(data.size()*sizeof(Channel));
+	return true;
+}
+
+bool
+SurfaceSWRGBA8::assign_vfunc(const rendering::Surface &surface)
+{
+	std::vector<Color> buffer;
+	const Color *pixels = surface.get_pixels_pointer();
+	if (!pixels) {
+		buffer.resize(surface.get_pixels_count());
+		if (!surface.get_pixels(&buffer.front()))
+			return false;
+		pixels = &buffer.front();
+	}
+
+	int count = surface.get_pixels_count();
+	data.resize(4*count);
+	Channel *dest = &data.front();
+	for(const Color *end = pixels + count; pixels < end; ++pixels, dest += 4)
+		pack(dest, *pixels);
+	memory_usage.set(data.size()*sizeof(Channel));
+	return true;
+}
+
+bool
+SurfaceSWRGBA8::clear_vfunc()
+{
+	if (!data.empty())
+		memset(&data.front(), 0, data.size());
+	return true;
+}
+
+bool
+SurfaceSWRGBA8::reset_vfunc()
+{
+	std::vector<Channel>().swap(data);
+	memory_usage.set(0);
+	return true;
+}
+
+bool
+SurfaceSWRGBA8::get_pixels_vfunc(Color *buffer) const
+{
+	for(int y = 0; y < get_height(); ++y, buffer += get_width())
+		read_row(buffer, 0, y, get_width());
+	return true;
+}
+
+void
+SurfaceSWRGBA8::read_row(Color *dest, int x, int y, int count) const
+{
+	assert(x >= 0 && count >= 0 && x + count <= get_width());
+	assert(y >= 0 && y < get_height());
+	for(const Channel *src = get_row(y) + 4*x, *end = src + 4*count; src < end; src += 4, ++dest)
+		*dest = unpack(src);
+}
+
+void
+SurfaceSWRGBA8::write_row(const Color *src, int x, int y, int count)
+{
+	assert(x >= 0 && count >= 0 && x + count <= get_width());
+	assert(y >= 0 && y < get_height());
+	for(Channel *dest = &data[4*(y*get_width() + x)], *end = dest + 4*count; dest < end; dest += 4, ++src)
+		pack(dest, *src);
+}
+
+/* === E N T R Y P O I N T ================================================= */
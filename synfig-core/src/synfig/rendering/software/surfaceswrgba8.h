@@ -0,0 +1,109 @@
+/* === S Y N F I G ========================================================= */
+/*!	\file synfig/rendering/software/surfaceswrgba8.h
+**	\brief SurfaceSWRGBA8 Header
+**
+**	$Id$
+**
+**	\legal
+**	......... ... 2026 Synfig contributors
+**
+**	This package is free software; you can redistribute it and/or
+**	modify it under the terms of the GNU General Public License as
+**	published by the Free Software Foundation; either version 2 of
+**	the License, or (at your option) any later version.
+**
+**	This package is distributed in the hope that it will be useful,
+**	but WITHOUT ANY WARRANTY; without even the implied warranty of
+**	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+**	General Public License for more details.
+**	\endlegal
+*/
+/* ========================================================================= */
+
+/* === S T A R T =========================================================== */
+
+#ifndef __SYNFIG_RENDERING_SURFACESWRGBA8_H
+#define __SYNFIG_RENDERING_SURFACESWRGBA8_H
+
+/* === H E A D E R S ======================================================= */
+
+#include <vector>
+
+#include "../surface.h"
+
+/* === M A C R O S ========================================================= */
+
+/* === T Y P E D E F S ===================================================== */
+
+/* === C L A S S E S & S T R U C T S ======================================= */
+
+namespace synfig
+{
+namespace rendering
+{
+
+//! Premultiplied 8-bit RGBA storage, four times smaller than SurfaceSW.
+//! Channels are clamped to [0, 1], so use it only when precision allows.
+class SurfaceSWRGBA8: public Surface
+{
+public:
+	typedef etl::handle<SurfaceSWRGBA8> Handle;
+	typedef unsigned char Channel;
+	static Token token;
+	virtual Token::Handle get_token() const
+		{ return token.handle(); }
+
+protected:
+	virtual bool create_vfunc(int width, int height);
+	virtual bool assign_vfunc(const Surface &surface);
+	virtual bool clear_vfunc();
+	virtual bool reset_vfunc();
+	virtual bool get_pixels_vfunc(Color *buffer) const;
+
+private:
+	std::vector<Channel> data;
+	MemoryMeter::Usage memory_usage;
+
+public:
+	SurfaceSWRGBA8()
+		{ }
+	explicit SurfaceSWRGBA8(const Surface &other)
+		{ assign(other); }
+
+	const Channel* get_row(int y) const
+		{ return &data[4*y*get_width()]; }
+
+	//! Unpacks \a count pixels of row \a y starting from column \a x
+	void read_row(Color *dest, int x, int y, int count) const;
+	//! Packs \a count pixels into row \a y starting from column \a x
+	void write_row(const Color *src, int x, int y, int count);
+
+	static void pack(Channel *dest, const Color &color)
+	{
+		ColorReal a = clamp(color.get_a());
+		dest[0] = to_channel(clamp(color.get_r())*a);
+		dest[1] = to_channel(clamp(color.get_g())*a);
+		dest[2] = to_channel(clamp(color.get_b())*a);
+		dest[3] = to_channel(a);
+	}
+
+	static Color unpack(const Channel *src)
+	{
+		if (!src[3]) return Color(0, 0, 0, 0);
+		ColorReal k = ColorReal(1)/ColorReal(src[3]);
+		return Color(src[0]*k, src[1]*k, src[2]*k, src[3]*(ColorReal(1)/ColorReal(255)));
+	}
+
+private:
+	static ColorReal clamp(ColorReal x)
+		{ return x > ColorReal(0) ? (x < ColorReal(1) ? x : ColorReal(1)) : ColorReal(0); }
+	static Channel to_channel(ColorReal x)
+		{ return Channel(x*ColorReal(255) + ColorReal(0.5)); }
+};
+
+} /* end namespace rendering */
+} /* end namespace synfig */
+
+/* -- E N D ----------------------------------------------------------------- */
+
+#endif
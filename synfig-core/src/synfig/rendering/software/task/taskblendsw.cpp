@@ -32,6 +32,8 @@
 #include <synfig/debug/debugsurface.h>
 
 #include "../../common/task/taskblend.h"
+#include "../surfaceswhalf.h"
+#include "../surfaceswrgba8.h"
 #include "tasksw.h"
 
 #endif
@@ -49,6 +51,124 @@ using namespace rendering;
 
 namespace {
 
+//! Blends parts of source surface which are not fully transparent
+class BlendTile {
+private:
+	synfig::Surface &dest;
+	synfig::Surface &src;
+	VectorInt offset;
+	ColorReal amount;
+	Color::BlendMethod blend_method;
+
+public:
+	BlendTile(
+		synfig::Surface &dest,
+		synfig::Surface &src,
+		const VectorInt &offset,
+		ColorReal amount,
+		Color::BlendMethod blend_method
+	):
+		dest(dest), src(src), offset(offset), amount(amount), blend_method(blend_method) { }
+
+	void operator()(const RectInt &part, const SurfaceSW::Tile *tile) const {
+		if (tile && tile->transparent)
+			return;
+		synfig::Surface::alpha_pen ap(dest.get_pen(part.minx - offset[0], part.miny - offset[1]));
+		ap.set_blend_method(blend_method);
+		ap.set_alpha(amount);
+		src.blit_to(ap, part.minx, part.miny, part.maxx - part.minx, part.maxy - part.miny);
+	}
+};
+
+//! Reads compact surface row by row without conversion of whole surface
+template<typename T>
+void
+blend_compact(
+	synfig::Surface &dest,
+	const RectInt &rect,
+	const T &src,
+	const VectorInt &offset,
+	bool copy,
+	ColorReal amount,
+	Color::BlendMethod blend_method,
+	bool skip_transparent )
+{
+	int count = rect.maxx - rect.minx;
+	std::vector<Color> row(count);
+	for(int y = rect.miny; y < rect.maxy; ++y) {
+		Color *d = &dest[y][rect.minx];
+		if (copy) {
+			src.read_row(d, rect.minx + offset[0], y + offset[1], count);
+			continue;
+		}
+		src.read_row(&row.front(), rect.minx + offset[0], y + offset[1], count);
+		for(int x = 0; x < count; ++x)
+			if (!skip_transparent || row[x].get_a())
+				d[x] = Color::blend(row[x], d[x], amount, blend_method);
+	}
+}
+
+//! Blends surface of sub-task, returns false when surface can't be read.
+//! Result kept in compact format (see OptimizerSurfaceFormat) is read directly.
+//! When \a skip_transparent is set, transparent tiles of source are not processed
+bool
+blend_surface(
+	const Task::Handle &sub_task,
+	synfig::Surface &dest,
+	const RectInt &rect,
+	const VectorInt &offset,
+	bool copy,
+	ColorReal amount = 1.0,
+	Color::BlendMethod blend_method = Color::BLEND_STRAIGHT,
+	bool skip_transparent = false )
+{
+	Task::LockReadBase lock(sub_task);
+	if (!lock.convert<SurfaceSW>(false)) {
+		if (lock.convert<SurfaceSWRGBA8>(false)) {
+			blend_compact(dest, rect, *lock.cast<SurfaceSWRGBA8>(), offset, copy, amount, blend_method, skip_transparent);
+			return true;
+		}
+		if (lock.convert<SurfaceSWHalf>(false)) {
+			blend_compact(dest, rect, *lock.cast<SurfaceSWHalf>(), offset, copy, amount, blend_method, skip_transparent);
+			return true;
+		}
+		if (!lock.convert<SurfaceSW>())
+			return false;
+	}
+
+	const SurfaceSW &surface_sw = *lock.cast<SurfaceSW>();
+	synfig::Surface &src = lock.cast<SurfaceSW>()->get_surface(); // TODO: make blit_to constant
+
+	assert( 0 <= rect.minx && rect.minx < rect.maxx && rect.maxx <= dest.get_w()
+		 && 0 <= rect.miny && rect.miny < rect.maxy && rect.miny <= dest.get_h() );
+	assert( 0 <= rect.minx + offset[0] && rect.maxx + offset[0] <= src.get_w()
+		 && 0 <= rect.miny + offset[1] && rect.maxy + offset[1] <= src.get_h() );
+
+	if (copy) {
+		synfig::Surface::pen p = dest.get_pen(rect.minx, rect.miny);
+		src.blit_to(
+			p,
+			rect.minx + offset[0],
+			rect.miny + offset[1],
+			rect.maxx - rect.minx,
+			rect.maxy - rect.miny );
+	} else
+	if (skip_transparent) {
+		surface_sw.for_each_tile(rect + offset, BlendTile(dest, src, offset, amount, blend_method));
+	} else {
+		synfig::Surface::alpha_pen ap(dest.get_pen(rect.minx, rect.miny));
+		ap.set_blend_method(blend_method);
+		ap.set_alpha(amount);
+		src.blit_to(
+			ap,
+			rect.minx + offset[0],
+			rect.miny + offset[1],
+			rect.maxx - rect.minx,
+			rect.maxy - rect.miny );
+	}
+	return true;
+}
+
 class TaskBlendSW: public TaskBlend,
                    public TaskSW,
                    public TaskInterfaceTargetAsSource
@@ -87,24 +207,8 @@ public:
 			{
 				rect_set_intersect(ra, ra, r);
 				if (ra.is_valid() && sub_task_a()->target_surface != target_surface)
-				{
-					LockRead la(sub_task_a());
-					if (!la) return false;
-					synfig::Surface &a = la.cast_handle()->get_surface(); // TODO: make blit_to constant
-
-					assert( 0 <= ra.minx && ra.minx < ra.maxx && ra.maxx <= c.get_w()
-						 && 0 <= ra.miny && ra.miny < ra.maxy && ra.miny <= c.get_h() );
-					assert( 0 <= ra.minx + oa[0] && ra.maxx + oa[0] <= a.get_w()
-						 && 0 <= ra.miny + oa[1] && ra.maxy + oa[1] <= a.get_h() );
-
-					synfig::Surface::pen p = c.get_pen(ra.minx, ra.miny);
-					a.blit_to(
-						p,
-						ra.minx + oa[0],
-						ra.miny + oa[1],
-						ra.maxx - ra.minx,
-						ra.maxy - ra.miny );
-				}
+					if (!blend_surface(sub_task_a(), c, ra, oa, true))
+						return false;
 			}
 		}
 
@@ -119,24 +223,11 @@ public:
 				rect_set_intersect(rb, rb, r);
 				if (rb.is_valid())
 				{
-					LockRead lb(sub_task_b());
-					if (!lb) return false;
-					synfig::Surface &b = lb.cast_handle()->get_surface(); // TODO: make blit_to constant
-
-					assert( 0 <= rb.minx && rb.minx < rb.maxx && rb.maxx <= c.get_w()
-						 && 0 <= rb.miny && rb.miny < rb.maxy && rb.miny <= c.get_h() );
-					assert( 0 <= rb.minx + ob[0] && rb.maxx + ob[0] <= b.get_w()
-						 && 0 <= rb.miny + ob[1] && rb.maxy + ob[1] <= b.get_h() );
-
-					synfig::Surface::alpha_pen ap(c.get_pen(rb.minx, rb.miny));
-					ap.set_blend_method(blend_method);
-					ap.set_alpha(amount);
-					b.blit_to(
-						ap,
-						rb.minx + ob[0],
-						rb.miny + ob[1],
-						rb.maxx - rb.minx,
-						rb.maxy - rb.miny );
+					// transparent pixels of b can't affect the result when method is not straight
+					bool skip_transparent = !Color::is_straight(blend_method)
+					                     && sub_task_b()->target_surface != target_surface;
+					if (!blend_surface(sub_task_b(), c, rb, ob, false, amount, blend_method, skip_transparent))
+						return false;
 
 					if (ra.is_valid())
 					{
@@ -64,18 +64,30 @@ public:
 		if (!is_valid() || !layer)
 			return false;
 
+		// render only target_rect (with margins requested by layer),
+		// so task may be split into bands by OptimizerSplit
+		Real neighbourhood = layer->get_rendering_neighbourhood();
 		Vector upp = get_units_per_pixel();
+		RectInt rect = target_rect;
+		if (neighbourhood > 0.0) {
+			int dx = (int)ceil(neighbourhood/std::fabs(upp[0]));
+			int dy = (int)ceil(neighbourhood/std::fabs(upp[1]));
+			rect.minx -= dx; rect.maxx += dx;
+			rect.miny -= dy; rect.maxy += dy;
+		}
+		bool whole = rect == RectInt(VectorInt(), target_surface->get_size());
+
 		Vector lt = source_rect.get_min();
 		Vector rb = source_rect.get_max();
-		lt[0] -= target_rect.minx*upp[0];
-		lt[1] -= target_rect.miny*upp[1];
-		rb[0] += (target_surface->get_width() - target_rect.maxx)*upp[0];
-		rb[1] += (target_surface->get_height() - target_rect.maxy)*upp[1];
+		lt[0] -= (target_rect.minx - rect.minx)*upp[0];
+		lt[1] -= (target_rect.miny - rect.miny)*upp[1];
+		rb[0] += (rect.maxx - target_rect.maxx)*upp[0];
+		rb[1] += (rect.maxy - target_rect.maxy)*upp[1];
 
 		RendDesc desc;
 		desc.set_tl(lt);
 		desc.set_br(rb);
-		desc.set_wh(target_surface->get_width(), target_surface->get_height());
+		desc.set_wh(rect.get_width(), rect.get_height());
 		desc.set_antialias(1);
 
 		etl::handle<Layer_RenderingTask> sub_layer(new Layer_RenderingTask());
@@ -92,7 +104,21 @@ public:
 		if (!ldst)
 			return false;
 
-		return context.accelerated_render(&ldst->get_surface(), 4, desc, NULL);
+		if (whole)
+			return context.accelerated_render(&ldst->get_surface(), 4, desc, NULL);
+
+		synfig::Surface surface;
+		if (!context.accelerated_render(&surface, 4, desc, NULL))
+			return false;
+
+		synfig::Surface::pen pen = ldst->get_surface().get_pen(target_rect.minx, target_rect.miny);
+		surface.blit_to(
+			pen,
+			target_rect.minx - rect.minx,
+			target_rect.miny - rect.miny,
+			target_rect.get_width(),
+			target_rect.get_height() );
+		return true;
 	}
 };
 
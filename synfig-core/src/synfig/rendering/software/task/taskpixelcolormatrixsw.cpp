@@ -49,6 +49,44 @@ using namespace rendering;
 
 namespace {
 
+//! Processes source tiles, constant tiles are processed as one pixel
+class ColorMatrixTile {
+private:
+	const ColorMatrix::BatchProcessor &processor;
+	SurfaceSW &dst;
+	const synfig::Surface &src;
+	VectorInt offset; //!< position in source minus position in destination
+
+public:
+	ColorMatrixTile(
+		const ColorMatrix::BatchProcessor &processor,
+		SurfaceSW &dst,
+		const synfig::Surface &src,
+		const VectorInt &offset
+	):
+		processor(processor), dst(dst), src(src), offset(offset) { }
+
+	void operator()(const RectInt &part, const SurfaceSW::Tile *tile) const {
+		int x = part.minx - offset[0];
+		int y = part.miny - offset[1];
+		if (tile && tile->constant) {
+			Color color;
+			processor.process(&color, 1, &tile->color, 1, 1, 1);
+			dst.get_surface().fill(color, x, y, part.get_width(), part.get_height());
+			dst.set_constant_coverage(part - offset, color);
+			return;
+		}
+		synfig::Surface &d = dst.get_surface();
+		processor.process(
+			&d[y][x],
+			d.get_pitch()/sizeof(Color),
+			&src[part.miny][part.minx],
+			src.get_pitch()/sizeof(Color),
+			part.get_width(),
+			part.get_height() );
+	}
+};
+
 class TaskPixelColorMatrixSW: public TaskPixelColorMatrix, public TaskSW
 {
 public:
@@ -80,18 +118,19 @@ public:
 				const synfig::Surface &src = lsrc->get_surface();
 
 				rs.list_subtract(constant_rects);
-				processor.process(
-					&dst[rs.miny][rs.minx],
-					dst.get_pitch()/sizeof(Color),
-					&src[rs.miny - rd.miny - offset[1]][rs.minx - rd.minx - offset[0]],
-					src.get_pitch()/sizeof(Color),
-					rs.get_width(),
-					rs.get_height() );
+				VectorInt src_offset = -rd.get_min() - offset;
+				ColorMatrixTile func(processor, *ldst, src, src_offset);
+				if (sub_task()->target_surface != target_surface)
+					lsrc->for_each_tile(rs + src_offset, func);
+				else
+					func(rs + src_offset, NULL);
 			}
 		}
 
-		for(std::vector<RectInt>::const_iterator i = constant_rects.begin(); i != constant_rects.end(); ++i)
+		for(std::vector<RectInt>::const_iterator i = constant_rects.begin(); i != constant_rects.end(); ++i) {
 			dst.fill(processor.get_constant_value(), i->minx, i->miny, i->get_width(), i->get_height());
+			ldst->set_constant_coverage(*i, processor.get_constant_value());
+		}
 
 		return true;
 	}
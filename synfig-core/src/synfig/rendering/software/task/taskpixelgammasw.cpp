@@ -185,6 +185,48 @@ private:
 				                                              process_r<func_copy>(p);
 	}
 
+	//! Processes source tiles, constant tiles are processed as one pixel
+	class ProcessTile {
+	private:
+		SurfaceSW &dst;
+		const synfig::Surface &src;
+		VectorInt offset; //!< position in source minus position in destination
+		ColorReal gamma_r, gamma_g, gamma_b;
+
+	public:
+		ProcessTile(
+			SurfaceSW &dst,
+			const synfig::Surface &src,
+			const VectorInt &offset,
+			ColorReal gamma_r,
+			ColorReal gamma_g,
+			ColorReal gamma_b
+		):
+			dst(dst), src(src), offset(offset),
+			gamma_r(gamma_r), gamma_g(gamma_g), gamma_b(gamma_b) { }
+
+		void operator()(const RectInt &part, const SurfaceSW::Tile *tile) const {
+			int x = part.minx - offset[0];
+			int y = part.miny - offset[1];
+			if (tile && tile->constant) {
+				Color color;
+				process(Params(&color, 1, &tile->color, 1, 1, 1, gamma_r, gamma_g, gamma_b));
+				dst.get_surface().fill(color, x, y, part.get_width(), part.get_height());
+				dst.set_constant_coverage(part - offset, color);
+				return;
+			}
+			synfig::Surface &d = dst.get_surface();
+			process(Params(
+				&d[y][x],
+				d.get_pitch()/sizeof(Color),
+				&src[part.miny][part.minx],
+				src.get_pitch()/sizeof(Color),
+				part.get_width(),
+				part.get_height(),
+				gamma_r, gamma_g, gamma_b ));
+		}
+	};
+
 public:
 	virtual bool run(RunParams&) const {
 		if (!is_valid() || !sub_task() || !sub_task()->is_valid())
@@ -201,19 +243,19 @@ public:
 			LockRead lsrc(sub_task());
 			if (!lsrc) return false;
 
-			synfig::Surface &dst = ldst->get_surface();
 			const synfig::Surface &src = lsrc->get_surface();
 
-			process(Params(
-				&dst[rs.miny][rs.minx],
-				dst.get_pitch()/sizeof(Color),
-				&src[rs.miny - rd.miny - offset[1]][rs.minx - rd.minx - offset[0]],
-				src.get_pitch()/sizeof(Color),
-				rs.get_width(),
-				rs.get_height(),
+			VectorInt src_offset = -rd.get_min() - offset;
+			ProcessTile func(
+				*ldst, src, src_offset,
 				clamp_positive(gamma.get_r()),
 				clamp_positive(gamma.get_g()),
-				clamp_positive(gamma.get_b()) ));
+				clamp_positive(gamma.get_b()) );
+			// in-place processing must not use tiles of the surface being written
+			if (sub_task()->target_surface != target_surface)
+				lsrc->for_each_tile(rs + src_offset, func);
+			else
+				func(rs + src_offset, NULL);
 		}
 
 		return true;
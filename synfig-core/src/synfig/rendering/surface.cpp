@@ -48,6 +48,58 @@ using namespace rendering;
 
 /* === M E T H O D S ======================================================= */
 
+namespace {
+	thread_local MemoryMeter::Handle current_memory_meter;
+}
+
+MemoryMeter::Scope::Scope(const Handle &meter):
+	prev(current_memory_meter)
+	{ current_memory_meter = meter; }
+
+MemoryMeter::Scope::~Scope()
+	{ current_memory_meter = prev; }
+
+MemoryMeter::MemoryMeter(const Handle &parent):
+	parent(parent),
+	allocated(0),
+	peak(0)
+{ }
+
+void
+MemoryMeter::add(size_t size)
+{
+	size_t total = (allocated += size);
+	size_t p = peak;
+	while(p < total && !peak.compare_exchange_weak(p, total));
+	if (parent) parent->add(size);
+}
+
+void
+MemoryMeter::remove(size_t size)
+{
+	allocated -= size;
+	if (parent) parent->remove(size);
+}
+
+void
+MemoryMeter::Usage::set(size_t size)
+{
+	if (size == this->size) return;
+	if (!this->size)
+		meter = get_current();
+	if (meter) {
+		if (size > this->size) meter->add(size - this->size);
+		                  else meter->remove(this->size - size);
+	}
+	this->size = size;
+	if (!size)
+		meter.reset();
+}
+
+MemoryMeter::Handle
+MemoryMeter::get_current()
+	{ return current_memory_meter; }
+
 synfig::Token Surface::token;
 int SurfaceResource::last_id = 0;
 
@@ -200,9 +252,14 @@ Surface::compare_with(synfig::rendering::Surface::Handle s) const
 
 bool
 Surface::touch()
+	{ return touch(RectInt(0, 0, get_width(), get_height())); }
+
+bool
+Surface::touch(const RectInt &rect)
 {
 	if (is_read_only() || !is_exists())
 		return false;
+	touch_vfunc(rect);
 	blank = false;
 	return true;
 }
@@ -213,13 +270,19 @@ SurfaceResource::SurfaceResource():
 	id(++last_id),
 	width(),
 	height(),
-	blank(true)
+	blank(true),
+	temporary(),
+	users(0),
+	sealed(nullptr)
 { }
 
 SurfaceResource::SurfaceResource(Surface::Handle surface):
 	width(),
 	height(),
-	blank(true)
+	blank(true),
+	temporary(),
+	users(0),
+	sealed(nullptr)
 { assign(surface); }
 
 SurfaceResource::~SurfaceResource()
@@ -239,6 +302,9 @@ SurfaceResource::get_surface(
 	if (!full && !rect.is_valid())
 		return Surface::Handle();
 
+	if (const SealedState *state = sealed.load(std::memory_order_acquire))
+		return exclusive ? Surface::Handle() : get_sealed_surface(*state, token, full, rect, create, any);
+
 	std::lock_guard<std::mutex> lock(mutex);
 
 	if (width <= 0 || height <= 0)
@@ -285,15 +351,152 @@ SurfaceResource::get_surface(
 	if (exclusive) {
 		if (surfaces.size() != 1) // keep only current surface in map
 			{ surfaces.clear(); surfaces[token] = surface; }
-		surface->touch();
+		if (full) surface->touch(); else surface->touch(rect);
 		blank = false;
 	}
 	return surface;
 }
 
+Surface::Handle
+SurfaceResource::get_sealed_surface(
+	const SealedState &state,
+	const Surface::Token::Handle &token,
+	bool full,
+	const RectInt &rect,
+	bool create,
+	bool any )
+{
+	if (state.width <= 0 || state.height <= 0)
+		return Surface::Handle();
+	if (!full && !rect_contains(RectInt(0, 0, state.width, state.height), rect))
+		return Surface::Handle();
+
+	for(SealedState::List::const_iterator i = state.surfaces.begin(); i != state.surfaces.end(); ++i)
+		if (i->first == token)
+			return i->second;
+	if (any && !state.surfaces.empty())
+		return state.surfaces.front().second;
+	if (!create)
+		return Surface::Handle();
+
+	// convert and publish new state with one more surface,
+	// surfaces of sealed resource are never written, so conversion doesn't need rwlock
+	std::lock_guard<std::mutex> lock(mutex);
+	const SealedState &current = *sealed.load(std::memory_order_relaxed);
+	for(SealedState::List::const_iterator i = current.surfaces.begin(); i != current.surfaces.end(); ++i)
+		if (i->first == token)
+			return i->second;
+
+	Surface::Handle surface = token->fabric();
+	if (!surface)
+		return Surface::Handle();
+	if (current.blank) {
+		if (!surface->create(current.width, current.height))
+			return Surface::Handle();
+	} else {
+		bool found = false;
+		for(SealedState::List::const_iterator i = current.surfaces.begin(); i != current.surfaces.end() && !found; ++i)
+			if (i->second->get_pixels_pointer() && surface->assign(*i->second))
+				found = true;
+		for(SealedState::List::const_iterator i = current.surfaces.begin(); i != current.surfaces.end() && !found; ++i)
+			if (!i->second->get_pixels_pointer() && surface->assign(*i->second))
+				found = true;
+		if (!found)
+			return Surface::Handle();
+	}
+
+	// previous states stay in the list, because readers may still use them
+	sealed_states.push_back(current);
+	sealed_states.back().surfaces.push_back(std::make_pair(token, surface));
+	sealed.store(&sealed_states.back(), std::memory_order_release);
+	return surface;
+}
+
+void
+SurfaceResource::seal()
+{
+	// wait for current readers and writers
+	Glib::Threads::RWLock::WriterLock lock(rwlock);
+	std::lock_guard<std::mutex> short_lock(mutex);
+	if (sealed.load(std::memory_order_relaxed))
+		return;
+
+	sealed_states.push_back(SealedState());
+	SealedState &state = sealed_states.back();
+	state.width = width;
+	state.height = height;
+	state.blank = blank;
+	state.surfaces.assign(surfaces.begin(), surfaces.end());
+	sealed.store(&state, std::memory_order_release);
+}
+
+bool
+SurfaceResource::compact(const Surface::Token::Handle &token)
+{
+	if (!token || is_sealed()) return false;
+	Glib::Threads::RWLock::WriterLock lock(rwlock);
+	std::lock_guard<std::mutex> short_lock(mutex);
+	if (width <= 0 || height <= 0)
+		return false;
+
+	if (blank) { // nothing to keep, surface will be created on demand
+		surfaces.clear();
+		return true;
+	}
+
+	Map::const_iterator i = surfaces.find(token);
+	Surface::Handle surface = i == surfaces.end() ? Surface::Handle() : i->second;
+	if (!surface) {
+		surface = token->fabric();
+		if (!surface)
+			return false;
+		bool found = false;
+		for(Map::const_iterator i = surfaces.begin(); i != surfaces.end() && !found; ++i)
+			if (i->second->get_pixels_pointer() && surface->assign(*i->second))
+				found = true;
+		for(Map::const_iterator i = surfaces.begin(); i != surfaces.end() && !found; ++i)
+			if (!i->second->get_pixels_pointer() && surface->assign(*i->second))
+				found = true;
+		if (!found)
+			return false;
+	}
+
+	surfaces.clear();
+	surfaces[token] = surface;
+	return true;
+}
+
+bool
+SurfaceResource::has_surface(const Surface::Token::Handle &token) const
+{
+	if (const SealedState *state = sealed.load(std::memory_order_acquire)) {
+		for(SealedState::List::const_iterator i = state->surfaces.begin(); i != state->surfaces.end(); ++i)
+			if (i->first == token)
+				return true;
+		return false;
+	}
+	std::lock_guard<std::mutex> lock(mutex);
+	return surfaces.count(token);
+}
+
+bool
+SurfaceResource::get_tokens(std::vector<Surface::Token::Handle> &outTokens) const
+{
+	if (const SealedState *state = sealed.load(std::memory_order_acquire)) {
+		for(SealedState::List::const_iterator i = state->surfaces.begin(); i != state->surfaces.end(); ++i)
+			outTokens.push_back(i->first);
+		return !state->surfaces.empty();
+	}
+	std::lock_guard<std::mutex> lock(mutex);
+	for(Map::const_iterator i = surfaces.begin(); i != surfaces.end(); ++i)
+		outTokens.push_back(i->first);
+	return !surfaces.empty();
+}
+
 void
 SurfaceResource::create(int width, int height)
 {
+	if (is_sealed()) return;
 	Glib::Threads::RWLock::WriterLock lock(rwlock);
 	std::lock_guard<std::mutex> short_lock(mutex);
 	if (width > 0 && height > 0) {
@@ -310,6 +513,7 @@ SurfaceResource::create(int width, int height)
 void
 SurfaceResource::assign(Surface::Handle surface)
 {
+	if (is_sealed()) return;
 	Glib::Threads::RWLock::WriterLock lock(rwlock);
 	std::lock_guard<std::mutex> short_lock(mutex);
 
@@ -333,6 +537,7 @@ SurfaceResource::assign(Surface::Handle surface)
 void
 SurfaceResource::clear()
 {
+	if (is_sealed()) return;
 	Glib::Threads::RWLock::WriterLock lock(rwlock);
 	std::lock_guard<std::mutex> short_lock(mutex);
 	blank = true;
@@ -342,6 +547,7 @@ SurfaceResource::clear()
 void
 SurfaceResource::reset()
 {
+	if (is_sealed()) return;
 	Glib::Threads::RWLock::WriterLock lock(rwlock);
 	std::lock_guard<std::mutex> short_lock(mutex);
 	width = 0;
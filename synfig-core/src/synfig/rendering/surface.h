@@ -27,6 +27,8 @@
 
 /* === H E A D E R S ======================================================= */
 
+#include <atomic>
+#include <list>
 #include <map>
 #include <vector>
 
@@ -52,6 +54,60 @@ namespace rendering
 {
 
 
+//! Counts memory of surfaces allocated while the meter is current for the thread.
+//! Renderer passes the current meter of the caller to the enqueued tasks,
+//! so memory of concurrent renders is measured separately.
+//! Memory is counted by parent meters too.
+class MemoryMeter: public etl::shared_object
+{
+public:
+	typedef etl::handle<MemoryMeter> Handle;
+
+	//! Makes the meter current for the thread until destruction
+	class Scope {
+	private:
+		Handle prev;
+	public:
+		explicit Scope(const Handle &meter);
+		~Scope();
+	};
+
+	//! Memory of one owner, counted by the meter which was current when it was allocated
+	class Usage {
+	private:
+		Handle meter;
+		size_t size;
+		Usage(const Usage&);
+		Usage& operator=(const Usage&);
+	public:
+		Usage(): size() { }
+		~Usage() { set(0); }
+		void set(size_t size);
+	};
+
+private:
+	Handle parent;
+	std::atomic<size_t> allocated;
+	std::atomic<size_t> peak;
+
+public:
+	explicit MemoryMeter(const Handle &parent = get_current());
+
+	void add(size_t size);
+	void remove(size_t size);
+
+	size_t get_allocated() const
+		{ return allocated; }
+	//! Largest value of get_allocated() since last reset_peak()
+	size_t get_peak() const
+		{ return peak; }
+	void reset_peak()
+		{ peak = (size_t)allocated; }
+
+	static Handle get_current();
+};
+
+
 class Surface: public etl::shared_object
 {
 public:
@@ -121,6 +177,9 @@ protected:
 		{ return false; }
 	virtual bool reset_vfunc()
 		{ return false; }
+	//! Called when part \a rect of surface is going to be written
+	virtual void touch_vfunc(const RectInt & /* rect */)
+		{ }
 	//! Implementations of this function should to work quick
 	virtual const Color* get_pixels_pointer_vfunc() const
 		{ return NULL; }
@@ -143,6 +202,7 @@ public:
 		{ return assign(pixels, get_width(), get_height()); }
 
 	bool touch();
+	bool touch(const RectInt &rect);
 
 	const Color* get_pixels_pointer() const;
 	bool get_pixels(Color *dest) const;
@@ -181,35 +241,39 @@ public:
 		bool lock_token;
 		Surface::Token::Handle token;
 		Surface::Handle surface;
+		bool locked;
 
 		void lock() {
-			if (resource) {
+			// sealed resource is never changed, so readers don't need the lock
+			if (resource && (write || !resource->is_sealed())) {
 				if (write) resource->rwlock.writer_lock();
 				      else resource->rwlock.reader_lock();
+				locked = true;
 			}
 		}
 		void unlock() {
-			if (resource) {
-				surface.reset();
+			surface.reset();
+			if (locked) {
 				if (write) resource->rwlock.writer_unlock();
 				      else resource->rwlock.reader_unlock();
+				locked = false;
 			}
 		}
 
-		LockBase(const LockBase&): full(), lock_token() { }
+		LockBase(const LockBase&): full(), lock_token(), locked() { }
 
 	public:
 		explicit LockBase(const Handle &resource):
-			resource(resource), full(true), lock_token(false)
+			resource(resource), full(true), lock_token(false), locked(false)
 			{ lock(); }
 		LockBase(const Handle &resource, const RectInt &rect):
-			resource(resource), full(false), rect(rect), lock_token(false)
+			resource(resource), full(false), rect(rect), lock_token(false), locked(false)
 			{ lock(); }
 		LockBase(const Handle &resource, const Surface::Token::Handle &token):
-			resource(resource), full(true), lock_token(true), token(token)
+			resource(resource), full(true), lock_token(true), token(token), locked(false)
 			{ lock(); }
 		LockBase(const Handle &resource, const RectInt &rect, const Surface::Token::Handle &token):
-			resource(resource), full(false), rect(rect), lock_token(true), token(token)
+			resource(resource), full(false), rect(rect), lock_token(true), token(token), locked(false)
 			{ lock(); }
 		~LockBase() { unlock(); }
 
@@ -325,6 +389,16 @@ public:
 	};
 
 private:
+	//! Surfaces of sealed resource, never changed after publication
+	struct SealedState {
+		typedef std::vector< std::pair<Surface::Token::Handle, Surface::Handle> > List;
+		int width;
+		int height;
+		bool blank;
+		List surfaces;
+		SealedState(): width(), height(), blank(true) { }
+	};
+
 	static int last_id;
 
 	int id;
@@ -333,6 +407,14 @@ private:
 	bool blank;
 	Map surfaces;
 
+	bool temporary;
+	std::atomic<int> users;
+
+	//! current state of sealed resource, readers load it without locks
+	std::atomic<const SealedState*> sealed;
+	//! all published states, old ones may still be in use by readers
+	std::list<SealedState> sealed_states;
+
 	mutable std::mutex mutex;
 	mutable Glib::Threads::RWLock rwlock;
 
@@ -343,6 +425,13 @@ private:
 		const RectInt &rect,
 		bool create,
 		bool any );
+	Surface::Handle get_sealed_surface(
+		const SealedState &state,
+		const Surface::Token::Handle &token,
+		bool full,
+		const RectInt &rect,
+		bool create,
+		bool any );
 
 public:
 	SurfaceResource();
@@ -359,27 +448,54 @@ public:
 
 	int get_id() const //!< helps to debug of renderer optimizers
 		{ return id; }
-	int get_width() const
-		{ std::lock_guard<std::mutex> lock(mutex); return width; }
-	int get_height() const
-		{ std::lock_guard<std::mutex> lock(mutex); return height; }
-	VectorInt get_size() const
-		{ std::lock_guard<std::mutex> lock(mutex); return VectorInt(width, height); }
+
+	//! Temporary surface holds intermediate result of the tasks,
+	//! renderer frees its pixels when the last task which uses it is done
+	bool is_temporary() const
+		{ return temporary; }
+	void set_temporary(bool x)
+		{ temporary = x; }
+
+	void add_user()
+		{ ++users; }
+	//! returns true when the last user was released
+	bool release_user()
+		{ return --users == 0; }
+
+	//! Sealed resource is finished and only read: readers take no locks,
+	//! converted surfaces are kept for all the following readers,
+	//! write access and all modifications are refused
+	void seal();
+	bool is_sealed() const
+		{ return sealed.load(std::memory_order_acquire) != nullptr; }
+
+	//! Converts content into the surface of \a token and frees all other surfaces,
+	//! so finished intermediate result is kept in more compact format
+	bool compact(const Surface::Token::Handle &token);
+
+	int get_width() const {
+		if (const SealedState *s = sealed.load(std::memory_order_acquire)) return s->width;
+		std::lock_guard<std::mutex> lock(mutex); return width;
+	}
+	int get_height() const {
+		if (const SealedState *s = sealed.load(std::memory_order_acquire)) return s->height;
+		std::lock_guard<std::mutex> lock(mutex); return height;
+	}
+	VectorInt get_size() const {
+		if (const SealedState *s = sealed.load(std::memory_order_acquire)) return VectorInt(s->width, s->height);
+		std::lock_guard<std::mutex> lock(mutex); return VectorInt(width, height);
+	}
 	bool is_exists() const
-		{ std::lock_guard<std::mutex> lock(mutex); return width > 0 && height > 0; }
-	bool is_blank() const
-		{ std::lock_guard<std::mutex> lock(mutex); return blank; }
-	bool has_surface(const Surface::Token::Handle &token) const
-		{ std::lock_guard<std::mutex> lock(mutex); return surfaces.count(token); }
+		{ VectorInt size = get_size(); return size[0] > 0 && size[1] > 0; }
+	bool is_blank() const {
+		if (const SealedState *s = sealed.load(std::memory_order_acquire)) return s->blank;
+		std::lock_guard<std::mutex> lock(mutex); return blank;
+	}
+	bool has_surface(const Surface::Token::Handle &token) const;
 	template<typename T>
 	bool has_surface() const
 		{ return has_surface(T::token.handle()); }
-	bool get_tokens(std::vector<Surface::Token::Handle> &outTokens) const {
-		std::lock_guard<std::mutex> lock(mutex);
-		for(Map::const_iterator i = surfaces.begin(); i != surfaces.end(); ++i)
-			outTokens.push_back(i->first);
-		return !surfaces.empty();
-	}
+	bool get_tokens(std::vector<Surface::Token::Handle> &outTokens) const;
 };
 
 
@@ -63,6 +63,91 @@ SYNFIG_EXPORT Task::Token TaskEvent::token(
 	DescSpecial<TaskEvent>("Event") );
 
 
+// TaskGraph
+
+TaskGraph::~TaskGraph()
+	{ }
+
+TaskGraph::Handle
+TaskGraph::create(const TaskList &list, const DepsList &deps, long long batch_index)
+{
+	assert(list.size() == deps.size());
+	Handle graph(new TaskGraph());
+	const int count = (int)list.size();
+	graph->nodes.resize(count);
+
+	int edges_count = 0;
+	for(DepsList::const_iterator i = deps.begin(); i != deps.end(); ++i)
+		edges_count += (int)i->size();
+	graph->edges.resize(2*edges_count);
+
+	// dependencies of all nodes go first, then dependent tasks
+	int offset = 0;
+	for(int i = 0; i < count; ++i) {
+		Node &node = graph->nodes[i];
+		node.task = list[i];
+		node.deps_begin = offset;
+		for(std::vector<int>::const_iterator j = deps[i].begin(); j != deps[i].end(); ++j) {
+			assert(*j >= 0 && *j < count && *j != i);
+			graph->edges[offset++] = *j;
+			++graph->nodes[*j].back_deps_left;
+		}
+		node.deps_end = offset;
+		node.deps_left = node.deps_end - node.deps_begin;
+	}
+	for(int i = 0; i < count; ++i) {
+		Node &node = graph->nodes[i];
+		node.back_deps_begin = node.back_deps_end = offset;
+		offset += node.back_deps_left;
+	}
+	for(int i = 0; i < count; ++i)
+		for(std::vector<int>::const_iterator j = deps[i].begin(); j != deps[i].end(); ++j)
+			graph->edges[graph->nodes[*j].back_deps_end++] = i;
+
+	for(int i = 0; i < count; ++i) {
+		Task::RendererData &rd = list[i]->renderer_data;
+		assert(rd.index == 0 && !rd.graph);
+		rd.graph = graph;
+		rd.batch_index = (int)batch_index;
+		rd.index = i + 1;
+	}
+	return graph;
+}
+
+void
+TaskGraph::set_done(int index, TaskList &ready)
+{
+	Node &node = nodes[index];
+	if (node.done || node.removed) return;
+	node.done = true;
+	node.back_deps_left = 0;
+	node.task.reset(); // task holds the graph, so the reference must be broken
+	for(Iterator i = back_deps_begin(index); i != back_deps_end(index); ++i) {
+		Node &n = nodes[*i];
+		if (n.removed) continue;
+		assert(n.deps_left > 0);
+		if (--n.deps_left == 0)
+			ready.push_back(n.task);
+	}
+}
+
+void
+TaskGraph::remove(int index, TaskList &orphans)
+{
+	Node &node = nodes[index];
+	if (node.done || node.removed) return;
+	node.removed = true;
+	node.task.reset();
+	for(Iterator i = deps_begin(index); i != deps_end(index); ++i) {
+		Node &n = nodes[*i];
+		if (n.done || n.removed) continue;
+		assert(n.back_deps_left > 0);
+		if (--n.back_deps_left == 0)
+			orphans.push_back(n.task);
+	}
+}
+
+
 // Task
 
 void Task::Token::unprepare_vfunc()
@@ -105,6 +190,7 @@ Task::assign_target(const Task &other) {
 void
 Task::assign(const Task &other) {
 	assign_target(other);
+	target_storage_token = other.target_storage_token;
 	sub_tasks = other.sub_tasks;
 	renderer_data = other.renderer_data; // TODO: remove renderer_data from task
 }
@@ -267,8 +353,10 @@ Task::set_coords(const Rect &source_rect, const VectorInt &target_size)
 		trunc_source_rect(source_rect);
 	}
 
-	if (!target_surface)
+	if (!target_surface) {
 		target_surface = new SurfaceResource();
+		target_surface->set_temporary(true);
+	}
 
 	// allocate surface by incoming target_size without truncation,
 	// it's significant for transformation antialiasing
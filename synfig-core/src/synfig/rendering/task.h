@@ -91,6 +91,75 @@ public:
 };
 
 
+// TaskGraph
+
+
+class Task;
+
+//! Dependencies between tasks of one batch.
+//! Nodes and edges are stored in flat arrays of indices and released all together
+//! when the last task of the batch is destroyed. Node holds its task until the task
+//! is done or removed, RenderQueue must call all non-const methods under its lock.
+class TaskGraph: public etl::shared_object
+{
+public:
+	typedef etl::handle<TaskGraph> Handle;
+	typedef std::vector< std::vector<int> > DepsList;
+	typedef std::vector< etl::handle<Task> > TaskList;
+	typedef const int* Iterator;
+
+private:
+	struct Node {
+		etl::handle<Task> task;				//!< released when task is done or removed
+		int deps_begin, deps_end;			//!< dependencies in edges
+		int back_deps_begin, back_deps_end;	//!< dependent tasks in edges
+		int deps_left;						//!< count of dependencies which are not done yet
+		int back_deps_left;					//!< count of dependent tasks which are not done or removed yet
+		bool done;
+		bool removed;
+		Node():
+			task(),
+			deps_begin(), deps_end(),
+			back_deps_begin(), back_deps_end(),
+			deps_left(), back_deps_left(),
+			done(), removed() { }
+	};
+
+	std::vector<Node> nodes;
+	std::vector<int> edges;
+
+	TaskGraph() { }
+
+public:
+	~TaskGraph();
+
+	//! Builds graph for \a list, \a deps contains indices of dependencies of each task.
+	//! Assigns graph, batch and index to renderer_data of tasks.
+	static Handle create(const TaskList &list, const DepsList &deps, long long batch_index);
+
+	int size() const
+		{ return (int)nodes.size(); }
+	bool is_ready(int index) const
+		{ return nodes[index].deps_left == 0; }
+	bool has_back_deps(int index) const
+		{ return nodes[index].back_deps_left > 0; }
+
+	Iterator deps_begin(int index) const
+		{ return edges.data() + nodes[index].deps_begin; }
+	Iterator deps_end(int index) const
+		{ return edges.data() + nodes[index].deps_end; }
+	Iterator back_deps_begin(int index) const
+		{ return edges.data() + nodes[index].back_deps_begin; }
+	Iterator back_deps_end(int index) const
+		{ return edges.data() + nodes[index].back_deps_end; }
+
+	//! Marks task as done, adds to \a ready the dependent tasks which have no more dependencies
+	void set_done(int index, TaskList &ready);
+	//! Removes task from graph, adds to \a orphans the dependencies which have no more dependent tasks
+	void remove(int index, TaskList &orphans);
+};
+
+
 // Mode
 
 
@@ -275,17 +344,24 @@ public:
 	struct RendererData
 	{
 		int batch_index;
-		int index;
-		Set deps;
-		Set back_deps;
+		int index; //!< index in graph plus one, zero if task is not enqueued
+		TaskGraph::Handle graph;
 
-		Set tmp_deps;
-		Set tmp_back_deps;
+		//! temporary surfaces to release when task is done, see Renderer::find_last_use
+		std::vector<etl::handle<SurfaceResource> > surfaces_to_release;
 
 		RunParams params;
 		bool success;
 
+		//! memory of surfaces allocated by the task is counted by this meter
+		MemoryMeter::Handle memory_meter;
+
 		RendererData(): batch_index(), index(), success() { }
+
+		bool is_ready() const
+			{ return !graph || graph->is_ready(index - 1); }
+		bool has_back_deps() const
+			{ return graph && graph->has_back_deps(index - 1); }
 	};
 
 	class LockReadBase: public SurfaceResource::LockReadBase
@@ -360,6 +436,8 @@ public:
 	Rect source_rect;
 	RectInt target_rect;
 	SurfaceResource::Handle target_surface;
+	//! format to keep result in when task is done, chosen by OptimizerSurfaceFormat
+	Surface::Token::Handle target_storage_token;
 	List sub_tasks;
 
 	mutable RendererData renderer_data;
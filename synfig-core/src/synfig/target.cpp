@@ -27,6 +27,9 @@
 # include <config.h>
 #endif
 
+#include <algorithm>
+
+#include "general.h"
 #include "target.h"
 #include "string.h"
 #include "canvas.h"
@@ -92,10 +95,25 @@ Target::Target():
 	quality_(4),
 	alpha_mode(TARGET_ALPHA_MODE_KEEP),
 	avoid_time_sync_(false),
-	curr_frame_(0)
+	curr_frame_(0),
+	frame_number_(0),
+	memory_limit_(0)
 {
 }
 
+int
+Target::get_total_frames()const
+{
+	if (!frame_list_.empty())
+	{
+		int count = 0;
+		for(std::vector<int>::const_iterator i = frame_list_.begin(); i != frame_list_.end(); ++i)
+			if (is_frame_in_range(*i)) ++count;
+		return std::max(1, count);
+	}
+	return std::max(1, desc.get_frame_end() - desc.get_frame_start() + 1);
+}
+
 void
 synfig::Target::set_canvas(etl::handle<Canvas> c)
 {
@@ -130,6 +148,29 @@ Target::next_frame(Time& time)
 	frame_end=desc.get_frame_end();
 	time_start=desc.get_time_start();
 	time_end=desc.get_time_end();
+
+	if(!frame_list_.empty())
+	{
+		// sparse set of frames
+		if (curr_frame_ == 0)
+		{
+			frames_in_range_.clear();
+			for(std::vector<int>::const_iterator i = frame_list_.begin(); i != frame_list_.end(); ++i)
+				if (is_frame_in_range(*i))
+					frames_in_range_.push_back(*i);
+			if (frames_in_range_.empty())
+			{
+				synfig::warning("Target: no frames of the list are within the range, rendering the first frame");
+				frames_in_range_.push_back(frame_start);
+			}
+		}
+		total_frames=(int)frames_in_range_.size();
+		frame_number_=frames_in_range_[std::min(curr_frame_, total_frames-1)];
+		time=desc.get_frame_rate() ? Time(frame_number_)/desc.get_frame_rate() : time_start;
+		curr_frame_++;
+		return total_frames - curr_frame_;
+	}
+
 	// TODO: Add option to exclude last frame
 	// If user wants to recover the last buggy behavior then 
 	// expose this option to the interface using the target params.
@@ -147,6 +188,7 @@ Target::next_frame(Time& time)
 	{
 		time=(time_end-time_start)*curr_frame_/(total_frames-(exclude_last_frame?0:1))+time_start;
 	}
+	frame_number_=frame_start+curr_frame_;
 
 //	synfig::info("before curr_frame_: %d",curr_frame_);
 	curr_frame_++;
@@ -31,6 +31,7 @@
 
 #include <map>
 #include <utility>
+#include <vector>
 
 #include <sigc++/signal.h>
 
@@ -112,6 +113,7 @@ public:
 private:
 
 	sigc::signal<void> signal_progress_;
+	sigc::signal<void, int> signal_frame_done_;
 
 	/*
  -- ** -- S I G N A L   I N T E R F A C E -------------------------------------
@@ -121,6 +123,9 @@ public:
 
 	sigc::signal<void>& signal_progress() { return signal_progress_; }
 
+	//! Emitted when the frame with given number is completely written by the target
+	sigc::signal<void, int>& signal_frame_done() { return signal_frame_done_; }
+
 	/*
  --	** -- C O N S T R U C T O R S ---------------------------------------------
 	*/
@@ -181,6 +186,22 @@ public:
 	//! The current frame being rendered
 	int curr_frame_;
 
+	//! Number of the frame chosen by the last call of next_frame()
+	int frame_number_;
+
+private:
+	//! Sorted numbers of frames to render, empty means all of the frames of desc
+	std::vector<int> frame_list_;
+
+	//! Frames of frame_list_ within range of desc, taken when next_frame() starts the render
+	std::vector<int> frames_in_range_;
+
+	bool is_frame_in_range(int frame)const
+		{ return frame >= desc.get_frame_start() && frame <= std::max(desc.get_frame_start(), desc.get_frame_end()); }
+
+	//! Approximate limit of memory used by render process in bytes, zero means unlimited
+	size_t memory_limit_;
+
 protected:
 	//! Default constructor
 	Target();
@@ -195,6 +216,19 @@ public:
 	void set_avoid_time_sync(bool x=true) { avoid_time_sync_=x; }
 	//! Gets the target avoid time synchronization
 	bool get_avoid_time_sync()const { return avoid_time_sync_; }
+	//! Gets the memory limit in bytes, zero means unlimited
+	size_t get_memory_limit()const { return memory_limit_; }
+	//! Sets the memory limit in bytes, zero means unlimited
+	void set_memory_limit(size_t x) { memory_limit_=x; }
+	//! Gets the numbers of frames to render, empty list means the whole range of rend_desc()
+	const std::vector<int>& get_frame_list()const { return frame_list_; }
+	//! Sets the numbers of frames to render, frames out of range of rend_desc() are skipped.
+	//! At least one of the frames should be within the range
+	void set_frame_list(const std::vector<int> &x) { frame_list_=x; }
+	//! Gets the count of frames which render() will produce
+	int get_total_frames()const;
+	//! Gets the number of the frame chosen by the last call of next_frame()
+	int get_frame_number()const { return frame_number_; }
 	//! Tells how to handle alpha
 	/*! Used by non alpha supported targets to decide if the background
 	 ** must be filled or not
@@ -231,7 +265,8 @@ public:
 						 const synfig::TargetParam& params);
 	
 	//!	Sets the time for the next frame at \a time
-	/*! It modifies the curr_frame_ member which has to be set to zero when next_frame is called for the first time
+	/*! It modifies the curr_frame_ member which has to be set to zero when next_frame is called for the first time.
+	 ** When frame list is set only the listed frames are visited.
 	 ** \param time The time reference to be modified
 	 **	\return The number of remaining frames to render
 	 **	\sa curr_frame_
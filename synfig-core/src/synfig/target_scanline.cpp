@@ -41,6 +41,7 @@
 #include "render.h"
 #include "string.h"
 #include "surface.h"
+#include "debug/trace.h"
 #include "rendering/renderer.h"
 #include "rendering/surface.h"
 #include "rendering/software/surfacesw.h"
@@ -61,6 +62,9 @@ using namespace rendering;
 
 #define USE_PIXELRENDERING_LIMIT 1
 
+//! Estimated count of stripe sized surfaces alive while stripe renders
+#define MEMORY_ROW_FACTOR 4
+
 /* === G L O B A L S ======================================================= */
 
 /* === P R O C E D U R E S ================================================= */
@@ -88,8 +92,16 @@ synfig::Target_Scanline::call_renderer(
 	const ContextParams &context_params,
 	const RendDesc &renddesc )
 {
+	SYNFIG_TRACE_SCOPE(
+		"Target_Scanline::call_renderer", -1, -1,
+		renddesc.get_w(), renddesc.get_h(),
+		(long long)renddesc.get_w()*renddesc.get_h()*sizeof(Color) );
+
 	surface->create(renddesc.get_w(), renddesc.get_h());
-	rendering::Task::Handle task = canvas.build_rendering_task(context_params);
+
+	ContextParams params(context_params);
+	params.render_rect = Rect(renddesc.get_tl(), renddesc.get_br());
+	rendering::Task::Handle task = canvas.build_rendering_task(params);
 
 	if (task)
 	{
@@ -120,15 +132,113 @@ synfig::Target_Scanline::call_renderer(
 	return true;
 }
 
+bool
+synfig::Target_Scanline::need_stripes() const
+{
+	#if USE_PIXELRENDERING_LIMIT
+	if (desc.get_w()*desc.get_h() > PIXEL_RENDERING_LIMIT)
+		return true;
+	#endif
+	size_t frame_size = (size_t)desc.get_w()*(size_t)desc.get_h()*sizeof(Color);
+	return get_memory_limit() && frame_size*MEMORY_ROW_FACTOR > get_memory_limit();
+}
+
+bool
+synfig::Target_Scanline::render_stripes(const ContextParams &context_params, ProgressCallback *cb, bool report_progress)
+{
+	const int width = desc.get_w();
+	const int height = desc.get_h();
+	const size_t limit = get_memory_limit();
+
+	// at start we have no statistics, so just guess how many
+	// intermediate surfaces of stripe size renderer will keep
+	size_t row_cost = (size_t)width*sizeof(Color)*MEMORY_ROW_FACTOR;
+
+	// memory limit must not turn off the limit of pixels checked by need_stripes()
+	int max_rowheight = limit ? height : PIXEL_RENDERING_LIMIT/width;
+	#if USE_PIXELRENDERING_LIMIT
+	max_rowheight = std::min(max_rowheight, PIXEL_RENDERING_LIMIT/width);
+	#endif
+	max_rowheight = std::max(1, max_rowheight);
+
+	int rowheight = limit
+	              ? (int)std::min(limit/row_cost, (size_t)max_rowheight)
+	              : max_rowheight;
+	if (rowheight < 1) {
+		synfig::warning(_("Memory limit is too small to render even one row of pixels, rendering row by row"));
+		rowheight = 1;
+	}
+
+	synfig::info("Render split to blocks %d pixels tall", rowheight);
+
+	if(!start_frame())
+	{
+		if(cb)
+			cb->error(_("add_frame(): target panic on start_frame()"));
+		return false;
+	}
+
+	// concurrent renders of other targets must not affect the measurements
+	MemoryMeter::Handle memory_meter = new MemoryMeter();
+	MemoryMeter::Scope memory_scope(memory_meter);
+
+	SurfaceResource::Handle surface = new SurfaceResource();
+	int blocks = 0;
+	for(int yoff = 0; yoff < height; ++blocks)
+	{
+		int blockheight = std::min(rowheight, height - yoff);
+		RendDesc blockrd = desc;
+		blockrd.set_subwindow(0, yoff, width, blockheight);
+
+		surface->reset();
+		size_t base_memory = memory_meter->get_allocated();
+		memory_meter->reset_peak();
+
+		if (!call_renderer(surface, *canvas, context_params, blockrd))
+		{
+			if(cb)cb->error(_("Accelerated Renderer Failure"));
+			return false;
+		}
+
+		{
+			SurfaceResource::LockRead<SurfaceSW> lock(surface);
+			if(!lock)
+			{
+				if(cb)cb->error(_("Bad surface"));
+				return false;
+			}
+			if (!put_scanlines(lock->get_surface(), yoff, cb))
+				return false;
+		}
+
+		yoff += blockheight;
+		if (report_progress && cb) cb->amount_complete(yoff, height);
+
+		// all intermediate surfaces of this block are released here,
+		// so correct height of next blocks using the measured peak
+		if (limit) {
+			size_t peak_memory = memory_meter->get_peak();
+			if (peak_memory > base_memory) {
+				row_cost = std::max((size_t)width*sizeof(Color), (peak_memory - base_memory)/blockheight);
+				rowheight = std::max(1, (int)std::min(limit/row_cost, (size_t)max_rowheight));
+			}
+		}
+	}
+	surface->reset();
+
+	end_frame();
+
+	synfig::info("Rendered %d block%s", blocks, blocks == 1 ? "" : "s");
+	return true;
+}
+
 bool
 synfig::Target_Scanline::render(ProgressCallback *cb)
 {
 	SuperCallback super_cb;
 	int
 		frames=0,
-		total_frames,
-		frame_start,
-		frame_end;
+		total_frames;
 	Time
 		t=0;
 
@@ -140,14 +250,10 @@ synfig::Target_Scanline::render(ProgressCallback *cb)
 		return false;
 	}
 
-	frame_start=desc.get_frame_start();
-	frame_end=desc.get_frame_end();
-
 	ContextParams context_params(desc.get_render_excluded_contexts());
 
 	// Calculate the number of frames
-	total_frames=frame_end-frame_start+1;
-	if(total_frames<=0)total_frames=1;
+	total_frames=get_total_frames();
 
 	try {
 
@@ -172,287 +278,22 @@ synfig::Target_Scanline::render(ProgressCallback *cb)
 			canvas->set_outline_grow(desc.get_outline_grow());
 
 			// If quality is set otherwise, then we use the accelerated renderer
+			if(need_stripes())
 			{
-				#if USE_PIXELRENDERING_LIMIT
-				if(desc.get_w()*desc.get_h() > PIXEL_RENDERING_LIMIT)
-				{
-					SurfaceResource::Handle surface = new SurfaceResource();
-
-					int rowheight = PIXEL_RENDERING_LIMIT/desc.get_w();
-					if (!rowheight) rowheight = 1; // TODO: render partial lines to stay within the limit?
-					int rows = desc.get_h()/rowheight;
-					int lastrowheight = desc.get_h() - rows*rowheight;
-
-					rows++;
-
-					synfig::info("Render split to %d block%s %d pixels tall, and a final block %d pixels tall",
-								 rows-1, rows==2?"":"s", rowheight, lastrowheight);
-
-					// loop through all the full rows
-					if(!start_frame())
-					{
-//						throw(string("add_frame(): target panic on start_frame()"));
-						if(cb)
-							cb->error(_("add_frame(): target panic on start_frame()"));
-						return false;
-					}
-
-					for(int i=0; i < rows; ++i)
-					{
-						surface->reset();
-						RendDesc blockrd = desc;
-
-						//render the strip at the normal size unless it's the last one...
-						if(i == rows-1)
-						{
-							if(!lastrowheight) break;
-							blockrd.set_subwindow(0,i*rowheight,desc.get_w(),lastrowheight);
-						}
-						else
-						{
-							blockrd.set_subwindow(0,i*rowheight,desc.get_w(),rowheight);
-						}
-
-						//synfig::info( " -- block %d/%d left, top, width, height: %d, %d, %d, %d",
-						//	i+1, rows, 0, i*rowheight, blockrd.get_w(), blockrd.get_h() );
-
-						if (!call_renderer(surface, *canvas, context_params, blockrd))
-						{
-							if(cb)cb->error(_("Accelerated Renderer Failure"));
-							return false;
-						} else {
-							SurfaceResource::LockRead<SurfaceSW> lock(surface);
-							if (!lock) {
-								if(cb)cb->error(_("Accelerated Renderer Failure: cannot read surface"));
-								return false;
-							}
-
-							const synfig::Surface &s = lock->get_surface();
-
-							int y;
-							int rowspan=sizeof(Color)*s.get_w();
-							Surface::const_pen pen = s.begin();
-
-							int yoff = i*rowheight;
-
-							for(y = 0; y < blockrd.get_h(); y++, pen.inc_y())
-							{
-								Color *colordata= start_scanline(y + yoff);
-								if(!colordata)
-								{
-//									throw(string("add_frame(): call to start_scanline(y) returned NULL"));
-									if(cb)
-										cb->error(_("add_frame(): call to start_scanline(y) returned NULL"));
-									return false;
-								}
-
-								switch(get_alpha_mode())
-								{
-									case TARGET_ALPHA_MODE_FILL:
-										for(int i = 0; i < s.get_w(); i++)
-											colordata[i] = Color::blend(s[y][i], desc.get_bg_color(), 1.0f);
-										break;
-									case TARGET_ALPHA_MODE_EXTRACT:
-										for(int i = 0; i < s.get_w(); i++)
-										{
-											float a=s[y][i].get_a();
-											colordata[i] = Color(a,a,a,a);
-										}
-										break;
-									case TARGET_ALPHA_MODE_REDUCE:
-										for(int i = 0; i < s.get_w(); i++)
-											colordata[i] = Color(s[y][i].get_r(), s[y][i].get_g(), s[y][i].get_b(), 1.f);
-										break;
-									case TARGET_ALPHA_MODE_KEEP:
-										memcpy(colordata, s[y], rowspan);
-										break;
-								}
-
-								if(!end_scanline())
-								{
-//									throw(string("add_frame(): target panic on end_scanline()"));
-									if(cb)
-										cb->error(_("add_frame(): target panic on end_scanline()"));
-									return false;
-								}
-							}
-						}
-					}
-					surface->reset();
-
-					end_frame();
-
-				}else //use normal rendering...
-				{
-				#endif
-					SurfaceResource::Handle surface = new SurfaceResource();
-
-					if (!call_renderer(surface, *canvas, context_params, desc))
-					{
-						// For some reason, the accelerated renderer failed.
-						if(cb)cb->error(_("Accelerated Renderer Failure"));
-						return false;
-					}
-
-					SurfaceResource::LockRead<SurfaceSW> lock(surface);
-					if(!lock)
-					{
-						if(cb)cb->error(_("Bad surface"));
-						return false;
-					}
-
-					// Put the surface we renderer
-					// onto the target.
-					if(!add_frame(&lock->get_surface(), cb))
-					{
-						if(cb)cb->error(_("Unable to put surface on target"));
-						return false;
-					}
-				#if USE_PIXELRENDERING_LIMIT
-				}
-				#endif
-			}
-		}while(frames);
-	}
-    else
-    {
-		// Set the time that we wish to render
-		if(!get_avoid_time_sync() || canvas->get_time()!=t) {
-			canvas->set_time(t);
-			canvas->load_resources(t);
-		}
-		canvas->set_outline_grow(desc.get_outline_grow());
-
-		// If quality is set otherwise, then we use the accelerated renderer
-		{
-			#if USE_PIXELRENDERING_LIMIT
-			if(desc.get_w()*desc.get_h() > PIXEL_RENDERING_LIMIT)
-			{
-				SurfaceResource::Handle surface(new SurfaceResource());
-
-				int totalheight = desc.get_h();
-				int rowheight = PIXEL_RENDERING_LIMIT/desc.get_w();
-				if (!rowheight) rowheight = 1; // TODO: render partial lines to stay within the limit?
-				int rows = desc.get_h()/rowheight;
-				int lastrowheight = desc.get_h() - rows*rowheight;
-
-				rows++;
-
-				synfig::info("Render split to %d block%s %d pixels tall, and a final block %d pixels tall",
-							 rows-1, rows==2?"":"s", rowheight, lastrowheight);
-
-				// loop through all the full rows
-				if(!start_frame())
-				{
-//					throw(string("add_frame(): target panic on start_frame()"));
-					if(cb)
-						cb->error(_("add_frame(): target panic on start_frame()"));
+				if (!render_stripes(context_params, cb, false))
 					return false;
-				}
-
-				for(int i=0; i < rows; ++i)
-				{
-					surface->reset();
-					RendDesc blockrd = desc;
-
-					//render the strip at the normal size unless it's the last one...
-					if(i == rows-1)
-					{
-						if(!lastrowheight) break;
-						blockrd.set_subwindow(0,i*rowheight,desc.get_w(),lastrowheight);
-					}
-					else
-					{
-						blockrd.set_subwindow(0,i*rowheight,desc.get_w(),rowheight);
-					}
-
-					//synfig::info( " -- block %d/%d left, top, width, height: %d, %d, %d, %d",
-					//	i+1, rows, 0, i*rowheight, blockrd.get_w(), blockrd.get_h() );
-
-					if (!call_renderer(surface, *canvas, context_params, blockrd))
-					{
-						if(cb)cb->error(_("Accelerated Renderer Failure"));
-						return false;
-					}
-
-					SurfaceResource::LockRead<SurfaceSW> lock(surface);
-
-					if(!lock)
-					{
-						if(cb)cb->error(_("Bad surface"));
-						return false;
-					}
-
-					const synfig::Surface &s = lock->get_surface();
-
-					int y;
-					int rowspan=sizeof(Color)*s.get_w();
-					Surface::const_pen pen = s.begin();
-
-					int yoff = i*rowheight;
-
-					for(y = 0; y < blockrd.get_h(); y++, pen.inc_y())
-					{
-						Color *colordata= start_scanline(y + yoff);
-						if(!colordata)
-						{
-//							throw(string("add_frame(): call to start_scanline(y) returned NULL"));
-							if(cb)
-								cb->error(_("add_frame(): call to start_scanline(y) returned NULL"));
-							return false;
-						}
-
-						switch(get_alpha_mode())
-						{
-							case TARGET_ALPHA_MODE_FILL:
-								for(int i = 0; i < s.get_w(); i++)
-									colordata[i] = Color::blend(s[y][i], desc.get_bg_color(), 1.0f);
-								break;
-							case TARGET_ALPHA_MODE_EXTRACT:
-								for(int i = 0; i < s.get_w(); i++)
-								{
-									float a=s[y][i].get_a();
-									colordata[i] = Color(a,a,a,a);
-								}
-								break;
-							case TARGET_ALPHA_MODE_REDUCE:
-								for(int i = 0; i < s.get_w(); i++)
-									colordata[i] = Color(s[y][i].get_r(), s[y][i].get_g(), s[y][i].get_b(), 1.0f);
-								break;
-							case TARGET_ALPHA_MODE_KEEP:
-								memcpy(colordata,s[y], rowspan);
-								break;
-						}
-
-						if(!end_scanline())
-						{
-//							throw(string("add_frame(): target panic on end_scanline()"));
-							if(cb)
-								cb->error(_("add_frame(): target panic on end_scanline()"));
-							return false;
-						}
-					}
-
-					//I'm done with this part
-					if (cb) cb->amount_complete((i+1)*rowheight, totalheight);
-				}
-				surface->reset();
-
-				end_frame();
-
-			}else
+			}else //use normal rendering...
 			{
-			#endif
 				SurfaceResource::Handle surface = new SurfaceResource();
 
 				if (!call_renderer(surface, *canvas, context_params, desc))
 				{
+					// For some reason, the accelerated renderer failed.
 					if(cb)cb->error(_("Accelerated Renderer Failure"));
 					return false;
 				}
 
 				SurfaceResource::LockRead<SurfaceSW> lock(surface);
-
 				if(!lock)
 				{
 					if(cb)cb->error(_("Bad surface"));
@@ -466,9 +307,49 @@ synfig::Target_Scanline::render(ProgressCallback *cb)
 					if(cb)cb->error(_("Unable to put surface on target"));
 					return false;
 				}
-			#if USE_PIXELRENDERING_LIMIT
 			}
-			#endif
+			signal_frame_done()(get_frame_number());
+		}while(frames);
+	}
+    else
+    {
+		// Set the time that we wish to render
+		if(!get_avoid_time_sync() || canvas->get_time()!=t) {
+			canvas->set_time(t);
+			canvas->load_resources(t);
+		}
+		canvas->set_outline_grow(desc.get_outline_grow());
+
+		// If quality is set otherwise, then we use the accelerated renderer
+		if(need_stripes())
+		{
+			if (!render_stripes(context_params, cb, true))
+				return false;
+		}else
+		{
+			SurfaceResource::Handle surface = new SurfaceResource();
+
+			if (!call_renderer(surface, *canvas, context_params, desc))
+			{
+				if(cb)cb->error(_("Accelerated Renderer Failure"));
+				return false;
+			}
+
+			SurfaceResource::LockRead<SurfaceSW> lock(surface);
+
+			if(!lock)
+			{
+				if(cb)cb->error(_("Bad surface"));
+				return false;
+			}
+
+			// Put the surface we renderer
+			// onto the target.
+			if(!add_frame(&lock->get_surface(), cb))
+			{
+				if(cb)cb->error(_("Unable to put surface on target"));
+				return false;
+			}
 		}
 	}
 
@@ -492,26 +373,18 @@ synfig::Target_Scanline::render(ProgressCallback *cb)
 }
 
 bool
-Target_Scanline::add_frame(const synfig::Surface *surface, ProgressCallback *cb)
+Target_Scanline::put_scanlines(const synfig::Surface &surface, int offset, ProgressCallback *cb)
 {
-	assert(surface);
-
+	SYNFIG_TRACE_SCOPE(
+		"Target_Scanline::put_scanlines", -1, -1,
+		surface.get_w(), surface.get_h(),
+		(long long)surface.get_w()*surface.get_h()*sizeof(Color) );
 
-	int y;
-	int rowspan=sizeof(Color)*surface->get_w();
-	Surface::const_pen pen=surface->begin();
-
-	if(!start_frame(cb))
-	{
-//		throw(string("add_frame(): target panic on start_frame()"));
-		if (cb)
-			cb->error(_("add_frame(): target panic on start_frame()"));
-		return false;
-	}
+	int rowspan=sizeof(Color)*surface.get_w();
 
-	for(y=0;y<surface->get_h();y++,pen.inc_y())
+	for(int y=0;y<surface.get_h();y++)
 	{
-		Color *colordata= start_scanline(y);
+		Color *colordata= start_scanline(y + offset);
 		if(!colordata)
 		{
 //			throw(string("add_frame(): call to start_scanline(y) returned NULL"));
@@ -523,22 +396,22 @@ Target_Scanline::add_frame(const synfig::Surface *surface, ProgressCallback *cb)
 		switch(get_alpha_mode())
 		{
 			case TARGET_ALPHA_MODE_FILL:
-				for(int i=0;i<surface->get_w();i++)
-					colordata[i]=Color::blend((*surface)[y][i],desc.get_bg_color(),1.0f);
+				for(int i=0;i<surface.get_w();i++)
+					colordata[i]=Color::blend(surface[y][i],desc.get_bg_color(),1.0f);
 				break;
 			case TARGET_ALPHA_MODE_EXTRACT:
-				for(int i=0;i<surface->get_w();i++)
+				for(int i=0;i<surface.get_w();i++)
 				{
-					float a=(*surface)[y][i].get_a();
+					float a=surface[y][i].get_a();
 					colordata[i] = Color(a,a,a,a);
 				}
 				break;
 			case TARGET_ALPHA_MODE_REDUCE:
-				for(int i = 0; i < surface->get_w(); i++)
-					colordata[i] = Color((*surface)[y][i].get_r(),(*surface)[y][i].get_g(),(*surface)[y][i].get_b(),1.0f);
+				for(int i = 0; i < surface.get_w(); i++)
+					colordata[i] = Color(surface[y][i].get_r(),surface[y][i].get_g(),surface[y][i].get_b(),1.0f);
 				break;
 			case TARGET_ALPHA_MODE_KEEP:
-				memcpy(colordata,(*surface)[y],rowspan);
+				memcpy(colordata,surface[y],rowspan);
 				break;
 		}
 
@@ -551,6 +424,25 @@ Target_Scanline::add_frame(const synfig::Surface *surface, ProgressCallback *cb)
 		}
 	}
 
+	return true;
+}
+
+bool
+Target_Scanline::add_frame(const synfig::Surface *surface, ProgressCallback *cb)
+{
+	assert(surface);
+
+	if(!start_frame(cb))
+	{
+//		throw(string("add_frame(): target panic on start_frame()"));
+		if (cb)
+			cb->error(_("add_frame(): target panic on start_frame()"));
+		return false;
+	}
+
+	if (!put_scanlines(*surface, 0, cb))
+		return false;
+
 	end_frame();
 
 	return true;
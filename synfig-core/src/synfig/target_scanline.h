@@ -57,6 +57,13 @@ class Target_Scanline : public Target
 		const ContextParams &context_params,
 		const RendDesc &renddesc );
 
+	//! Checks whether frame should be rendered by horizontal stripes
+	bool need_stripes() const;
+	//! Renders frame by stripes which height fits into memory limit
+	bool render_stripes(const ContextParams &context_params, ProgressCallback *cb, bool report_progress);
+	//! Puts rows of the surface onto the target starting from \a offset row
+	bool put_scanlines(const synfig::Surface &surface, int offset, ProgressCallback *cb);
+
 public:
 	typedef etl::handle<Target_Scanline> Handle;
 	typedef etl::loose_handle<Target_Scanline> LooseHandle;
@@ -48,10 +48,12 @@
 #include "surface.h"
 
 #include "debug/measure.h"
+#include "debug/trace.h"
 
 #include "rendering/renderer.h"
 #include "rendering/surface.h"
 #include "rendering/software/surfacesw.h"
+#include "rendering/common/task/taskblend.h"
 #include "rendering/common/task/tasktransformation.h"
 
 #endif
@@ -76,6 +78,50 @@ const unsigned int	DEF_TILE_HEIGHT = TILE_SIZE / 2;
 
 /* === P R O C E D U R E S ================================================= */
 
+namespace {
+
+//! Blend and List tasks draws their sub-tasks in the same coordinates
+//! and treat the missing sub-tasks as transparent
+bool
+is_cullable_parent(const rendering::Task::Handle &task)
+{
+	return task.type_is<rendering::TaskBlend>()
+	    || task.type_is<rendering::TaskList>();
+}
+
+//! Calculates the bounds once, before the task is shared between the tiles
+void
+prepare_bounds(const rendering::Task::Handle &task)
+{
+	if (!task) return;
+	task->get_bounds();
+	if (is_cullable_parent(task))
+		for(rendering::Task::List::const_iterator i = task->sub_tasks.begin(); i != task->sub_tasks.end(); ++i)
+			prepare_bounds(*i);
+}
+
+//! Makes the copy of the frame task for the tile,
+//! sub-trees which are not visible in the tile are skipped
+rendering::Task::Handle
+instantiate_for_tile(const rendering::Task::Handle &task, const Rect &tile_rect)
+{
+	if (!task) return task;
+
+	const Rect &bounds = task->get_bounds();
+	if (!bounds.is_valid() || !rect_intersect(bounds, tile_rect))
+		return rendering::Task::Handle();
+
+	if (!is_cullable_parent(task))
+		return task->clone_recursive();
+
+	rendering::Task::Handle copy = task->clone();
+	for(rendering::Task::List::iterator i = copy->sub_tasks.begin(); i != copy->sub_tasks.end(); ++i)
+		*i = instantiate_for_tile(*i, tile_rect);
+	return copy;
+}
+
+} // end of anonymous namespace
+
 /* === M E T H O D S ======================================================= */
 
 Target_Tile::Target_Tile():
@@ -119,21 +165,28 @@ Target_Tile::next_tile(RectInt& rect)
 bool
 synfig::Target_Tile::call_renderer(
 	const etl::handle<rendering::SurfaceResource> &surface,
-	Canvas &canvas,
-	const ContextParams &context_params,
+	const rendering::Task::Handle &frame_task,
 	const RendDesc &renddesc )
 {
 	#ifdef DEBUG_MEASURE
 	debug::Measure t("Target_Tile::call_renderer");
 	#endif
+	SYNFIG_TRACE_SCOPE(
+		"Target_Tile::call_renderer", -1, -1,
+		renddesc.get_w(), renddesc.get_h(),
+		(long long)renddesc.get_w()*renddesc.get_h()*sizeof(Color) );
 
 	surface->create(renddesc.get_w(), renddesc.get_h());
+
+	Vector p0 = renddesc.get_tl();
+	Vector p1 = renddesc.get_br();
+
 	rendering::Task::Handle task;
 	{
 		#ifdef DEBUG_MEASURE
-		debug::Measure t("build rendering task");
+		debug::Measure t("instantiate rendering task");
 		#endif
-		task = canvas.build_rendering_task(context_params);
+		task = instantiate_for_tile(frame_task, Rect(p0, p1));
 	}
 
 	if (task)
@@ -142,8 +195,6 @@ synfig::Target_Tile::call_renderer(
 		if (!renderer)
 			throw "Renderer '" + get_engine() + "' not found";
 
-		Vector p0 = renddesc.get_tl();
-		Vector p1 = renddesc.get_br();
 		if (p0[0] > p1[0] || p0[1] > p1[1]) {
 			Matrix m;
 			if (p0[0] > p1[0]) { m.m00 = -1.0; m.m20 = p0[0] + p1[0]; std::swap(p0[0], p1[0]); }
@@ -176,8 +227,16 @@ synfig::Target_Tile::render_frame_(Canvas::Handle canvas, ContextParams context_
 {
 	const RendDesc &rend_desc(desc);
 
-	etl::clock tile_timer;
-	tile_timer.reset();
+	// Build the task graph of the frame once, it will be instantiated for each tile
+	rendering::Task::Handle task;
+	{
+		#ifdef DEBUG_MEASURE
+		debug::Measure t("build rendering task");
+		#endif
+		context_params.render_rect = Rect(rend_desc.get_tl(), rend_desc.get_br());
+		task = canvas->build_rendering_task(context_params);
+		prepare_bounds(task);
+	}
 
 	// Gather tiles
 	std::vector<RectInt> tiles;
@@ -189,6 +248,26 @@ synfig::Target_Tile::render_frame_(Canvas::Handle canvas, ContextParams context_
 		tiles.push_back(rect);
 	}
 
+	// Schedule the tiles which was most expensive in the previous frame first,
+	// tiles without known cost keeps their order
+	{
+		std::lock_guard<std::mutex> lock(tile_costs_mutex_);
+		if (!tile_costs_.empty()) {
+			std::vector< std::pair<Real, int> > order;
+			order.reserve(tiles.size());
+			for(std::vector<RectInt>::const_iterator i = tiles.begin(); i != tiles.end(); ++i) {
+				std::map<std::pair<int, int>, Real>::const_iterator j = tile_costs_.find(std::make_pair(i->minx, i->miny));
+				order.push_back(std::make_pair(j == tile_costs_.end() ? Real() : -j->second, (int)(i - tiles.begin())));
+			}
+			std::stable_sort(order.begin(), order.end());
+			std::vector<RectInt> sorted_tiles;
+			sorted_tiles.reserve(tiles.size());
+			for(std::vector< std::pair<Real, int> >::const_iterator i = order.begin(); i != order.end(); ++i)
+				sorted_tiles.push_back(tiles[i->second]);
+			tiles.swap(sorted_tiles);
+		}
+	}
+
 	// Render tiles
 	for(std::vector<RectInt>::iterator i = tiles.begin(); i != tiles.end(); ++i)
 	{
@@ -200,8 +279,6 @@ synfig::Target_Tile::render_frame_(Canvas::Handle canvas, ContextParams context_
 			return false;
 
 		// Render tile
-		tile_timer.reset();
-
 		rect = *i;
 		if (clipping_)
 			rect_set_intersect(rect, rect, RectInt(0, 0, rend_desc.get_w(), rend_desc.get_h()));
@@ -212,7 +289,7 @@ synfig::Target_Tile::render_frame_(Canvas::Handle canvas, ContextParams context_
 		RendDesc tile_desc=rend_desc;
 		tile_desc.set_subwindow(rect.minx, rect.miny, rect.maxx - rect.minx, rect.maxy - rect.miny);
 
-		async_render_tile(canvas, context_params, rect, tile_desc, &super);
+		async_render_tile(task, rect, tile_desc, &super);
 	}
 
 	if (!wait_render_tiles(cb))
@@ -226,15 +303,17 @@ synfig::Target_Tile::render_frame_(Canvas::Handle canvas, ContextParams context_
 
 bool
 synfig::Target_Tile::async_render_tile(
-	etl::handle<Canvas> canvas,
-	ContextParams context_params,
+	rendering::Task::Handle task,
 	RectInt rect,
 	RendDesc tile_desc,
 	ProgressCallback *cb)
 {
+	etl::clock tile_timer;
+	tile_timer.reset();
+
 	SurfaceResource::Handle surface = new rendering::SurfaceResource();
 
-	if (!call_renderer(surface, *canvas, context_params, tile_desc))
+	if (!call_renderer(surface, task, tile_desc))
 	{
 		// For some reason, the accelerated renderer failed.
 		if(cb)cb->error(_("Accelerated Renderer Failure"));
@@ -280,6 +359,11 @@ synfig::Target_Tile::async_render_tile(
 		return false;
 	}
 
+	{
+		std::lock_guard<std::mutex> lock(tile_costs_mutex_);
+		tile_costs_[std::make_pair(rect.minx, rect.miny)] = tile_timer();
+	}
+
 	signal_progress()();
 	return true;
 }
@@ -297,9 +381,7 @@ synfig::Target_Tile::render(ProgressCallback *cb)
 	SuperCallback super_cb;
 	int
 		frames=0,
-		total_frames,
-		frame_start,
-		frame_end;
+		total_frames;
 	Time
 		t=0;
 
@@ -311,14 +393,10 @@ synfig::Target_Tile::render(ProgressCallback *cb)
 		return false;
 	}
 
-	frame_start=desc.get_frame_start();
-	frame_end=desc.get_frame_end();
-
 	ContextParams context_params(desc.get_render_excluded_contexts());
 
 	// Calculate the number of frames
-	total_frames=frame_end-frame_start+1;
-	if(total_frames<=0)total_frames=1;
+	total_frames=get_total_frames();
 
 	try {
 
@@ -346,6 +424,7 @@ synfig::Target_Tile::render(ProgressCallback *cb)
 				if(!render_frame_(canvas, context_params, 0))
 					return false;
 				end_frame();
+				signal_frame_done()(get_frame_number());
 			}while(frames);
 			//synfig::info("tilerenderer: i=%d, t=%s",i,t.get_string().c_str());
 		}
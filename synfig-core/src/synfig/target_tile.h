@@ -29,6 +29,9 @@
 
 /* === H E A D E R S ======================================================= */
 
+#include <map>
+#include <mutex>
+
 #include "target.h"
 
 /* === M A C R O S ========================================================= */
@@ -41,7 +44,7 @@
 
 namespace synfig {
 
-namespace rendering { class SurfaceResource; }
+namespace rendering { class SurfaceResource; class Task; }
 
 /*!	\class Target_Tile
 **	\brief Render-target
@@ -63,12 +66,16 @@ class Target_Tile : public Target
 
 	String engine_;
 
+	//! Render time of each tile (by its position) in the previous frame,
+	//! used to schedule the most expensive tiles first
+	std::map<std::pair<int, int>, Real> tile_costs_;
+	std::mutex tile_costs_mutex_;
+
 	struct TileGroup;
 
 	bool call_renderer(
 		const etl::handle<rendering::SurfaceResource> &surface,
-		Canvas &canvas,
-		const ContextParams &context_params,
+		const etl::handle<rendering::Task> &task,
 		const RendDesc &renddesc );
 
 public:
@@ -81,9 +88,11 @@ public:
 	//! Renders the canvas to the target
 	virtual bool render(ProgressCallback *cb=NULL);
 
+	//! Renders the tile \a rect of the frame described by the \a task.
+	//! The task is built once per frame and shared between all tiles,
+	//! so it should not be modified.
 	virtual bool async_render_tile(
-		etl::handle<Canvas> canvas,
-		ContextParams context_params,
+		etl::handle<rendering::Task> task,
 		RectInt rect,
 		RendDesc tile_desc,
 		ProgressCallback *cb);
@@ -38,8 +38,15 @@
 #endif
 
 #include <cassert>
+#include <algorithm>
+#include <fstream>
 #include <sigc++/bind.h>
 
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#endif
+
 #include <synfig/localization.h>
 #include <synfig/general.h>
 
@@ -55,6 +62,87 @@ using namespace synfig;
 
 /* === G L O B A L S ======================================================= */
 
+namespace {
+	//! CPUs available to the process, ordered to alternate NUMA nodes
+	class Topology {
+	public:
+		std::vector<int> cpus;
+		std::vector<int> nodes;	//!< NUMA node of each entry of cpus
+		int nodes_count;
+		bool affinity;
+
+		//! parses lists like "0-7,16-23" from /sys/devices/system/node/node*/cpulist
+		static void parse_cpu_list(const std::string &s, std::vector<int> &out)
+		{
+			for(size_t pos = 0; pos < s.size(); ) {
+				size_t end = s.find(',', pos);
+				if (end == std::string::npos) end = s.size();
+				std::string range = s.substr(pos, end - pos);
+				size_t dash = range.find('-');
+				int first = atoi(range.c_str());
+				int last = dash == std::string::npos ? first : atoi(range.c_str() + dash + 1);
+				for(int i = first; i <= last; ++i) out.push_back(i);
+				pos = end + 1;
+			}
+		}
+
+		Topology(): nodes_count(1), affinity(false)
+		{
+			std::vector<int> available;
+			std::vector<int> cpu_nodes;
+			#ifdef __linux__
+			cpu_set_t set;
+			CPU_ZERO(&set);
+			if (!sched_getaffinity(0, sizeof(set), &set))
+				for(int i = 0; i < CPU_SETSIZE; ++i)
+					if (CPU_ISSET(i, &set)) available.push_back(i);
+
+			for(int node = 0; ; ++node) {
+				std::ifstream f(("/sys/devices/system/node/node" + std::to_string(node) + "/cpulist").c_str());
+				if (!f) break;
+				std::string line;
+				std::getline(f, line);
+				std::vector<int> list;
+				parse_cpu_list(line, list);
+				for(std::vector<int>::const_iterator i = list.begin(); i != list.end(); ++i) {
+					if (*i >= (int)cpu_nodes.size()) cpu_nodes.resize(*i + 1, 0);
+					cpu_nodes[*i] = node;
+				}
+			}
+			#endif
+
+			if (available.empty())
+				for(int i = 0; i < (int)std::thread::hardware_concurrency(); ++i)
+					available.push_back(i);
+
+			// take CPUs from each node in turn
+			std::vector<std::vector<int> > by_node;
+			for(std::vector<int>::const_iterator i = available.begin(); i != available.end(); ++i) {
+				int node = *i < (int)cpu_nodes.size() ? cpu_nodes[*i] : 0;
+				if (node >= (int)by_node.size()) by_node.resize(node + 1);
+				by_node[node].push_back(*i);
+			}
+			for(size_t j = 0; cpus.size() < available.size(); ++j)
+				for(int node = 0; node < (int)by_node.size(); ++node)
+					if (j < by_node[node].size())
+						{ cpus.push_back(by_node[node][j]); nodes.push_back(node); }
+			nodes_count = std::max(1, (int)by_node.size());
+
+			if (const char *s = getenv("SYNFIG_THREAD_AFFINITY"))
+				affinity = atoi(s) != 0;
+		}
+	};
+
+	const Topology& get_topology()
+	{
+		static Topology topology;
+		return topology;
+	}
+
+	thread_local int thread_node = 0;
+	std::atomic<int> cpu_count_override(0);
+}
+
 /* === M E T H O D S ======================================================= */
 
 ThreadPool* ThreadPool::instance_ = 0;
@@ -63,17 +151,22 @@ ThreadPool* ThreadPool::instance_ = 0;
 // ThreadPool::Group
 
 ThreadPool::Group::Group():
-	multithreading(), running_threads(0), sum_weight() { }
+	sum_weight() { }
 
 ThreadPool::Group::~Group()
 	{ run(); }
 
 void
-ThreadPool::Group::process(int begin, int end) {
-	for(int i = begin; i < end; ++i)
-		try { tasks[i].second(); } catch(...) { }
-	std::lock_guard<std::mutex> lock(mutex);
-	if (!--running_threads) cond.notify_one();
+ThreadPool::Group::process(std::shared_ptr<Shared> shared) {
+	Shared &s = *shared;
+	int done = 0;
+	for(int i; (i = s.next++) < s.count; ++done)
+		try { s.tasks[i].second(); } catch(...) { }
+	if (done) {
+		std::lock_guard<std::mutex> lock(s.mutex);
+		s.finished += done;
+		if (s.finished == s.count) s.cond.notify_all();
+	}
 }
 
 void
@@ -85,46 +178,34 @@ ThreadPool::Group::enqueue(const Slot &slot, Real weight) {
 
 void
 ThreadPool::Group::run(bool force_thread) {
-	// enqueue parallel tasks
-	Real sum = 0.0;
-	int begin = 0;
-	int end = 0;
-
-	for(int i = 0; i < (int)tasks.size(); ++i) {
-		end = i + 1;
-		sum += tasks[i].first;
-		if (sum_weight - sum < 0.75) break;
-		if (sum >= 0.75) {
-			multithreading = true;
-			++running_threads;
-			instance().enqueue( sigc::bind( sigc::mem_fun(this, &Group::process), begin, end ));
-			sum_weight -= sum;
-			sum = 0.0;
-			begin = end;
-		}
-	}
-	end = (int)tasks.size();
-
-	// run in current thread
-	if (begin < end) {
-		if (force_thread) {
-			multithreading = true;
-			++running_threads;
-			instance().enqueue( sigc::bind( sigc::mem_fun(this, &Group::process), begin, end ));
-		} else {
-			for(int i = begin; i < end; ++i)
-				tasks[i].second();
+	const int count = (int)tasks.size();
+
+	// each helper should have at least 0.75 of weight to do
+	int helpers = std::min(count, instance().get_max_threads()) - 1;
+	helpers = std::min(helpers, (int)(sum_weight/0.75) - 1);
+	if (force_thread && count > 0) helpers = std::max(helpers + 1, 1);
+
+	if (helpers <= 0) {
+		for(List::iterator i = tasks.begin(); i != tasks.end(); ++i)
+			i->second();
+	} else {
+		std::shared_ptr<Shared> shared = std::make_shared<Shared>();
+		shared->tasks.swap(tasks);
+		shared->count = count;
+		for(int i = 0; i < helpers; ++i)
+			instance().enqueue( sigc::bind(sigc::ptr_fun(&Group::process), shared) );
+
+		// take part in work, then wait for slots taken by helpers
+		if (!force_thread)
+			process(shared);
+		{
+			std::unique_lock<std::mutex> lock(shared->mutex);
+			while(shared->finished < count) instance().wait(shared->cond, lock);
 		}
-	}
-
-	// wait
-	if (multithreading) {
-		std::unique_lock<std::mutex> lock(mutex);
-		while(running_threads > 0) instance().wait(cond, lock);
+		shared->tasks.clear();
 	}
 
 	// reset
-	multithreading = false;
 	tasks.clear();
 	sum_weight = 0.0;
 }
@@ -140,7 +221,7 @@ ThreadPool::ThreadPool():
 	queue_size(0),
 	stopped(false)
 {
-	max_running_threads = std::thread::hardware_concurrency();
+	max_running_threads = get_cpu_count();
 
 	if (const char *s = getenv("SYNFIG_GENERIC_THREADS"))
 		max_running_threads = atoi(s) + 1;
@@ -277,7 +358,7 @@ ThreadPool::enqueue(const Slot &slot) {
 
 void 
 ThreadPool::set_num_threads(int num_threads){
-	max_running_threads = std::thread::hardware_concurrency();
+	max_running_threads = get_cpu_count();
 	if(num_threads!=0){
 		max_running_threads = num_threads;
 	}
@@ -296,6 +377,47 @@ ThreadPool::wait(std::condition_variable &cond, std::unique_lock<std::mutex> &lo
 	++running_threads;
 }
 
+int
+ThreadPool::get_cpu_count() {
+	if (int count = cpu_count_override)
+		return count;
+	if (const char *s = getenv("SYNFIG_THREADS"))
+		if (int count = atoi(s))
+			return std::max(1, count);
+	return std::max(1, (int)get_topology().cpus.size());
+}
+
+void
+ThreadPool::set_cpu_count(int count)
+	{ cpu_count_override = std::max(0, count); }
+
+int
+ThreadPool::get_nodes_count()
+	{ return get_topology().nodes_count; }
+
+void
+ThreadPool::bind_thread(int index) {
+	const Topology &topology = get_topology();
+	if (!topology.affinity || topology.cpus.empty() || index < 0)
+		return;
+	index %= (int)topology.cpus.size();
+
+	#ifdef __linux__
+	cpu_set_t set;
+	CPU_ZERO(&set);
+	CPU_SET(topology.cpus[index], &set);
+	if (pthread_setaffinity_np(pthread_self(), sizeof(set), &set)) {
+		warning("ThreadPool: cannot bind thread to CPU %d", topology.cpus[index]);
+		return;
+	}
+	thread_node = topology.nodes[index];
+	#endif
+}
+
+int
+ThreadPool::get_thread_node()
+	{ return thread_node; }
+
 ThreadPool&
 ThreadPool::instance() {
 	assert(instance_);
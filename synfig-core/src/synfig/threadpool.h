@@ -28,6 +28,7 @@
 /* === H E A D E R S ======================================================= */
 
 #include <atomic>
+#include <memory>
 #include <queue>
 
 #include <sigc++/signal.h>
@@ -49,21 +50,29 @@ class ThreadPool {
 public:
 	typedef sigc::slot<void> Slot;
 
+	//! Runs slots in parallel, each free thread takes the next not yet started slot,
+	//! so long slots don't hold back the others
 	class Group {
 	public:
 	typedef std::pair<Real, Slot> Entry;
 	typedef std::vector<Entry> List;
 
 	private:
-		bool multithreading;
-		std::atomic<int> running_threads;
-		std::mutex mutex;
-		std::condition_variable cond;
+		//! Shared with helper threads, helper which starts after run() returns finds nothing to do
+		struct Shared {
+			List tasks;
+			int count;
+			std::atomic<int> next;
+			int finished;
+			std::mutex mutex;
+			std::condition_variable cond;
+			Shared(): count(), next(0), finished() { }
+		};
 
 		List tasks;
 		Real sum_weight;
 
-		void process(int begin, int end);
+		static void process(std::shared_ptr<Shared> shared);
 	public:
 		Group();
 		~Group();
@@ -107,6 +116,20 @@ public:
 	int get_queue_size() const
 		{ return queue_size + running_threads; }
 
+	//! Count of CPUs available to the process, default count of threads of ThreadPool and RenderQueue.
+	//! May be overridden by SYNFIG_THREADS environment variable
+	static int get_cpu_count();
+	//! Overrides count of CPUs for the whole process, zero restores the default.
+	//! Thread pools take it when created, so it should be set before synfig::Main is created
+	static void set_cpu_count(int count);
+	//! Count of NUMA nodes with CPUs available to the process
+	static int get_nodes_count();
+	//! Pins the current thread to one CPU if SYNFIG_THREAD_AFFINITY environment variable is set,
+	//! threads with successive indices are spread over NUMA nodes
+	static void bind_thread(int index);
+	//! NUMA node of the current thread, always 0 for threads which are not bound
+	static int get_thread_node();
+
 	static ThreadPool& instance();
 	static bool subsys_init();
 	static bool subsys_stop();
@@ -56,6 +56,8 @@ SynfigToolGeneralOptions::SynfigToolGeneralOptions(const char* argv0)
 	_should_be_quiet = false;
 	_should_print_benchmarks = false;
 	_threads = 1;
+	_jobs = 1;
+	_memory_limit = 0;
 }
 
 std::string SynfigToolGeneralOptions::get_binary_path() const
@@ -73,6 +75,36 @@ void SynfigToolGeneralOptions::set_threads(size_t threads)
 	_threads = threads;
 }
 
+size_t SynfigToolGeneralOptions::get_jobs() const
+{
+	return _jobs;
+}
+
+void SynfigToolGeneralOptions::set_jobs(size_t jobs)
+{
+	_jobs = jobs;
+}
+
+size_t SynfigToolGeneralOptions::get_memory_limit() const
+{
+	return _memory_limit;
+}
+
+void SynfigToolGeneralOptions::set_memory_limit(size_t memory_limit)
+{
+	_memory_limit = memory_limit;
+}
+
+std::string SynfigToolGeneralOptions::get_trace_file() const
+{
+	return _trace_file;
+}
+
+void SynfigToolGeneralOptions::set_trace_file(const std::string &trace_file)
+{
+	_trace_file = trace_file;
+}
+
 int SynfigToolGeneralOptions::get_verbosity() const
 {
 	return _verbosity;
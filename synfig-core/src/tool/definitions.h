@@ -89,6 +89,18 @@ public:
 
 	void set_threads(size_t threads);
 
+	size_t get_jobs() const;
+
+	void set_jobs(size_t jobs);
+
+	size_t get_memory_limit() const;
+
+	void set_memory_limit(size_t memory_limit);
+
+	std::string get_trace_file() const;
+
+	void set_trace_file(const std::string &trace_file);
+
 	int get_verbosity() const;
 
 	void set_verbosity(int verbosity);
@@ -107,6 +119,9 @@ private:
 	std::string _binary_path;
 	int _verbosity;
 	size_t _threads;
+	size_t _jobs;
+	size_t _memory_limit;
+	std::string _trace_file;
 	bool _should_be_quiet,
 		 _should_print_benchmarks;
 
@@ -0,0 +1,148 @@
+/* === S Y N F I G ========================================================= */
+/*!	\file tool/frameselection.cpp
+**	\brief Shards, manifests and other helpers which select frames to render
+**
+**	$Id$
+**
+**	\legal
+**	......... ... 2026 Synfig contributors
+**
+**	This package is free software; you can redistribute it and/or
+**	modify it under the terms of the GNU General Public License as
+**	published by the Free Software Foundation; either version 2 of
+**	the License, or (at your option) any later version.
+**
+**	This package is distributed in the hope that it will be useful,
+**	but WITHOUT ANY WARRANTY; without even the implied warranty of
+**	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+**	General Public License for more details.
+**	\endlegal
+*/
+/* ========================================================================= */
+
+#ifdef USING_PCH
+#	include "pch.h"
+#else
+#ifdef HAVE_CONFIG_H
+#	include <config.h>
+#endif
+
+#include <algorithm>
+#include <cstdlib>
+
+#include <ETL/stringf>
+
+#include <synfig/general.h>
+#include <synfig/localization.h>
+
+#include "frameselection.h"
+
+#include <glib/gstdio.h>
+
+#endif
+
+size_t parse_memory_size(const std::string& str)
+{
+	char *end = NULL;
+	double value = strtod(str.c_str(), &end);
+	if (end == str.c_str() || value <= 0.0)
+		return 0;
+
+	switch(*end)
+	{
+		case 'k': case 'K': value *= 1024.0; ++end; break;
+		case 'm': case 'M': value *= 1024.0*1024.0; ++end; break;
+		case 'g': case 'G': value *= 1024.0*1024.0*1024.0; ++end; break;
+		case 't': case 'T': value *= 1024.0*1024.0*1024.0*1024.0; ++end; break;
+	}
+	if (*end == 'b' || *end == 'B') ++end;
+	return *end ? 0 : (size_t)value;
+}
+
+bool get_shard_range(int frame_start, int frame_end, int shard_index, int shard_count, int& first, int& last)
+{
+	frame_end = std::max(frame_start, frame_end);
+	int count = frame_end - frame_start + 1;
+	first = frame_start + (int)((long long)count*(shard_index - 1)/shard_count);
+	last  = frame_start + (int)((long long)count*shard_index/shard_count) - 1;
+	return first <= last;
+}
+
+void get_shard_frames(
+	int frame_start, int frame_end, int shard_index, int shard_count, bool interleaved,
+	std::vector<int>& frames )
+{
+	frames.clear();
+	frame_end = std::max(frame_start, frame_end);
+	if (interleaved)
+	{
+		for(int frame = frame_start + shard_index - 1; frame <= frame_end; frame += shard_count)
+			frames.push_back(frame);
+		return;
+	}
+
+	int first, last;
+	if (get_shard_range(frame_start, frame_end, shard_index, shard_count, first, last))
+		for(int frame = first; frame <= last; ++frame)
+			frames.push_back(frame);
+}
+
+std::string get_frame_filename(const std::string& filename, const std::string& sequence_separator, int frame)
+{
+	return etl::filename_sans_extension(filename)
+	     + sequence_separator
+	     + etl::strprintf("%04d", frame)
+	     + etl::filename_extension(filename);
+}
+
+void read_manifest(const std::string& filename, std::set<int>& frames)
+{
+	if (FILE *file = g_fopen(filename.c_str(), "r"))
+	{
+		int frame;
+		while(fscanf(file, "%d", &frame) == 1)
+			frames.insert(frame);
+		fclose(file);
+	}
+}
+
+size_t skip_done_frames(
+	std::vector<int>& frames, const std::set<int>& done,
+	const std::string& filename, const std::string& sequence_separator )
+{
+	// frame is valid when it is recorded as done and its file is still there
+	std::vector<int> left;
+	for(std::vector<int>::const_iterator i = frames.begin(); i != frames.end(); ++i)
+	{
+		GStatBuf buf;
+		if ( !done.count(*i)
+		  || g_stat(get_frame_filename(filename, sequence_separator, *i).c_str(), &buf) != 0
+		  || buf.st_size <= 0 )
+			left.push_back(*i);
+	}
+
+	size_t skipped = frames.size() - left.size();
+	frames.swap(left);
+	return skipped;
+}
+
+std::mutex FrameManifest::mutex;
+
+FrameManifest::FrameManifest(const std::string& filename):
+	file(g_fopen(filename.c_str(), "a"))
+{
+	if (!file)
+		synfig::warning(_("Unable to write manifest \"%s\""), filename.c_str());
+}
+
+FrameManifest::~FrameManifest()
+	{ if (file) fclose(file); }
+
+void
+FrameManifest::on_frame_done(int frame)
+{
+	if (!file) return;
+	std::lock_guard<std::mutex> lock(mutex);
+	fprintf(file, "%d\n", frame);
+	fflush(file);
+}
@@ -0,0 +1,74 @@
+/* === S Y N F I G ========================================================= */
+/*!	\file tool/frameselection.h
+**	\brief Shards, manifests and other helpers which select frames to render
+**
+**	$Id$
+**
+**	\legal
+**	......... ... 2026 Synfig contributors
+**
+**	This package is free software; you can redistribute it and/or
+**	modify it under the terms of the GNU General Public License as
+**	published by the Free Software Foundation; either version 2 of
+**	the License, or (at your option) any later version.
+**
+**	This package is distributed in the hope that it will be useful,
+**	but WITHOUT ANY WARRANTY; without even the implied warranty of
+**	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+**	General Public License for more details.
+**	\endlegal
+*/
+/* ========================================================================= */
+
+#ifndef __SYNFIG_FRAMESELECTION_H
+#define __SYNFIG_FRAMESELECTION_H
+
+#include <cstdio>
+#include <mutex>
+#include <set>
+#include <string>
+#include <vector>
+
+#include <sigc++/trackable.h>
+
+/// Parses size like "8G", "512M", "100k" or plain bytes, returns zero on error
+size_t parse_memory_size(const std::string& str);
+
+/// Contiguous part of the frame range [frame_start, frame_end]
+/// taken by 1-based shard_index of shard_count shards
+/// \return false if the shard has no frames
+bool get_shard_range(int frame_start, int frame_end, int shard_index, int shard_count, int& first, int& last);
+
+/// Fills \a frames by the frames of the shard, shards don't overlap and cover the whole range
+void get_shard_frames(
+	int frame_start, int frame_end, int shard_index, int shard_count, bool interleaved,
+	std::vector<int>& frames );
+
+/// Name of the file where the target writes the frame of image sequence
+std::string get_frame_filename(const std::string& filename, const std::string& sequence_separator, int frame);
+
+/// Adds numbers of frames recorded in the manifest to \a frames,
+/// missing manifest has no frames
+void read_manifest(const std::string& filename, std::set<int>& frames);
+
+/// Removes from \a frames the frames which are recorded as \a done and whose files are still there
+/// \return count of removed frames
+size_t skip_done_frames(
+	std::vector<int>& frames, const std::set<int>& done,
+	const std::string& filename, const std::string& sequence_separator );
+
+/// Appends numbers of completed frames to the manifest of image sequence,
+/// parts of the split job share the manifest
+class FrameManifest: public sigc::trackable
+{
+	static std::mutex mutex;
+	FILE *file;
+
+public:
+	explicit FrameManifest(const std::string& filename);
+	~FrameManifest();
+
+	void on_frame_done(int frame);
+};
+
+#endif // __SYNFIG_FRAMESELECTION_H
@@ -24,6 +24,7 @@
 
 #ifndef __SYNFIG_JOB_H
 #define __SYNFIG_JOB_H
+#include <vector>
 #include "synfig/target.h"
 
 struct Job
@@ -31,6 +32,8 @@ struct Job
 	std::string filename;
 	std::string outfilename;
 	std::string target_name;
+	std::string canvas_id;       ///< canvas given by --canvas, empty for the root canvas
+	std::string append_filename; ///< composition appended by --append, if any
 
 	synfig::RendDesc desc;
 	synfig::TargetAlphaMode alpha_mode;
@@ -41,6 +44,13 @@ struct Job
 
 	int quality;
 	bool sifout;
+
+	int shard_index;         ///< 1-based index of the shard to render
+	int shard_count;         ///< count of the shards, frame range is not split when 1
+	bool shard_interleaved;  ///< shard takes every shard_count-th frame instead of contiguous range
+	bool resume;             ///< skip frames recorded in the manifest of image sequence
+	bool frames_selected;    ///< shard and resume are already applied to frame_list
+	std::vector<int> frame_list; ///< frames to render, empty for the whole range of desc
 	bool list_canvases;
 	bool extract_alpha;
 
@@ -77,6 +87,11 @@ struct Job
 		alpha_mode(synfig::TARGET_ALPHA_MODE_KEEP),
 		quality(DEFAULT_QUALITY),
 		sifout(false),
+		shard_index(1),
+		shard_count(1),
+		shard_interleaved(false),
+		resume(false),
+		frames_selected(false),
 		list_canvases(),
 		extract_alpha(false),
 		canvas_info(),
@@ -31,11 +31,18 @@
 
 #include <iostream>
 #include <list>
+#include <set>
 #include <algorithm>
 #include <errno.h>
 #include <cstring>
 
+#include <atomic>
 #include <chrono>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
 
 #include <autorevision.h>
 #include <synfig/general.h>
@@ -44,13 +51,19 @@
 #include <synfig/target_scanline.h>
 #include <synfig/importer.h>
 #include <synfig/savecanvas.h>
+#include <synfig/loadcanvas.h>
+#include <synfig/canvasfilenaming.h>
 #include <synfig/filesystemnative.h>
+#include <synfig/rendering/software/surfacesw.h>
+
+#include <sigc++/trackable.h>
 
 #include "definitions.h"
 #include "job.h"
 #include "synfigtoolexception.h"
 #include "renderprogress.h"
 #include "joblistprocessor.h"
+#include "frameselection.h"
 
 #include <giomm/file.h>
 #include <glib/gstdio.h>
@@ -64,16 +77,229 @@
 
 using namespace synfig;
 
+/// Jobs which render the same canvas, they can't run concurrently
+typedef std::vector<Job*> JobGroup;
+
+/// Whether the target writes every frame into separate file,
+/// so frame range of the job may be rendered in independent parts
+static bool is_sequence_target(const std::string& target_name)
+{
+	static const char* names[] = { "png", "jpeg", "bmp", "ppm", "openexr", "imagemagick" };
+	for(size_t i = 0; i < sizeof(names)/sizeof(names[0]); ++i)
+		if (target_name == names[i])
+			return true;
+	return false;
+}
+
+/// Loads own copy of the canvas of the job
+static bool reload_canvas(Job& job)
+{
+	std::string errors, warnings;
+	try
+	{
+		job.root = nullptr;
+		if (FileSystem::Handle file_system = CanvasFileNaming::make_filesystem(job.filename))
+		{
+			FileSystem::Identifier identifier = file_system->get_identifier(CanvasFileNaming::project_file(job.filename));
+			job.root = open_canvas_as(identifier, job.filename, errors, warnings);
+		}
+		if (!job.root)
+			return false;
+		job.canvas = job.canvas_id.empty() ? job.root : job.root->find_canvas(job.canvas_id, warnings);
+	}
+	catch(...)
+	{
+		return false;
+	}
+
+	job.root->set_time(0);
+	job.canvas->rend_desc() = job.desc;
+	return true;
+}
+
+/// Whether the job writes image sequence, i.e. file per frame
+static bool is_sequence_job(const Job& job)
+{
+	return !job.sifout
+	    && job.desc.get_frame_end() > job.desc.get_frame_start()
+	    && is_sequence_target(job.target_name);
+}
+
+/// Name of the file which lists completed frames of image sequence,
+/// each shard writes own file, so shards rendered simultaneously don't mix their records
+static std::string get_manifest_filename(const Job& job, int shard_index)
+{
+	if (job.shard_count <= 1)
+		return job.outfilename + ".manifest";
+	return job.outfilename + etl::strprintf(".manifest.shard-%d-of-%d", shard_index, job.shard_count);
+}
+
+static std::string get_manifest_filename(const Job& job)
+	{ return get_manifest_filename(job, job.shard_index); }
+
+/// Applies --shard and --resume to the frame range of the job
+/// \return false if there is nothing to render
+static bool select_frames(Job& job, const TargetParam& target_params)
+{
+	job.frames_selected = true;
+	job.frame_list.clear();
+
+	int frame_start = job.desc.get_frame_start();
+	int frame_end = job.desc.get_frame_end();
+
+	if (!is_sequence_job(job))
+	{
+		// single output file, so just narrow the frame range
+		if (job.shard_count <= 1)
+			return true;
+		if (job.shard_interleaved)
+			synfig::warning(_("Target \"%s\" doesn't write image sequence, using contiguous shards"), job.target_name.c_str());
+		int first, last;
+		if (!get_shard_range(frame_start, frame_end, job.shard_index, job.shard_count, first, last))
+			return false;
+		job.desc.set_frame_start(first);
+		job.desc.set_frame_end(last);
+		job.canvas->rend_desc() = job.desc;
+		return true;
+	}
+
+	// records of the previous run are not valid for the new one
+	if (!job.resume)
+		if (FILE *file = g_fopen(get_manifest_filename(job).c_str(), "w"))
+			fclose(file);
+
+	// Image sequence keeps the whole frame range, so files are numbered as usual,
+	// and only the listed frames are rendered
+	if (job.shard_count <= 1 && !job.resume)
+		return true;
+
+	get_shard_frames(frame_start, frame_end, job.shard_index, job.shard_count, job.shard_interleaved, job.frame_list);
+
+	if (job.resume)
+	{
+		// merge manifests of all shards of the same split,
+		// so frames may be taken over from the other shard
+		std::set<int> done;
+		for(int shard = 1; shard <= job.shard_count; ++shard)
+			read_manifest(get_manifest_filename(job, shard), done);
+
+		size_t skipped = skip_done_frames(job.frame_list, done, job.outfilename, target_params.sequence_separator);
+		VERBOSE_OUT(1) << job.outfilename << _(": frames already done: ")
+					   << skipped << std::endl;
+	}
+
+	return !job.frame_list.empty();
+}
+
+/// Splits frames of the prepared job into several jobs,
+/// each part renders own copy of the canvas
+static void split_job(Job& job, const TargetParam& target_params, size_t parts, std::list<Job>& out)
+{
+	if ( parts <= 1
+	  || !job.append_filename.empty()
+	  || !is_sequence_job(job) )
+		{ out.push_back(job); return; }
+
+	std::vector<int> frames = job.frame_list;
+	if (frames.empty())
+		for(int frame = job.desc.get_frame_start(); frame <= job.desc.get_frame_end(); ++frame)
+			frames.push_back(frame);
+	parts = std::min(parts, frames.size());
+
+	// parts keep the whole frame range and render own subsets of frames
+	std::list<Job> parts_list;
+	for(size_t i = 0; i < parts; ++i)
+	{
+		Job part = job;
+		part.target = nullptr;
+		part.frame_list.assign(
+			frames.begin() + i*frames.size()/parts,
+			frames.begin() + (i + 1)*frames.size()/parts );
+		if (!reload_canvas(part) || !setup_job(part, target_params))
+		{
+			synfig::warning(_("Unable to split job for \"%s\", rendering it as a whole"), job.filename.c_str());
+			out.push_back(job);
+			return;
+		}
+		parts_list.push_back(part);
+	}
+
+	VERBOSE_OUT(2) << job.filename << _(": frames split into ") << parts << _(" parts") << std::endl;
+	out.splice(out.end(), parts_list);
+}
+
+static void process_job_groups(
+	std::vector<JobGroup>& groups,
+	std::atomic<size_t>& next_group,
+	std::mutex& mutex,
+	std::exception_ptr& error )
+{
+	for(size_t i = next_group++; i < groups.size(); i = next_group++)
+	{
+		try
+		{
+			for(JobGroup::iterator j = groups[i].begin(); j != groups[i].end(); ++j)
+				process_job(**j);
+		}
+		catch(...)
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			if (!error)
+				error = std::current_exception();
+			next_group = groups.size(); // don't start other jobs
+		}
+	}
+}
+
 void process_job_list(std::list<Job>& job_list, const TargetParam& target_params)
 {
 	if (job_list.empty())
 		throw (SynfigToolException(SYNFIGTOOL_BORED, _("Nothing to do!")));
 
-	for(; !job_list.empty(); job_list.pop_front())
+	size_t jobs = SynfigToolGeneralOptions::instance()->get_jobs();
+	if (jobs <= 1)
 	{
+		for(; !job_list.empty(); job_list.pop_front())
+		{
+			if (setup_job(job_list.front(), target_params))
+				process_job(job_list.front());
+		}
+		return;
+	}
+
+	// Loading of canvases and creation of targets are not thread-safe,
+	// so all of the jobs are prepared here before rendering starts
+	std::list<Job> ready_list;
+	for(; !job_list.empty(); job_list.pop_front())
 		if (setup_job(job_list.front(), target_params))
-			process_job(job_list.front());
+			split_job(job_list.front(), target_params, jobs, ready_list);
+
+	// jobs with the same canvas reuse the loaded canvas one by one
+	std::vector<JobGroup> groups;
+	for(std::list<Job>::iterator i = ready_list.begin(); i != ready_list.end(); ++i)
+	{
+		std::vector<JobGroup>::iterator g = groups.begin();
+		while(g != groups.end() && g->front()->canvas != i->canvas) ++g;
+		if (g == groups.end())
+			groups.push_back(JobGroup(1, &*i));
+		else
+			g->push_back(&*i);
 	}
+
+	std::atomic<size_t> next_group(0);
+	std::mutex mutex;
+	std::exception_ptr error;
+
+	std::vector<std::thread> threads;
+	for(size_t i = 1; i < std::min(jobs, groups.size()); ++i)
+		threads.push_back(std::thread(process_job_groups,
+			std::ref(groups), std::ref(next_group), std::ref(mutex), std::ref(error) ));
+	process_job_groups(groups, next_group, mutex, error);
+	for(std::vector<std::thread>::iterator i = threads.begin(); i != threads.end(); ++i)
+		i->join();
+
+	if (error)
+		std::rethrow_exception(error);
 }
 
 std::string get_extension(const std::string &filename)
@@ -197,12 +423,20 @@ bool setup_job(Job& job, const TargetParam& target_parameters)
 		job.sifout=false;
 	}
 
+	if (!job.frames_selected && !select_frames(job, target_parameters))
+	{
+		synfig::info(_("Nothing to render for \"%s\", all of the frames are done"), job.outfilename.c_str());
+		return false;
+	}
+
 	// Set the Canvas on the Target
 	if(job.target)
 	{
 		VERBOSE_OUT(4) << _("Setting the canvas on the target...") << std::endl;
 		job.target->set_canvas(job.canvas);
 
+		job.target->set_frame_list(job.frame_list);
+
 		VERBOSE_OUT(4) << _("Setting the quality of the target...") << std::endl;
 		job.target->set_quality(job.quality);
 
@@ -217,6 +451,9 @@ bool setup_job(Job& job, const TargetParam& target_parameters)
 	if (job.target && Target_Scanline::Handle::cast_dynamic(job.target))
 		Target_Scanline::Handle::cast_dynamic(job.target)->set_threads(SynfigToolGeneralOptions::instance()->get_threads());
 
+	if (job.target)
+		job.target->set_memory_limit(SynfigToolGeneralOptions::instance()->get_memory_limit());
+
 	return true;
 }
 
@@ -267,10 +504,26 @@ void process_job (Job& job)
 		std::chrono::system_clock::time_point start_timepoint =
             std::chrono::system_clock::now();
 
+		// jobs may be rendered concurrently, so each job has own meter
+		rendering::MemoryMeter::Handle memory_meter = new rendering::MemoryMeter();
+		rendering::MemoryMeter::Scope memory_scope(memory_meter);
+
+		std::unique_ptr<FrameManifest> manifest;
+		if (is_sequence_job(job))
+		{
+			manifest.reset(new FrameManifest(get_manifest_filename(job)));
+			job.target->signal_frame_done().connect(
+				sigc::mem_fun(*manifest, &FrameManifest::on_frame_done) );
+		}
+
 		// Call the render member of the target
 		if(!job.target->render(&p))
 			throw (SynfigToolException(SYNFIGTOOL_RENDERFAILURE, _("Render Failure.")));
 
+		VERBOSE_OUT(1) << _("Peak memory of rendered surfaces: ")
+					   << memory_meter->get_peak()/(1024*1024)
+					   << _(" MiB") << std::endl;
+
 		if(SynfigToolGeneralOptions::instance()->should_print_benchmarks())
         {
             std::chrono::duration<double> duration =
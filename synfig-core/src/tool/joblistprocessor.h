@@ -30,6 +30,7 @@
 #include "job.h"
 
 /// Process a Job list setting up and processing each job
+/// (several jobs at once when --jobs is given)
 void process_job_list(std::list<Job>& job_list,
 						const synfig::TargetParam& target_parameters);
 
@@ -46,6 +46,8 @@
 #include <synfig/target.h>
 #include <synfig/paramdesc.h>
 #include <synfig/main.h>
+#include <synfig/debug/trace.h>
+#include <synfig/rendering/renderer.h>
 #include <autorevision.h>
 #include "definitions.h"
 #include "progress.h"
@@ -294,6 +296,12 @@ int main(int argc, char* argv[])
 
 		process_job_list(job_list, parser.extract_targetparam());
 
+		std::string trace_file = SynfigToolGeneralOptions::instance()->get_trace_file();
+		if (!trace_file.empty()) {
+			synfig::rendering::Renderer::trace_optimizers();
+			synfig::debug::Trace::save(trace_file);
+		}
+
 		return SYNFIGTOOL_OK;
 
     }
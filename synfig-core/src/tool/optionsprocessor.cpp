@@ -29,6 +29,7 @@
 #	include <config.h>
 #endif
 
+#include <cstdio>
 #include <iostream>
 
 #include <autorevision.h>
@@ -44,6 +45,8 @@
 #include <synfig/loadcanvas.h>
 #include <synfig/valuenode_registry.h>
 #include <synfig/filesystemgroup.h>
+#include <synfig/debug/trace.h>
+#include <synfig/threadpool.h>
 #include <synfig/filesystemnative.h>
 #include <synfig/filecontainerzip.h>
 
@@ -52,6 +55,7 @@
 #include "synfigtoolexception.h"
 #include "printing_functions.h"
 #include "optionsprocessor.h"
+#include "frameselection.h"
 #include <glibmm/init.h>
 #endif
 
@@ -96,6 +100,9 @@ SynfigCommandLineParser::SynfigCommandLineParser() :
 	set_antialias(),
 	set_quality(),
 	set_num_threads(),
+	set_num_jobs(),
+	set_memory_limit(),
+	set_trace_file(),
 	set_input_file(),
 	set_output_file(),
 	set_sequence_separator(),
@@ -105,6 +112,8 @@ SynfigCommandLineParser::SynfigCommandLineParser() :
 	set_begin_time(),
 	set_start_time(),
 	set_end_time(),
+	set_shard(),
+	set_shard_mode(),
 	set_dpi(),
 	set_dpi_x(),
 	set_dpi_y(),
@@ -114,6 +123,7 @@ SynfigCommandLineParser::SynfigCommandLineParser() :
 	sw_quiet(),
 	sw_print_benchmarks(),
 	sw_extract_alpha(),
+	sw_resume(),
 
 	// Misc group
 	misc_append_filename(),
@@ -154,6 +164,9 @@ SynfigCommandLineParser::SynfigCommandLineParser() :
 	add_option(og_set, "antialias",   'a', set_antialias,	_("Set antialias amount for parametric renderer."), "1..30");
 	//og_set.add_option("quality",     'Q', quality_arg_desc, etl::strprintf(_("Specify image quality for accelerated renderer (Default: %d)"), DEFAULT_QUALITY).c_str(), "NUM");
 	add_option(og_set, "threads",     'T', set_num_threads, _("Enable multithreaded renderer using the specified number of threads"), "NUM");
+	add_option(og_set, "jobs",        'j', set_num_jobs,	_("Render the specified number of jobs (or parts of image sequences) concurrently, jobs share the render threads"), "NUM");
+	add_option(og_set, "memory-limit", ' ', set_memory_limit, _("Limit memory used to render a frame, e.g. 512M or 8G (large images are rendered by stripes)"), "SIZE");
+	add_option_filename(og_set, "trace", ' ', set_trace_file, _("Write timeline of render threads to file in Chrome trace event format"), _("filename"));
 	add_option(og_set, "input-file",  'i', set_input_file, 	_("Specify input filename"), "filename");
 	add_option(og_set, "output-file", 'o', set_output_file, _("Specify output filename"), "filename");
 	add_option(og_set, "sequence-separator", ' ', set_sequence_separator, _("Output file sequence separator string (Use double quotes if you want to use spaces)"), "string");
@@ -163,6 +176,8 @@ SynfigCommandLineParser::SynfigCommandLineParser() :
 	add_option(og_set, "begin-time",  ' ', set_begin_time, 	_("Set the starting time"), "seconds");
 	add_option(og_set, "start-time",  ' ', set_start_time,	_("Set the starting time"), "seconds");
 	add_option(og_set, "end-time",    ' ', set_end_time, 	_("Set the ending time"), "seconds");
+	add_option(og_set, "shard",       ' ', set_shard,		_("Render only the i-th of n parts of the frame range"), "i/n");
+	add_option(og_set, "shard-mode",  ' ', set_shard_mode,	_("Split frames into shards by contiguous ranges (default) or interleaved"), "contiguous|interleaved");
 	add_option(og_set, "dpi",         ' ', set_dpi, 		_("Set the physical resolution (Dots-per-inch)"), "NUM");
 	add_option(og_set, "dpi-x",       ' ', set_dpi_x, 		_("Set the physical X resolution (Dots-per-inch)"), "NUM");
 	add_option(og_set, "dpi-y",       ' ', set_dpi_y, 		_("Set the physical Y resolution (Dots-per-inch)"), "NUM");
@@ -173,6 +188,7 @@ SynfigCommandLineParser::SynfigCommandLineParser() :
 	add_option(og_switch, "quiet",         'q', sw_quiet, 				_("Quiet mode (No progress/time-remaining display)"), "");
 	add_option(og_switch, "benchmarks",    'b', sw_print_benchmarks,	_("Print benchmarks"), "");
 	add_option(og_switch, "extract-alpha", 'x', sw_extract_alpha, 		_("Extract alpha"), "");
+	add_option(og_switch, "resume",        ' ', sw_resume, 				_("Skip frames of image sequence already recorded as done in its manifest"), "");
 
 	//SynfigOptionGroup og_misc("misc", _("Misc options"), "Show Misc options help");
 	add_option_filename(og_misc, "append", ' ', misc_append_filename, 	_("Append layers in <filename> to composition"), _("filename"));
@@ -354,10 +370,36 @@ void SynfigCommandLineParser::process_settings_options() const
 	if (set_num_threads > 0)
 	{
 		SynfigToolGeneralOptions::instance()->set_threads(size_t(set_num_threads));
+		// render threads are shared by all of the jobs of the process
+		synfig::ThreadPool::set_cpu_count(set_num_threads);
 	}
 
 	VERBOSE_OUT(1) << _("Threads set to ")
 				   << SynfigToolGeneralOptions::instance()->get_threads() << std::endl;
+
+	if (set_num_jobs > 0)
+	{
+		SynfigToolGeneralOptions::instance()->set_jobs(size_t(set_num_jobs));
+		VERBOSE_OUT(1) << _("Jobs set to ")
+					   << SynfigToolGeneralOptions::instance()->get_jobs() << std::endl;
+	}
+
+	if (!set_memory_limit.empty())
+	{
+		size_t memory_limit = parse_memory_size(set_memory_limit);
+		if (!memory_limit)
+			throw (SynfigToolException(SYNFIGTOOL_UNKNOWNARGUMENT,
+				etl::strprintf(_("Invalid memory limit: %s"), set_memory_limit.c_str())));
+		SynfigToolGeneralOptions::instance()->set_memory_limit(memory_limit);
+		VERBOSE_OUT(1) << _("Memory limit set to ")
+					   << memory_limit << _(" bytes") << std::endl;
+	}
+
+	if (!set_trace_file.empty())
+	{
+		SynfigToolGeneralOptions::instance()->set_trace_file(set_trace_file);
+		synfig::debug::Trace::enable();
+	}
 }
 
 void SynfigCommandLineParser::process_trivial_info_options()
@@ -703,6 +745,28 @@ Job SynfigCommandLineParser::extract_job()
 		job.extract_alpha = true;
 	}
 
+	if (!set_shard.empty())
+	{
+		char tail = 0;
+		if (sscanf(set_shard.c_str(), "%d/%d%c", &job.shard_index, &job.shard_count, &tail) != 2
+		 || job.shard_count < 1 || job.shard_index < 1 || job.shard_index > job.shard_count)
+			throw (SynfigToolException(SYNFIGTOOL_UNKNOWNARGUMENT,
+				etl::strprintf(_("Invalid shard: %s (expected i/n, where 1 <= i <= n)"), set_shard.c_str())));
+		VERBOSE_OUT(1) << _("Shard set to ") << job.shard_index << "/" << job.shard_count << std::endl;
+	}
+
+	if (!set_shard_mode.empty())
+	{
+		if (set_shard_mode == "interleaved")
+			job.shard_interleaved = true;
+		else
+		if (set_shard_mode != "contiguous")
+			throw (SynfigToolException(SYNFIGTOOL_UNKNOWNARGUMENT,
+				etl::strprintf(_("Invalid shard mode: %s"), set_shard_mode.c_str())));
+	}
+
+	job.resume = sw_resume;
+
 	if (set_quality > 0)
 		job.quality = set_quality;
 	else
@@ -715,6 +779,7 @@ Job SynfigCommandLineParser::extract_job()
 	if (!set_canvas_id.empty())
 	{
 		std::string canvasid = set_canvas_id;
+		job.canvas_id = canvasid;
 
 		try
 		{
@@ -747,6 +812,7 @@ Job SynfigCommandLineParser::extract_job()
 	{
 		// TODO: Enable multi-appending. Disabled in the previous CLI version
 		std::string composite_file = misc_append_filename;
+		job.append_filename = composite_file;
 
 		std::string errors, warnings;
 		Canvas::Handle composite;
@@ -158,6 +158,9 @@ private:
 	int				set_quality;
 //			(",Q", quality_arg_desc->default_value(DEFAULT_QUALITY), )
 	int				set_num_threads;
+	int				set_num_jobs;
+	Glib::ustring	set_memory_limit;
+	std::string		set_trace_file;
 	Glib::ustring	set_input_file;
 	Glib::ustring	set_output_file;
 	Glib::ustring	set_sequence_separator;
@@ -167,6 +170,8 @@ private:
 	Glib::ustring	set_begin_time;
 	Glib::ustring	set_start_time;
 	Glib::ustring	set_end_time;
+	Glib::ustring	set_shard;
+	Glib::ustring	set_shard_mode;
 	double			set_dpi;
 	double			set_dpi_x;
 	double			set_dpi_y;
@@ -176,6 +181,7 @@ private:
 	bool			sw_quiet;
 	bool			sw_print_benchmarks;
 	bool			sw_extract_alpha;
+	bool			sw_resume;
 
 	// Misc group
 	std::string		misc_append_filename;
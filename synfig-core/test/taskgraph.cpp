@@ -0,0 +1,257 @@
+/* === S Y N F I G ========================================================= */
+/*!	\file taskgraph.cpp
+**	\brief Test dependencies of rendering tasks
+**
+**	$Id$
+**
+**	\legal
+**	......... ... 2026 Synfig contributors
+**
+**	This package is free software; you can redistribute it and/or
+**	modify it under the terms of the GNU General Public License as
+**	published by the Free Software Foundation; either version 2 of
+**	the License, or (at your option) any later version.
+**
+**	This package is distributed in the hope that it will be useful,
+**	but WITHOUT ANY WARRANTY; without even the implied warranty of
+**	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+**	General Public License for more details.
+**	\endlegal
+*/
+/* ========================================================================= */
+
+#include <synfig/general.h>
+#include <synfig/rendering/renderer.h>
+#include <synfig/rendering/task.h>
+
+#include <iostream>
+
+using namespace synfig;
+using namespace rendering;
+
+#define ERROR_MESSAGE_TWO_VALUES(a, b) \
+	std::cerr << __FUNCTION__ << ":" << __LINE__ << " - expected " << a << ", but got " << b << std::endl;
+
+#define ASSERT_EQUAL(expected, value) {\
+	if ((expected) != (value)) { \
+		ERROR_MESSAGE_TWO_VALUES(expected, value) \
+		return true; \
+	} \
+}
+
+#define ASSERT(value) ASSERT_EQUAL(true, (bool)(value))
+
+class TestRenderer: public Renderer
+{
+public:
+	virtual String get_name() const { return "test"; }
+	using Renderer::get_deps_plan_key;
+	using Renderer::apply_deps_plan;
+	using Renderer::find_deps;
+	using Renderer::find_last_use;
+};
+
+SurfaceResource::Handle new_surface(bool temporary)
+{
+	SurfaceResource::Handle surface = new SurfaceResource();
+	surface->create(64, 64);
+	surface->set_temporary(temporary);
+	return surface;
+}
+
+//! Task which writes \a rect of \a surface and reads \a sources
+Task::Handle new_task(const SurfaceResource::Handle &surface, const RectInt &rect, const Task::List &sources = Task::List())
+{
+	Task::Handle task = new TaskSurface();
+	task->source_rect = Rect(0, 0, 1, 1);
+	task->target_rect = rect;
+	task->target_surface = surface;
+	for(Task::List::const_iterator i = sources.begin(); i != sources.end(); ++i) {
+		Task::Handle sub_task = new TaskSurface();
+		sub_task->assign_target(**i);
+		task->sub_tasks.push_back(sub_task);
+	}
+	return task;
+}
+
+// a <- b <- c, and c also depends on a
+TaskGraph::Handle new_graph(Task::List &list)
+{
+	list.clear();
+	for(int i = 0; i < 3; ++i)
+		list.push_back(new_task(new_surface(true), RectInt(0, 0, 8, 8)));
+	TaskGraph::DepsList deps(3);
+	deps[1].push_back(0);
+	deps[2].push_back(0);
+	deps[2].push_back(1);
+	return TaskGraph::create(list, deps, 1);
+}
+
+bool test_graph_order() {
+	Task::List list;
+	TaskGraph::Handle graph = new_graph(list);
+	ASSERT_EQUAL(3, graph->size());
+	ASSERT_EQUAL(graph.get(), list[2]->renderer_data.graph.get());
+	ASSERT_EQUAL(3, list[2]->renderer_data.index);
+	ASSERT(list[0]->renderer_data.is_ready());
+	ASSERT(!list[1]->renderer_data.is_ready());
+	ASSERT(!list[2]->renderer_data.is_ready());
+	ASSERT(list[0]->renderer_data.has_back_deps());
+	ASSERT(!list[2]->renderer_data.has_back_deps());
+
+	TaskGraph::TaskList ready;
+	graph->set_done(0, ready);
+	ASSERT_EQUAL(1, ready.size());
+	ASSERT(ready[0] == list[1]);
+	ASSERT(!list[2]->renderer_data.is_ready());
+
+	ready.clear();
+	graph->set_done(1, ready);
+	ASSERT_EQUAL(1, ready.size());
+	ASSERT(ready[0] == list[2]);
+	ASSERT(list[2]->renderer_data.is_ready());
+
+	// task is reported only once
+	ready.clear();
+	graph->set_done(1, ready);
+	ASSERT_EQUAL(0, ready.size());
+
+	return false;
+}
+
+bool test_graph_remove() {
+	Task::List list;
+	TaskGraph::Handle graph = new_graph(list);
+
+	// graph holds pending tasks, and releases them when they are done or removed
+	ASSERT_EQUAL(2, list[0]->count());
+	TaskGraph::TaskList ready;
+	graph->set_done(0, ready);
+	ASSERT_EQUAL(1, list[0]->count());
+
+	// done task is not removed, and doesn't become orphan
+	TaskGraph::TaskList orphans;
+	graph->remove(0, orphans);
+	ASSERT_EQUAL(0, orphans.size());
+
+	// removing of the last dependent task leaves pending dependencies without users
+	graph->remove(2, orphans);
+	ASSERT_EQUAL(1, orphans.size());
+	ASSERT(orphans[0] == list[1]);
+	ASSERT_EQUAL(1, list[2]->count());
+	ASSERT(!list[1]->renderer_data.has_back_deps());
+
+	// dependencies don't report removed task as ready
+	ready.clear();
+	graph->set_done(1, ready);
+	ASSERT_EQUAL(0, ready.size());
+
+	return false;
+}
+
+bool test_deps_plan_cache() {
+	etl::handle<TestRenderer> renderer = new TestRenderer();
+
+	// b reads result of a, c writes other part of the same target after b
+	SurfaceResource::Handle temp = new_surface(true);
+	SurfaceResource::Handle target = new_surface(false);
+	Task::List list;
+	list.push_back(new_task(temp, RectInt(0, 0, 16, 16)));
+	list.push_back(new_task(target, RectInt(0, 0, 16, 16), Task::List(1, list[0])));
+	list.push_back(new_task(target, RectInt(32, 32, 48, 48)));
+
+	String key = TestRenderer::get_deps_plan_key(list);
+	TaskGraph::DepsList deps;
+	ASSERT(!renderer->apply_deps_plan(key, deps));
+	renderer->find_deps(list, 1, deps);
+	ASSERT_EQUAL(3, deps.size());
+	ASSERT_EQUAL(0, deps[0].size());
+	ASSERT_EQUAL(1, deps[1].size());
+	ASSERT_EQUAL(0, deps[1][0]);
+	ASSERT_EQUAL(1, deps[2].size());
+	ASSERT_EQUAL(1, deps[2][0]);
+
+	// next frame: same shape of batch with new surfaces
+	SurfaceResource::Handle temp2 = new_surface(true);
+	SurfaceResource::Handle target2 = new_surface(false);
+	Task::List same;
+	same.push_back(new_task(temp2, RectInt(0, 0, 16, 16)));
+	same.push_back(new_task(target2, RectInt(0, 0, 16, 16), Task::List(1, same[0])));
+	same.push_back(new_task(target2, RectInt(32, 32, 48, 48)));
+	ASSERT(TestRenderer::get_deps_plan_key(same) == key);
+	TaskGraph::DepsList cached;
+	ASSERT(renderer->apply_deps_plan(key, cached));
+	ASSERT(cached == deps);
+
+	// other rect of a task changes the shape of batch
+	Task::List other;
+	other.push_back(new_task(temp2, RectInt(0, 0, 16, 16)));
+	other.push_back(new_task(target2, RectInt(0, 0, 16, 16), Task::List(1, other[0])));
+	other.push_back(new_task(target2, RectInt(8, 8, 48, 48)));
+	String other_key = TestRenderer::get_deps_plan_key(other);
+	ASSERT(other_key != key);
+	ASSERT(!renderer->apply_deps_plan(other_key, cached));
+	renderer->find_deps(other, 2, cached);
+	ASSERT_EQUAL(3, cached.size());
+	ASSERT(renderer->apply_deps_plan(other_key, cached));
+	ASSERT(renderer->apply_deps_plan(key, cached));
+
+	return false;
+}
+
+bool test_last_use() {
+	etl::handle<TestRenderer> renderer = new TestRenderer();
+
+	SurfaceResource::Handle temp = new_surface(true);
+	SurfaceResource::Handle output = new_surface(true);
+	SurfaceResource::Handle target = new_surface(false);
+	Task::List list;
+	list.push_back(new_task(temp, RectInt(0, 0, 16, 16)));
+	list.push_back(new_task(output, RectInt(0, 0, 16, 16), Task::List(1, list[0])));
+	list.push_back(new_task(target, RectInt(0, 0, 16, 16), Task::List(1, list[1])));
+
+	// result of the batch is not released even when it is temporary
+	renderer->find_last_use(list, Task::List(1, list[1]));
+	ASSERT_EQUAL(1, list[0]->renderer_data.surfaces_to_release.size());
+	ASSERT(list[0]->renderer_data.surfaces_to_release[0] == temp);
+	ASSERT_EQUAL(1, list[1]->renderer_data.surfaces_to_release.size());
+	ASSERT(list[1]->renderer_data.surfaces_to_release[0] == temp);
+	ASSERT_EQUAL(0, list[2]->renderer_data.surfaces_to_release.size());
+
+	// surface is released by the last of its users
+	ASSERT(!temp->release_user());
+	ASSERT(temp->release_user());
+
+	return false;
+}
+
+#define TEST_FUNCTION(function_name) {\
+	fail = function_name(); \
+	if (fail) { \
+		error("%s FAILED", #function_name); \
+		failures++; \
+	} \
+}
+
+int main() {
+	int failures = 0;
+	bool fail;
+	bool exception_thrown = false;
+
+	try {
+		TEST_FUNCTION(test_graph_order)
+		TEST_FUNCTION(test_graph_remove)
+		TEST_FUNCTION(test_deps_plan_cache)
+		TEST_FUNCTION(test_last_use)
+	} catch (...) {
+		error("Some exception has been thrown.");
+		exception_thrown = true;
+	}
+
+	if (failures || exception_thrown)
+		error("Test finished with %i errors and %i exception", failures, exception_thrown);
+	else
+		info("Success");
+
+	return (failures || exception_thrown)? 1 : 0;
+}
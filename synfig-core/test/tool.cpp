@@ -0,0 +1,235 @@
+/* === S Y N F I G ========================================================= */
+/*!	\file tool.cpp
+**	\brief Test selection of frames by synfig command line tool
+**
+**	$Id$
+**
+**	\legal
+**	......... ... 2026 Synfig contributors
+**
+**	This package is free software; you can redistribute it and/or
+**	modify it under the terms of the GNU General Public License as
+**	published by the Free Software Foundation; either version 2 of
+**	the License, or (at your option) any later version.
+**
+**	This package is distributed in the hope that it will be useful,
+**	but WITHOUT ANY WARRANTY; without even the implied warranty of
+**	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+**	General Public License for more details.
+**	\endlegal
+*/
+/* ========================================================================= */
+
+#include <synfig/general.h>
+
+#include <tool/frameselection.h>
+
+#include <glib.h>
+#include <glib/gstdio.h>
+
+#include <iostream>
+
+#define ERROR_MESSAGE_TWO_VALUES(a, b) \
+	std::cerr << __FUNCTION__ << ":" << __LINE__ << " - expected " << a << ", but got " << b << std::endl;
+
+#define ASSERT_EQUAL(expected, value) {\
+	if ((expected) != (value)) { \
+		ERROR_MESSAGE_TWO_VALUES(expected, value) \
+		return true; \
+	} \
+}
+
+#define ASSERT(value) ASSERT_EQUAL(true, (bool)(value))
+
+std::string temp_filename(const std::string &name)
+{
+	return std::string(g_get_tmp_dir()) + G_DIR_SEPARATOR_S + name;
+}
+
+void write_file(const std::string &filename, const char *content)
+{
+	if (FILE *file = g_fopen(filename.c_str(), "w")) {
+		fputs(content, file);
+		fclose(file);
+	}
+}
+
+bool test_parse_memory_size() {
+	ASSERT_EQUAL(100, parse_memory_size("100"));
+	ASSERT_EQUAL(1024, parse_memory_size("1k"));
+	ASSERT_EQUAL(1024, parse_memory_size("1KB"));
+	ASSERT_EQUAL(512*1024*1024, parse_memory_size("512M"));
+	ASSERT_EQUAL(3*512*1024*1024ull, parse_memory_size("1.5G"));
+	ASSERT_EQUAL(8*1024*1024*1024ull, parse_memory_size("8gb"));
+	ASSERT_EQUAL(1024*1024*1024*1024ull, parse_memory_size("1T"));
+
+	ASSERT_EQUAL(0, parse_memory_size(""));
+	ASSERT_EQUAL(0, parse_memory_size("G"));
+	ASSERT_EQUAL(0, parse_memory_size("0"));
+	ASSERT_EQUAL(0, parse_memory_size("-1G"));
+	ASSERT_EQUAL(0, parse_memory_size("10X"));
+	ASSERT_EQUAL(0, parse_memory_size("10MBx"));
+
+	return false;
+}
+
+//! Checks that shards of [start, end] take every frame once
+bool check_shards(int start, int end, int shard_count, bool interleaved) {
+	std::vector<int> taken(end - start + 1);
+	for(int shard = 1; shard <= shard_count; ++shard) {
+		std::vector<int> frames;
+		get_shard_frames(start, end, shard, shard_count, interleaved, frames);
+		for(size_t i = 0; i < frames.size(); ++i) {
+			ASSERT(frames[i] >= start && frames[i] <= end);
+			if (i > 0 && !interleaved)
+				ASSERT_EQUAL(frames[i - 1] + 1, frames[i]);
+			++taken[frames[i] - start];
+		}
+
+		int first, last;
+		bool has_frames = get_shard_range(start, end, shard, shard_count, first, last);
+		if (!interleaved) {
+			ASSERT_EQUAL(!frames.empty(), has_frames);
+			if (has_frames) {
+				ASSERT_EQUAL(frames.front(), first);
+				ASSERT_EQUAL(frames.back(), last);
+			}
+		}
+	}
+	for(size_t i = 0; i < taken.size(); ++i)
+		ASSERT_EQUAL(1, taken[i]);
+	return false;
+}
+
+bool test_shards() {
+	std::vector<int> frames;
+	get_shard_frames(0, 9, 3, 3, false, frames);
+	ASSERT_EQUAL(4, frames.size());
+	ASSERT_EQUAL(6, frames.front());
+	get_shard_frames(0, 9, 2, 3, true, frames);
+	ASSERT_EQUAL(3, frames.size());
+	ASSERT_EQUAL(1, frames[0]);
+	ASSERT_EQUAL(4, frames[1]);
+	ASSERT_EQUAL(7, frames[2]);
+
+	for(int shard_count = 1; shard_count <= 12; ++shard_count) {
+		if (check_shards(0, 9, shard_count, false)) return true;
+		if (check_shards(0, 9, shard_count, true)) return true;
+		if (check_shards(24, 28, shard_count, false)) return true;
+		if (check_shards(24, 28, shard_count, true)) return true;
+	}
+
+	// more shards than frames: some shards are empty, others take single frame
+	int empty = 0;
+	for(int shard = 1; shard <= 5; ++shard) {
+		int first, last;
+		get_shard_frames(10, 12, shard, 5, false, frames);
+		if (!get_shard_range(10, 12, shard, 5, first, last))
+			++empty;
+		ASSERT(frames.size() <= 1);
+	}
+	ASSERT_EQUAL(2, empty);
+	get_shard_frames(10, 12, 4, 5, true, frames);
+	ASSERT_EQUAL(0, frames.size());
+
+	// single frame document
+	get_shard_frames(5, 5, 1, 1, false, frames);
+	ASSERT_EQUAL(1, frames.size());
+	ASSERT_EQUAL(5, frames[0]);
+
+	return false;
+}
+
+bool test_manifest_round_trip() {
+	const std::string filename = temp_filename("synfig_test_tool.png.manifest");
+	g_remove(filename.c_str());
+
+	std::set<int> frames;
+	read_manifest(filename, frames);
+	ASSERT_EQUAL(0, frames.size());
+
+	{
+		FrameManifest manifest(filename);
+		manifest.on_frame_done(3);
+		manifest.on_frame_done(1);
+		manifest.on_frame_done(7);
+	}
+	{
+		// next run appends to the same manifest
+		FrameManifest manifest(filename);
+		manifest.on_frame_done(5);
+	}
+
+	read_manifest(filename, frames);
+	g_remove(filename.c_str());
+	ASSERT_EQUAL(4, frames.size());
+	ASSERT(frames.count(1));
+	ASSERT(frames.count(3));
+	ASSERT(frames.count(5));
+	ASSERT(frames.count(7));
+
+	return false;
+}
+
+bool test_resume() {
+	const std::string filename = temp_filename("synfig_test_tool.png");
+	ASSERT_EQUAL(temp_filename("synfig_test_tool.0007.png"), get_frame_filename(filename, ".", 7));
+
+	// frame 1 is done, file of frame 2 is empty, file of frame 3 is lost, frame 4 isn't done
+	write_file(get_frame_filename(filename, ".", 1), "png");
+	write_file(get_frame_filename(filename, ".", 2), "");
+	g_remove(get_frame_filename(filename, ".", 3).c_str());
+	write_file(get_frame_filename(filename, ".", 4), "png");
+
+	std::set<int> done;
+	done.insert(1);
+	done.insert(2);
+	done.insert(3);
+
+	std::vector<int> frames;
+	for(int i = 1; i <= 4; ++i)
+		frames.push_back(i);
+	size_t skipped = skip_done_frames(frames, done, filename, ".");
+
+	for(int i = 1; i <= 4; ++i)
+		g_remove(get_frame_filename(filename, ".", i).c_str());
+
+	ASSERT_EQUAL(1, skipped);
+	ASSERT_EQUAL(3, frames.size());
+	ASSERT_EQUAL(2, frames[0]);
+	ASSERT_EQUAL(3, frames[1]);
+	ASSERT_EQUAL(4, frames[2]);
+
+	return false;
+}
+
+#define TEST_FUNCTION(function_name) {\
+	fail = function_name(); \
+	if (fail) { \
+		synfig::error("%s FAILED", #function_name); \
+		failures++; \
+	} \
+}
+
+int main() {
+	int failures = 0;
+	bool fail;
+	bool exception_thrown = false;
+
+	try {
+		TEST_FUNCTION(test_parse_memory_size)
+		TEST_FUNCTION(test_shards)
+		TEST_FUNCTION(test_manifest_round_trip)
+		TEST_FUNCTION(test_resume)
+	} catch (...) {
+		synfig::error("Some exception has been thrown.");
+		exception_thrown = true;
+	}
+
+	if (failures || exception_thrown)
+		synfig::error("Test finished with %i errors and %i exception", failures, exception_thrown);
+	else
+		synfig::info("Success");
+
+	return (failures || exception_thrown)? 1 : 0;
+}
@@ -287,6 +287,7 @@ String studio::App::image_editor_path;
 
 String studio::App::sequence_separator(".");
 int    studio::App::number_of_threads = std::thread::hardware_concurrency();
+int    studio::App::workarea_cache_size = 512;
 String studio::App::navigator_renderer;
 String studio::App::workarea_renderer;
 
@@ -549,6 +550,11 @@ public:
 				value=strprintf("%i",App::number_of_threads);
 				return true;
 			}
+			if(key=="workarea_cache_size")
+			{
+				value=strprintf("%i",App::workarea_cache_size);
+				return true;
+			}
 			if(key=="navigator_renderer")
 			{
 				value=App::navigator_renderer;
@@ -737,6 +743,11 @@ public:
 				App::number_of_threads=atoi(value.c_str());
 				return true;
 			}
+			if(key=="workarea_cache_size")
+			{
+				App::workarea_cache_size=atoi(value.c_str());
+				return true;
+			}
 			if(key=="navigator_renderer")
 			{
 				App::navigator_renderer=value;
@@ -826,6 +837,7 @@ public:
 		ret.push_back("predefined_fps");
 		ret.push_back("sequence_separator");
 		ret.push_back("number_of_threads");
+		ret.push_back("workarea_cache_size");
 		ret.push_back("navigator_renderer");
 		ret.push_back("workarea_renderer");
 		ret.push_back("default_background_layer_type");
@@ -36,6 +36,7 @@
 
 #include <synfig/context.h>
 #include <synfig/general.h>
+#include <synfig/rendering/task.h>
 #include <synfig/target_scanline.h>
 #include <synfig/target_tile.h>
 
@@ -122,8 +123,7 @@ public:
 	}
 
 	virtual bool async_render_tile(
-		etl::handle<Canvas> canvas,
-		ContextParams context_params,
+		rendering::Task::Handle task,
 		RectInt rect,
 		RendDesc tile_desc,
 		ProgressCallback */*cb*/ )
@@ -135,7 +135,7 @@ public:
 			sigc::hide_return(
 				sigc::bind(
 					sigc::mem_fun(*this, &AsyncTarget_Tile::sync_render_tile),
-					canvas, context_params, rect, tile_desc, (synfig::ProgressCallback*)NULL )),
+					task, rect, tile_desc, (synfig::ProgressCallback*)NULL )),
 				true
 			);
 		assert(thread);
@@ -149,15 +149,14 @@ public:
 	}
 
 	bool sync_render_tile(
-		etl::handle<Canvas> canvas,
-		ContextParams context_params,
+		rendering::Task::Handle task,
 		RectInt rect,
 		RendDesc tile_desc,
 		ProgressCallback *cb )
 	{
 		if(!alive_flag)
 			return false;
-		bool r = warm_target->async_render_tile(canvas, context_params, rect, tile_desc, cb);
+		bool r = warm_target->async_render_tile(task, rect, tile_desc, cb);
 		if (!r) { Glib::Mutex::Lock lock(mutex); err = true; }
 		return r;
 	}
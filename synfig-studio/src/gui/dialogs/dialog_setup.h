@@ -167,6 +167,7 @@ class Dialog_Setup : public Dialog_Template
 	Gtk::Switch       toggle_play_sound_on_render_done;
 	Glib::RefPtr<Gtk::Adjustment> adj_number_of_threads;
 	Gtk::SpinButton*  number_of_threads_select;	
+	Glib::RefPtr<Gtk::Adjustment> adj_workarea_cache_size;
 
 	Gtk::Switch toggle_handle_tooltip_widthpoint;
 	Gtk::Switch toggle_handle_tooltip_radius;
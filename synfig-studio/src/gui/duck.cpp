@@ -60,6 +60,7 @@ using namespace studio;
 /* === G L O B A L S ======================================================= */
 
 int studio::Duck::duck_count(0);
+unsigned long studio::Duck::position_revision(0);
 
 struct _DuckCounter
 {
@@ -164,6 +165,7 @@ Duck::operator==(const Duck &rhs)const
 void
 Duck::set_point(const synfig::Point &x)
 {
+	position_changed();
 	if (get_move_origin() && origin_duck_) {
 		Point offset = get_trans_point(x) - get_trans_point();
 		origin_duck_->set_trans_point(origin_duck_->get_trans_point() + offset);
@@ -166,6 +166,11 @@ private:
 	synfig::Point aspect_point_;
 
 	static int duck_count;
+
+	//! Incremented on every change which may move any duck at workarea
+	static unsigned long position_revision;
+	static void position_changed() { ++position_revision; }
+
 public:
 
 	// constructors
@@ -284,7 +289,7 @@ public:
 	bool is_aspect_locked()const
 		{ return lock_aspect_; }
 	void set_lock_aspect(bool r)
-		{ if (!lock_aspect_ && r) aspect_point_=point_.norm(); lock_aspect_=r; }
+		{ if (!lock_aspect_ && r) aspect_point_=point_.norm(); lock_aspect_=r; position_changed(); }
 
 	void set_move_origin(bool x)
 		{ move_origin_=x; }
@@ -295,23 +300,23 @@ public:
 	// positioning
 
 	void set_transform_stack(const synfig::TransformStack& x)
-		{ transform_stack_=x; }
+		{ transform_stack_=x; position_changed(); }
 	const synfig::TransformStack& get_transform_stack()const
 		{ return transform_stack_; }
 
 	//! Sets the scalar multiplier for the duck with respect to the origin
 	void set_scalar(synfig::Vector::value_type n)
-		{ scalar_=n; }
+		{ scalar_=n; position_changed(); }
 	//! Retrieves the scalar value
 	synfig::Vector::value_type get_scalar()const
 		{ return scalar_; }
 
 	//! Sets the origin point.
 	void set_origin(const synfig::Point &x)
-		{ origin_=x; origin_duck_=NULL; }
+		{ origin_=x; origin_duck_=NULL; position_changed(); }
 	//! Sets the origin point as another duck
 	void set_origin(const Handle &x)
-		{ origin_duck_=x; }
+		{ origin_duck_=x; position_changed(); }
 	//! Retrieves the origin location
 	synfig::Point get_origin()const
 		{ return origin_duck_?origin_duck_->get_point():origin_; }
@@ -320,18 +325,18 @@ public:
 		{ return origin_duck_; }
 
 	void set_axis_x_angle(const synfig::Angle &a)
-		{ axis_x_angle_=a; axis_x_angle_duck_=NULL; }
+		{ axis_x_angle_=a; axis_x_angle_duck_=NULL; position_changed(); }
 	void set_axis_x_angle(const Handle &duck, const synfig::Angle angle = synfig::Angle::zero())
-		{ axis_x_angle_duck_=duck; axis_x_angle_=angle; }
+		{ axis_x_angle_duck_=duck; axis_x_angle_=angle; position_changed(); }
 	synfig::Angle get_axis_x_angle()const
 		{ return axis_x_angle_duck_?get_sub_trans_point(axis_x_angle_duck_,false).angle()+axis_x_angle_:axis_x_angle_; }
 	const Handle& get_axis_x_angle_duck()const
 		{ return axis_x_angle_duck_; }
 
 	void set_axis_x_mag(const synfig::Real &m)
-		{ axis_x_mag_=m; axis_x_mag_duck_=NULL; }
+		{ axis_x_mag_=m; axis_x_mag_duck_=NULL; position_changed(); }
 	void set_axis_x_mag(const Handle &duck)
-		{ axis_x_mag_duck_=duck; }
+		{ axis_x_mag_duck_=duck; position_changed(); }
 	synfig::Real get_axis_x_mag()const
 		{ return axis_x_mag_duck_?get_sub_trans_point(axis_x_mag_duck_,false).mag():axis_x_mag_; }
 	const Handle& get_axis_x_mag_duck()const
@@ -341,18 +346,18 @@ public:
 		{ return synfig::Point(get_axis_x_mag(), get_axis_x_angle()); }
 
 	void set_axis_y_angle(const synfig::Angle &a)
-		{ axis_y_angle_=a; axis_y_angle_duck_=NULL; }
+		{ axis_y_angle_=a; axis_y_angle_duck_=NULL; position_changed(); }
 	void set_axis_y_angle(const Handle &duck, const synfig::Angle angle = synfig::Angle::zero())
-		{ axis_y_angle_duck_=duck; axis_y_angle_=angle; }
+		{ axis_y_angle_duck_=duck; axis_y_angle_=angle; position_changed(); }
 	synfig::Angle get_axis_y_angle()const
 		{ return axis_y_angle_duck_?get_sub_trans_point(axis_y_angle_duck_,false).angle()+axis_y_angle_:axis_y_angle_; }
 	const Handle& get_axis_y_angle_duck()const
 		{ return axis_y_angle_duck_; }
 
 	void set_axis_y_mag(const synfig::Real &m)
-		{ axis_y_mag_=m; axis_y_mag_duck_=NULL; }
+		{ axis_y_mag_=m; axis_y_mag_duck_=NULL; position_changed(); }
 	void set_axis_y_mag(const Handle &duck)
-		{ axis_y_mag_duck_=duck; }
+		{ axis_y_mag_duck_=duck; position_changed(); }
 	synfig::Real get_axis_y_mag()const
 		{ return axis_y_mag_duck_?get_sub_trans_point(axis_y_mag_duck_,false).mag():axis_y_mag_; }
 	const Handle& get_axis_y_mag_duck()const
@@ -399,17 +404,17 @@ public:
 	synfig::Point get_point()const;
 
 	void set_shared_point(const etl::smart_ptr<synfig::Point>&x)
-		{ shared_point_=x; }
+		{ shared_point_=x; position_changed(); }
 	const etl::smart_ptr<synfig::Point>& get_shared_point()const
 		{ return shared_point_; }
 
 	void set_shared_angle(const etl::smart_ptr<synfig::Angle>&x)
-		{ shared_angle_=x; }
+		{ shared_angle_=x; position_changed(); }
 	const etl::smart_ptr<synfig::Angle>& get_shared_angle()const
 		{ return shared_angle_; }
 
 	void set_shared_mag(const etl::smart_ptr<synfig::Real>&x)
-		{ shared_mag_=x; }
+		{ shared_mag_=x; position_changed(); }
 	const etl::smart_ptr<synfig::Real>& get_shared_mag()const
 		{ return shared_mag_; }
 
@@ -425,6 +430,10 @@ public:
 
 	// calculation of position of duck at workarea
 
+	//! Changes when position of any duck may change, used to validate cached positions
+	static unsigned long get_position_revision()
+		{ return position_revision; }
+
 	synfig::Point get_trans_point()const;
 	synfig::Point get_trans_point(const synfig::Point &x)const;
 
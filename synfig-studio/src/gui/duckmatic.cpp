@@ -98,6 +98,36 @@ void set_duck_value_desc(Duck& duck, const synfigapp::ValueDesc& value_desc, con
 
 /* === P R O C E D U R E S ================================================= */
 
+static inline Point
+bezier_point(const Point *c, Real t)
+{
+	Real u = 1.0 - t;
+	return c[0]*(u*u*u) + c[1]*(3.0*u*u*t) + c[2]*(3.0*u*t*t) + c[3]*(t*t*t);
+}
+
+//! Refines time of the point of cubic bezier closest to \a p by Newton's method
+static float
+refine_closest_time(const Point *c, const Point &p, float time)
+{
+	Real t = time;
+	for(int i = 0; i < 8; ++i)
+	{
+		Real u = 1.0 - t;
+		Vector diff = bezier_point(c, t) - p;
+		Vector d1 = (c[1] - c[0])*(3.0*u*u) + (c[2] - c[1])*(6.0*u*t) + (c[3] - c[2])*(3.0*t*t);
+		Vector d2 = (c[2] - c[1]*2.0 + c[0])*(6.0*u) + (c[3] - c[2]*2.0 + c[1])*(6.0*t);
+		Real df = d1*d1 + diff*d2;
+		if (df <= real_low_precision<Real>())
+			break;
+		Real next = std::max(0.0, std::min(1.0, t - (diff*d1)/df));
+		bool done = approximate_equal(next, t);
+		t = next;
+		if (done) break;
+	}
+	return (bezier_point(c, t) - p).mag_squared() < (bezier_point(c, time) - p).mag_squared()
+	     ? (float)t : time;
+}
+
 /* === M E T H O D S ======================================================= */
 
 /* === E N T R Y P O I N T ================================================= */
@@ -142,6 +172,7 @@ Duckmatic::clear_ducks()
 
 	duck_data_share_map.clear();
 	duck_map.clear();
+	pick_index.invalidate();
 
 	//duck_list_.clear();
 	bezier_list_.clear();
@@ -1167,6 +1198,7 @@ Duckmatic::add_duck(const etl::handle<Duck> &duck)
 		}
 
 		duck_map.insert(duck);
+		pick_index.invalidate();
 	}
 
 	last_duck_guid=duck->get_guid();
@@ -1176,6 +1208,7 @@ void
 Duckmatic::add_bezier(const etl::handle<Bezier> &bezier)
 {
 	bezier_list_.push_back(bezier);
+	pick_index.invalidate();
 }
 
 void
@@ -1229,6 +1262,7 @@ void
 Duckmatic::erase_duck(const etl::handle<Duck> &duck)
 {
 	duck_map.erase(duck->get_guid());
+	pick_index.invalidate();
 }
 
 etl::handle<Duckmatic::Duck>
@@ -1275,6 +1309,7 @@ Duckmatic::erase_bezier(const etl::handle<Bezier> &bezier)
 		if(*iter==bezier)
 		{
 			bezier_list_.erase(iter);
+			pick_index.invalidate();
 			return;
 		}
 	}
@@ -1296,6 +1331,135 @@ Duckmatic::last_bezier()const
 	return bezier_list_.back();
 }
 
+void
+Duckmatic::PickIndex::build(const DuckMap &duck_map, const std::list<etl::handle<Bezier> > &bezier_list)
+{
+	const int max_bezier_cells = 64;
+
+	ducks.clear();
+	beziers.clear();
+	duck_cells.clear();
+	bezier_cells.clear();
+	large_beziers.clear();
+
+	Rect bounds;
+	bool first = true;
+
+	ducks.reserve(duck_map.size());
+	for(DuckMap::const_iterator i = duck_map.begin(); i != duck_map.end(); ++i)
+	{
+		DuckEntry entry;
+		entry.duck = i->second;
+		entry.point = entry.duck->get_trans_point();
+		ducks.push_back(entry);
+		if (first) { bounds = Rect(entry.point); first = false; }
+		else bounds.expand(entry.point);
+	}
+
+	beziers.reserve(bezier_list.size());
+	for(std::list<etl::handle<Bezier> >::const_iterator i = bezier_list.begin(); i != bezier_list.end(); ++i)
+	{
+		BezierEntry entry;
+		entry.bezier = *i;
+		entry.points[0] = (*i)->p1->get_trans_point();
+		entry.points[1] = (*i)->c1->get_trans_point();
+		entry.points[2] = (*i)->c2->get_trans_point();
+		entry.points[3] = (*i)->p2->get_trans_point();
+		// curve is inside of convex hull of its control points
+		entry.bounds = Rect(entry.points[0]);
+		for(int j = 1; j < 4; ++j)
+			entry.bounds.expand(entry.points[j]);
+		beziers.push_back(entry);
+		if (first) { bounds = entry.bounds; first = false; }
+		else bounds.expand(entry.bounds.get_min()).expand(entry.bounds.get_max());
+	}
+
+	// choose cells to keep about one duck per cell
+	int count = std::max((int)ducks.size(), 1);
+	Real w = bounds.maxx - bounds.minx;
+	Real h = bounds.maxy - bounds.miny;
+	cell_size = std::max(sqrt(w*h/count), std::max(w, h)/count);
+	if (!(cell_size > real_low_precision<Real>()))
+		cell_size = 1.0;
+	origin = bounds.get_min();
+	cols = std::min(count, (int)floor(w/cell_size) + 1);
+	rows = std::min(count, (int)floor(h/cell_size) + 1);
+
+	duck_cells.resize(cols*rows);
+	for(int i = 0; i < (int)ducks.size(); ++i)
+	{
+		int x = std::min(cols - 1, (int)floor((ducks[i].point[0] - origin[0])/cell_size));
+		int y = std::min(rows - 1, (int)floor((ducks[i].point[1] - origin[1])/cell_size));
+		duck_cells[y*cols + x].push_back(i);
+	}
+
+	bezier_cells.resize(cols*rows);
+	for(int i = 0; i < (int)beziers.size(); ++i)
+	{
+		const Rect &b = beziers[i].bounds;
+		int x0 = std::min(cols - 1, (int)floor((b.minx - origin[0])/cell_size));
+		int y0 = std::min(rows - 1, (int)floor((b.miny - origin[1])/cell_size));
+		int x1 = std::min(cols - 1, (int)floor((b.maxx - origin[0])/cell_size));
+		int y1 = std::min(rows - 1, (int)floor((b.maxy - origin[1])/cell_size));
+		if ((x1 - x0 + 1)*(y1 - y0 + 1) > max_bezier_cells)
+			{ large_beziers.push_back(i); continue; }
+		for(int y = y0; y <= y1; ++y)
+			for(int x = x0; x <= x1; ++x)
+				bezier_cells[y*cols + x].push_back(i);
+	}
+
+	position_revision = Duck::get_position_revision();
+	valid = true;
+}
+
+bool
+Duckmatic::PickIndex::query(const synfig::Point &point, synfig::Real radius, std::vector<int> &duck_ids, std::vector<int> &bezier_ids) const
+{
+	duck_ids.clear();
+	bezier_ids.clear();
+	if (!valid || cols <= 0 || rows <= 0)
+		return false;
+
+	Real x0f = floor((point[0] - radius - origin[0])/cell_size);
+	Real y0f = floor((point[1] - radius - origin[1])/cell_size);
+	Real x1f = floor((point[0] + radius - origin[0])/cell_size);
+	Real y1f = floor((point[1] + radius - origin[1])/cell_size);
+	if (x1f < 0 || y1f < 0 || x0f >= cols || y0f >= rows)
+		return true;
+
+	int x0 = (int)std::max(x0f, Real(0));
+	int y0 = (int)std::max(y0f, Real(0));
+	int x1 = (int)std::min(x1f, Real(cols - 1));
+	int y1 = (int)std::min(y1f, Real(rows - 1));
+
+	// do not walk through cells when it's cheaper to check everything
+	if ((x1 - x0 + 1)*(y1 - y0 + 1) >= (int)(ducks.size() + beziers.size()))
+		return false;
+
+	for(int y = y0; y <= y1; ++y)
+		for(int x = x0; x <= x1; ++x)
+		{
+			const std::vector<int> &dc = duck_cells[y*cols + x];
+			duck_ids.insert(duck_ids.end(), dc.begin(), dc.end());
+			const std::vector<int> &bc = bezier_cells[y*cols + x];
+			bezier_ids.insert(bezier_ids.end(), bc.begin(), bc.end());
+		}
+	bezier_ids.insert(bezier_ids.end(), large_beziers.begin(), large_beziers.end());
+
+	// keep order of original lists, it matters for equidistant ducks
+	std::sort(duck_ids.begin(), duck_ids.end());
+	std::sort(bezier_ids.begin(), bezier_ids.end());
+	bezier_ids.erase(std::unique(bezier_ids.begin(), bezier_ids.end()), bezier_ids.end());
+	return true;
+}
+
+void
+Duckmatic::update_pick_index()
+{
+	if (!pick_index.is_actual())
+		pick_index.build(duck_map, bezier_list_);
+}
+
 etl::handle<Duckmatic::Duck>
 Duckmatic::find_duck(synfig::Point point, synfig::Real radius, Duck::Type type)
 {
@@ -1308,17 +1472,21 @@ Duckmatic::find_duck(synfig::Point point, synfig::Real radius, Duck::Type type)
 	etl::handle<Duck> ret;
 	std::vector< etl::handle<Duck> > ret_vector;
 
-	DuckMap::const_iterator iter;
+	update_pick_index();
+	std::vector<int> duck_ids, bezier_ids;
+	const bool indexed = pick_index.query(point, radius, duck_ids, bezier_ids);
+	const int count = indexed ? (int)duck_ids.size() : (int)pick_index.ducks.size();
 
-	for(iter=duck_map.begin();iter!=duck_map.end();++iter)
+	for(int i = 0; i < count; ++i)
 	{
-		const Duck::Handle& duck(iter->second);
+		const PickIndex::DuckEntry &entry = pick_index.ducks[indexed ? duck_ids[i] : i];
+		const Duck::Handle& duck(entry.duck);
 
 		if(duck->get_ignore() ||
 			(duck->get_type() && !(type & duck->get_type())))
 			continue;
 
-		Real dist((duck->get_trans_point()-point).mag_squared());
+		Real dist((entry.point-point).mag_squared());
 
 		bool equal;
 		equal=fabs(dist-closest)<0.0000001?true:false;
@@ -1420,6 +1588,7 @@ Duckmatic::find_bezier(synfig::Point pos, synfig::Real scale, synfig::Real radiu
 	if(radius==0)radius=10000000;
 	Real closest(10000000);
 	etl::handle<Bezier> ret;
+	const PickIndex::BezierEntry *best = NULL;
 
 	bezier<Point>	curve;
 
@@ -1427,12 +1596,25 @@ Duckmatic::find_bezier(synfig::Point pos, synfig::Real scale, synfig::Real radiu
 	float	time = 0;
 	float	best_time = 0;
 
-	for(std::list<handle<Bezier> >::const_iterator iter=bezier_list().begin();iter!=bezier_list().end();++iter)
+	update_pick_index();
+	std::vector<int> duck_ids, bezier_ids;
+	const bool indexed = pick_index.query(pos, radius, duck_ids, bezier_ids);
+	const int count = indexed ? (int)bezier_ids.size() : (int)pick_index.beziers.size();
+
+	for(int i = 0; i < count; ++i)
 	{
-		curve[0] = (*iter)->p1->get_trans_point();
-		curve[1] = (*iter)->c1->get_trans_point();
-		curve[2] = (*iter)->c2->get_trans_point();
-		curve[3] = (*iter)->p2->get_trans_point();
+		const PickIndex::BezierEntry &entry = pick_index.beziers[indexed ? bezier_ids[i] : i];
+
+		// curve can't be closer than its bounds
+		Real dx = std::max(0.0, std::max(entry.bounds.minx - pos[0], pos[0] - entry.bounds.maxx));
+		Real dy = std::max(0.0, std::max(entry.bounds.miny - pos[1], pos[1] - entry.bounds.maxy));
+		if (dx*dx + dy*dy >= closest)
+			continue;
+
+		curve[0] = entry.points[0];
+		curve[1] = entry.points[1];
+		curve[2] = entry.points[2];
+		curve[3] = entry.points[3];
 		curve.sync();
 
 #if 0
@@ -1455,15 +1637,17 @@ Duckmatic::find_bezier(synfig::Point pos, synfig::Real scale, synfig::Real radiu
 		if(d < closest)
 		{
 			closest = d;
-			ret = *iter;
+			ret = entry.bezier;
+			best = &entry;
 			best_time=time;
 		}
 	}
 
 	if(closest < radius*radius)
 	{
+		// sampling gives approximate location, so refine it for the found curve only
 		if(location)
-			*location = best_time;  // We need to square-root this because we were dealing with squared distances
+			*location = best ? refine_closest_time(best->points, pos, best_time) : best_time;
 
 		return ret;
 	}
@@ -3369,6 +3553,7 @@ Duckmatic::Push::restore()
 {
 	duckmatic_->duck_map=duck_map;
 	duckmatic_->bezier_list_=bezier_list_;
+	duckmatic_->pick_index.invalidate();
 	duckmatic_->duck_data_share_map=duck_data_share_map;
 	duckmatic_->stroke_list_=stroke_list_;
 	duckmatic_->duck_dragger_=duck_dragger_;
@@ -37,11 +37,13 @@
 #include <list>
 #include <map>
 #include <set>
+#include <vector>
 #include <sigc++/sigc++.h>
 
 #include <synfig/vector.h>
 #include <synfig/string.h>
 #include <synfig/real.h>
+#include <synfig/rect.h>
 #include <synfig/time.h>
 #include <synfig/color.h>
 #include <synfig/guidset.h>
@@ -171,6 +173,49 @@ private:
 
 	std::list<etl::handle<Bezier> > bezier_list_;
 
+	//! Positions of ducks and beziers at workarea bucketed by uniform grid,
+	//! rebuilt on demand when ducks or their positions are changed
+	struct PickIndex
+	{
+		struct DuckEntry
+		{
+			synfig::Point point;
+			etl::handle<Duck> duck;
+		};
+
+		struct BezierEntry
+		{
+			synfig::Point points[4];
+			synfig::Rect bounds;
+			etl::handle<Bezier> bezier;
+		};
+
+		bool valid;
+		unsigned long position_revision;
+
+		std::vector<DuckEntry> ducks;			//!< in order of duck_map
+		std::vector<BezierEntry> beziers;		//!< in order of bezier_list_
+
+		synfig::Point origin;
+		synfig::Real cell_size;
+		int cols, rows;
+		std::vector< std::vector<int> > duck_cells;
+		std::vector< std::vector<int> > bezier_cells;
+		std::vector<int> large_beziers;			//!< beziers which cover too many cells
+
+		PickIndex(): valid(false), position_revision(0), cell_size(1.0), cols(0), rows(0) { }
+
+		void invalidate() { valid = false; }
+		bool is_actual() const { return valid && position_revision == Duck::get_position_revision(); }
+		void build(const DuckMap &duck_map, const std::list<etl::handle<Bezier> > &bezier_list);
+
+		//! Collects indices (in ascending order) of ducks and beziers which may be found
+		//! in \a radius around \a point, returns false if whole lists should be checked
+		bool query(const synfig::Point &point, synfig::Real radius, std::vector<int> &duck_ids, std::vector<int> &bezier_ids) const;
+	};
+
+	PickIndex pick_index;
+
 	//! I cannot recall what this is for
 	//synfig::Vector snap;
 
@@ -465,6 +510,9 @@ public:
 	/*!	A radius of "zero" will have an unlimited radius */
 	etl::handle<Duck> find_duck(synfig::Point pos, synfig::Real radius=0, Duck::Type type=Duck::TYPE_DEFAULT);
 
+	//! Rebuilds pick_index if ducks was changed
+	void update_pick_index();
+
 	GuideList::iterator find_guide_x(synfig::Point pos, float radius=0.1);
 	GuideList::iterator find_guide_y(synfig::Point pos, float radius=0.1);
 	GuideList::const_iterator find_guide_x(synfig::Point pos, float radius=0.1)const { return const_cast<Duckmatic*>(this)->find_guide_x(pos,radius); }
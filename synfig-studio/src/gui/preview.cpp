@@ -34,6 +34,11 @@
 
 #include <gui/preview.h>
 
+#include <set>
+
+#include <glib/gstdio.h>
+#include <glibmm/fileutils.h>
+
 #include <gdkmm/general.h>
 
 #include <gtkmm/alignment.h>
@@ -46,6 +51,8 @@
 #include <gui/exception_guard.h>
 #include <gui/localization.h>
 
+#include <synfig/layers/layer_pastecanvas.h>
+#include <synfig/savecanvas.h>
 #include <synfig/string.h>
 #include <synfig/surface.h>
 #include <synfig/target_scanline.h>
@@ -64,6 +71,73 @@ using namespace studio;
 
 /* === P R O C E D U R E S ================================================= */
 
+namespace {
+
+//! Collects files read by layers of \a canvas and of canvases it includes:
+//! imported images, fonts given by file and linked .sif files
+void
+gather_external_files(std::set<String> &files, std::set<const Canvas*> &canvases, const Canvas::Handle &canvas)
+{
+	if (!canvas || !canvases.insert(canvas.get()).second)
+		return;
+
+	for(Canvas::const_iterator i = canvas->begin(); i != canvas->end(); ++i)
+	{
+		ParamVocab vocab = (*i)->get_param_vocab();
+		for(ParamVocab::const_iterator j = vocab.begin(); j != vocab.end(); ++j)
+		{
+			if (j->get_hint() != "filename" && j->get_hint() != "font_family")
+				continue;
+			ValueBase value = (*i)->get_param(j->get_name());
+			if (!value.can_get(String()))
+				continue;
+			String filename = value.get(String());
+			if (filename.empty() || filename[0] == '#') // file inside of the document container
+				continue;
+			filename = etl::absolute_path(canvas->get_file_path() + "/", filename);
+			if (Glib::file_test(filename, Glib::FILE_TEST_IS_REGULAR)) // font family may be just a name
+				files.insert(filename);
+		}
+
+		if (Layer_PasteCanvas::Handle::cast_dynamic(*i))
+		{
+			ValueBase value = (*i)->get_param("canvas");
+			if (!value.can_get(Canvas::Handle()))
+				continue;
+			Canvas::Handle sub_canvas = value.get(Canvas::Handle());
+			if (!sub_canvas)
+				continue;
+			String file_name = sub_canvas->get_root()->get_file_name();
+			if (file_name != canvas->get_root()->get_file_name())
+				files.insert(file_name);
+			gather_external_files(files, canvases, sub_canvas);
+		}
+	}
+}
+
+//! Paths, modification times and sizes of external files of the document,
+//! they are not part of serialized document but change the rendered frames
+String
+external_files_key(const Canvas::Handle &canvas)
+{
+	std::set<String> files;
+	std::set<const Canvas*> canvases;
+	gather_external_files(files, canvases, canvas);
+
+	String key;
+	for(std::set<String>::const_iterator i = files.begin(); i != files.end(); ++i)
+	{
+		GStatBuf buf;
+		if (g_stat(i->c_str(), &buf) == 0)
+			key += etl::strprintf("%s %lld %lld\n", i->c_str(), (long long)buf.st_mtime, (long long)buf.st_size);
+		else
+			key += *i + "\n";
+	}
+	return key;
+}
+
+} // end of anonymous namespace
+
 /* === M E T H O D S ======================================================= */
 
 /* === E N T R Y P O I N T ================================================= */
@@ -146,6 +220,7 @@ public:
 };
 
 studio::Preview::Preview(const etl::loose_handle<CanvasView> &h, float zoom, float f):
+	cached_index(-1),
 	canvasview(h),
 	zoom(zoom),
 	fps(f),
@@ -156,11 +231,36 @@ studio::Preview::Preview(const etl::loose_handle<CanvasView> &h, float zoom, flo
 	overend(false),
 	quality(),
 	global_fps()
-{ }
+{
+	track_document();
+}
+
+void studio::Preview::track_document()
+{
+	for(std::vector<sigc::connection>::iterator i = document_connections.begin(); i != document_connections.end(); ++i)
+		i->disconnect();
+	document_connections.clear();
+	document_hash.clear();
+
+	if (!canvasview || !canvasview->get_instance())
+		return;
+
+	// any action, undo or redo may change the document
+	Instance &instance = *canvasview->get_instance();
+	document_connections.push_back(instance.signal_new_action().connect(
+		sigc::hide(sigc::mem_fun(*this, &Preview::on_document_changed)) ));
+	document_connections.push_back(instance.signal_action_status_changed().connect(
+		sigc::hide(sigc::mem_fun(*this, &Preview::on_document_changed)) ));
+	document_connections.push_back(instance.signal_undo().connect(
+		sigc::mem_fun(*this, &Preview::on_document_changed) ));
+	document_connections.push_back(instance.signal_redo().connect(
+		sigc::mem_fun(*this, &Preview::on_document_changed) ));
+}
 
 void studio::Preview::set_canvasview(const etl::loose_handle<CanvasView> &h)
 {
 	canvasview = h;
+	track_document();
 
 	if(canvasview)
 	{
@@ -236,9 +336,47 @@ void studio::Preview::render()
 
 		//... first we must clear our current selves of space
 		frames.resize(0);
+		cached_index = -1;
+		cached_buf.reset();
+
+		// frames of the same document rendered with the same settings
+		// before (maybe in the previous session) are taken from the cache,
+		// the document is serialized only when it was changed since the last render,
+		// external files are checked every time, because they may be changed outside
+		if (document_hash.empty())
+			document_hash = PreviewCache::hash(canvas_to_string(get_canvas()->get_root()));
+		String files_hash = PreviewCache::hash(external_files_key(get_canvas()->get_root()));
+		String cache_filename = PreviewCache::get_cache_filename(get_canvas()->get_file_name() + "#" + get_canvas()->get_id());
+		PreviewCache::evict(cache_filename);
+		const Color &bg = desc.get_bg_color();
+		cache = new PreviewCache(
+			cache_filename,
+			document_hash + " " + files_hash
+			+ etl::strprintf(" %dx%d %f %f %f %d %f %f %f",
+				neww, newh, newfps,
+				(float)desc.get_time_start(), (float)desc.get_time_end(),
+				quality, bg.get_r(), bg.get_g(), bg.get_b()) );
+
+		int total_frames = desc.get_frame_end() - desc.get_frame_start() + 1;
+		int cached_frames = std::min(cache->count(), total_frames);
+		for(int i = 0; i < cached_frames; ++i)
+		{
+			FlipbookElem fe;
+			fe.t = desc.get_time_start() + i/newfps;
+			frames.push_back(fe);
+		}
 
-		//now tell it to go... with inherited prog. reporting...
 		if(renderer) renderer->stop();
+		if (cached_frames > 0)
+			signal_changed()();
+		if (cached_frames >= total_frames)
+			return;
+
+		// render the rest
+		desc.set_time_start(desc.get_time_start() + cached_frames/newfps);
+		target->set_rend_desc(&desc);
+
+		//now tell it to go... with inherited prog. reporting...
 		renderer = new AsyncRenderer(target);
 		renderer->start();
 	}
@@ -247,6 +385,25 @@ void studio::Preview::render()
 void studio::Preview::clear()
 {
 	frames.clear();
+	if (cache) cache->remove();
+	cache.reset();
+	cached_index = -1;
+	cached_buf.reset();
+}
+
+Glib::RefPtr<Gdk::Pixbuf>
+studio::Preview::get_frame_buf(int index)
+{
+	if (index < 0 || index >= (int)frames.size())
+		return Glib::RefPtr<Gdk::Pixbuf>();
+	if (frames[index].buf)
+		return frames[index].buf;
+	if (index != cached_index && cache)
+	{
+		cached_index = index;
+		cached_buf = cache->load(index);
+	}
+	return index == cached_index ? cached_buf : Glib::RefPtr<Gdk::Pixbuf>();
 }
 
 const etl::handle<synfig::Canvas>&
@@ -303,6 +460,10 @@ void studio::Preview::frame_finish(const Preview_Target *targ)
 		sigc::ptr_fun(free_guint8)
 	);
 
+	//keep the frame on disk instead of memory, if possible
+	if (cache && cache->store((int)frames.size(), fe.buf))
+		fe.buf.reset();
+
 	//add the flipbook element to the list (assume time is correct)
 	//synfig::info("Prev: Adding %f s to the list", time);
 	frames.push_back(fe);
@@ -663,8 +824,8 @@ void studio::Widget_Preview::update()
 				timedisp = -1;
 			}else
 			{
-				currentbuf = i->buf;
 				currentindex = i-beg;
+				currentbuf = preview->get_frame_buf(currentindex);
 				if(timedisp != i->t)
 				{
 					timedisp = i->t;
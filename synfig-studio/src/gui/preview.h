@@ -43,6 +43,7 @@
 #include <gtkmm/table.h>
 
 #include <gui/dials/jackdial.h>
+#include <gui/previewcache.h>
 
 #ifdef WITH_JACK
 #include <jack/jack.h>
@@ -71,7 +72,9 @@ public:
 	{
 	public:
 		float t;
-		Glib::RefPtr<Gdk::Pixbuf> buf; //at whatever resolution they are rendered at (resized at run time)
+		//at whatever resolution they are rendered at (resized at run time),
+		//empty if the frame is kept in the cache, see get_frame_buf()
+		Glib::RefPtr<Gdk::Pixbuf> buf;
 		cairo_surface_t* surface;
 		FlipbookElem(): t(), surface(NULL) { }
 		//Copy constructor
@@ -94,6 +97,18 @@ private:
 
 	FlipBook frames;
 
+	//! Frames on disk, loaded on demand by get_frame_buf()
+	PreviewCache::Handle cache;
+	int cached_index;
+	Glib::RefPtr<Gdk::Pixbuf> cached_buf;
+
+	//! Hash of the document content, empty when the document is changed
+	std::string document_hash;
+	std::vector<sigc::connection> document_connections;
+
+	void track_document();
+	void on_document_changed() { document_hash.clear(); }
+
 	etl::loose_handle<CanvasView> canvasview;
 
 	//synfig::RendDesc		description; //for rendering the preview...
@@ -181,6 +196,9 @@ public:
 	
 	unsigned int				numframes() const  {return frames.size();}
 
+	//! Returns image of the frame, loads it from the cache if necessary
+	Glib::RefPtr<Gdk::Pixbuf> get_frame_buf(int index);
+
 	void render();
 
 	sigc::signal0<void>	&signal_changed() { return sig_changed; }
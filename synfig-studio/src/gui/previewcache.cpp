@@ -0,0 +1,277 @@
+/* === S Y N F I G ========================================================= */
+/*!	\file previewcache.cpp
+**	\brief On-disk store of rendered preview frames
+**
+**	$Id$
+**
+**	\legal
+**	......... ... 2026 Synfig contributors
+**
+**	This package is free software; you can redistribute it and/or
+**	modify it under the terms of the GNU General Public License as
+**	published by the Free Software Foundation; either version 2 of
+**	the License, or (at your option) any later version.
+**
+**	This package is distributed in the hope that it will be useful,
+**	but WITHOUT ANY WARRANTY; without even the implied warranty of
+**	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+**	General Public License for more details.
+**	\endlegal
+*/
+/* ========================================================================= */
+
+/* === H E A D E R S ======================================================= */
+
+#ifdef USING_PCH
+#	include "pch.h"
+#else
+#ifdef HAVE_CONFIG_H
+#	include <config.h>
+#endif
+
+#include <gui/previewcache.h>
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+
+#include <glib/gstdio.h>
+#include <glibmm/miscutils.h>
+
+#include <ETL/stringf>
+
+#include <synfig/filesystemnative.h>
+#include <synfig/general.h>
+#include <synfig/zstreambuf.h>
+
+#include <synfigapp/main.h>
+
+#endif
+
+/* === U S I N G =========================================================== */
+
+using namespace synfig;
+using namespace studio;
+
+/* === M A C R O S ========================================================= */
+
+#define PREVIEW_CACHE_MAGIC "SYNFIG PREVIEW CACHE 1"
+
+// limits of the cache directory, see PreviewCache::evict()
+#define PREVIEW_CACHE_MAX_SIZE ((long long)512*1024*1024)
+#define PREVIEW_CACHE_MAX_AGE  (30*24*60*60)
+
+/* === G L O B A L S ======================================================= */
+
+/* === P R O C E D U R E S ================================================= */
+
+static void free_guint8(const guint8 *mem)
+{
+	free((void*)mem);
+}
+
+namespace {
+	struct CacheFile
+	{
+		std::string filename;
+		long long size;
+		time_t time;
+		CacheFile(): size(), time() { }
+		bool operator< (const CacheFile &other) const
+			{ return time < other.time; }
+	};
+}
+
+/* === M E T H O D S ======================================================= */
+
+PreviewCache::PreviewCache(const std::string &filename, const std::string &key):
+	filename(filename),
+	end()
+{
+	file.open(filename.c_str(), std::ios::in | std::ios::out | std::ios::binary);
+	if (!file.is_open())
+		{ create(filename, key); return; }
+
+	std::string magic, file_key;
+	std::getline(file, magic);
+	std::getline(file, file_key);
+	if (!file || magic != PREVIEW_CACHE_MAGIC || file_key != key)
+		{ file.close(); create(filename, key); return; }
+
+	// read index of frames, stop at first incomplete record
+	file.seekg(0, std::ios::end);
+	std::streamoff length = file.tellg();
+	file.seekg(end = (std::streamoff)(magic.size() + file_key.size() + 2));
+	while(true)
+	{
+		unsigned int header[3];
+		if (!file.read((char*)header, sizeof(header)))
+			break;
+
+		Entry entry;
+		entry.width  = (int)header[0];
+		entry.height = (int)header[1];
+		entry.size   = header[2];
+		entry.offset = end + (std::streamoff)sizeof(header);
+		if ( entry.width <= 0 || entry.height <= 0 || !entry.size
+		  || entry.offset + (std::streamoff)entry.size > length )
+			break;
+
+		entries.push_back(entry);
+		end = entry.offset + (std::streamoff)entry.size;
+		file.seekg(end);
+	}
+	file.clear();
+}
+
+void
+PreviewCache::create(const std::string &filename, const std::string &key)
+{
+	entries.clear();
+	end = 0;
+
+	FileSystemNative::instance()->directory_create_recursive(Glib::path_get_dirname(filename));
+	file.open(filename.c_str(), std::ios::in | std::ios::out | std::ios::binary | std::ios::trunc);
+	if (!file.is_open())
+		{ synfig::warning("PreviewCache: cannot create file \"%s\"", filename.c_str()); return; }
+
+	file << PREVIEW_CACHE_MAGIC << "\n" << key << "\n";
+	file.flush();
+	end = file.tellp();
+	if (!file)
+		file.close();
+}
+
+Glib::RefPtr<Gdk::Pixbuf>
+PreviewCache::load(int index)
+{
+	if (!is_open() || index < 0 || index >= count())
+		return Glib::RefPtr<Gdk::Pixbuf>();
+
+	const Entry &entry = entries[index];
+	std::vector<char> packed(entry.size);
+	file.seekg(entry.offset);
+	if (!file.read(&packed.front(), packed.size()))
+		{ file.clear(); return Glib::RefPtr<Gdk::Pixbuf>(); }
+
+	const size_t stride = (size_t)entry.width*3;
+	const size_t size = stride*(size_t)entry.height;
+	guint8 *buffer = (guint8*)malloc(size);
+	if (!buffer)
+		return Glib::RefPtr<Gdk::Pixbuf>();
+	if (zstreambuf::unpack(buffer, size, &packed.front(), packed.size()) != size)
+		{ free(buffer); return Glib::RefPtr<Gdk::Pixbuf>(); }
+
+	return Gdk::Pixbuf::create_from_data(
+		buffer, Gdk::COLORSPACE_RGB, false, 8,
+		entry.width, entry.height, (int)stride,
+		sigc::ptr_fun(free_guint8) );
+}
+
+bool
+PreviewCache::store(int index, const Glib::RefPtr<Gdk::Pixbuf> &buf)
+{
+	if (!is_open() || index != count() || !buf)
+		return false;
+	if (buf->get_n_channels() != 3 || buf->get_has_alpha() || buf->get_bits_per_sample() != 8)
+		return false;
+
+	// pack rows without padding
+	const int width = buf->get_width();
+	const int height = buf->get_height();
+	const size_t stride = (size_t)width*3;
+	std::vector<char> rows(stride*height);
+	for(int y = 0; y < height; ++y)
+		memcpy(&rows[stride*y], buf->get_pixels() + (size_t)buf->get_rowstride()*y, stride);
+
+	std::vector<char> packed;
+	if (!zstreambuf::pack(packed, &rows.front(), rows.size(), true) || packed.empty())
+		return false;
+
+	unsigned int header[3] = { (unsigned int)width, (unsigned int)height, (unsigned int)packed.size() };
+	file.seekp(end);
+	file.write((const char*)header, sizeof(header));
+	file.write(&packed.front(), packed.size());
+	file.flush();
+	if (!file)
+		{ file.close(); return false; }
+
+	Entry entry;
+	entry.width  = width;
+	entry.height = height;
+	entry.size   = packed.size();
+	entry.offset = end + (std::streamoff)sizeof(header);
+	entries.push_back(entry);
+	end = entry.offset + (std::streamoff)entry.size;
+	return true;
+}
+
+void
+PreviewCache::remove()
+{
+	if (file.is_open())
+		file.close();
+	entries.clear();
+	end = 0;
+	if (FileSystemNative::instance()->is_file(filename))
+		FileSystemNative::instance()->file_remove(filename);
+}
+
+std::string
+PreviewCache::hash(const std::string &data)
+{
+	unsigned long long h = 14695981039346656037ULL;
+	for(std::string::const_iterator i = data.begin(); i != data.end(); ++i)
+		h = (h ^ (unsigned char)*i) * 1099511628211ULL;
+	return etl::strprintf("%016llx", h);
+}
+
+std::string
+PreviewCache::get_cache_directory()
+	{ return Glib::build_filename(synfigapp::Main::get_user_app_directory(), "previews"); }
+
+std::string
+PreviewCache::get_cache_filename(const std::string &document_filename)
+	{ return Glib::build_filename(get_cache_directory(), hash(document_filename) + ".cache"); }
+
+void
+PreviewCache::evict(const std::string &keep)
+{
+	FileSystem::FileList names;
+	if (!FileSystemNative::instance()->directory_scan(get_cache_directory(), names))
+		return;
+
+	// modification time of the file is the time of the last stored frame
+	std::vector<CacheFile> files;
+	long long total_size = 0;
+	for(FileSystem::FileList::const_iterator i = names.begin(); i != names.end(); ++i)
+	{
+		if (i->size() < 6 || i->compare(i->size() - 6, 6, ".cache") != 0)
+			continue;
+		CacheFile f;
+		f.filename = Glib::build_filename(get_cache_directory(), *i);
+		if (f.filename == keep)
+			continue;
+		GStatBuf buf;
+		if (g_stat(f.filename.c_str(), &buf) != 0)
+			continue;
+		f.size = (long long)buf.st_size;
+		f.time = buf.st_mtime;
+		files.push_back(f);
+		total_size += f.size;
+	}
+
+	// oldest files first
+	std::sort(files.begin(), files.end());
+	const time_t min_time = time(NULL) - PREVIEW_CACHE_MAX_AGE;
+	for(std::vector<CacheFile>::const_iterator i = files.begin(); i != files.end(); ++i)
+	{
+		if (i->time >= min_time && total_size <= PREVIEW_CACHE_MAX_SIZE)
+			break;
+		if (FileSystemNative::instance()->file_remove(i->filename))
+			total_size -= i->size;
+	}
+}
+
+/* === E N T R Y P O I N T ================================================= */
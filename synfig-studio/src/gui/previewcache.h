@@ -0,0 +1,106 @@
+/* === S Y N F I G ========================================================= */
+/*!	\file previewcache.h
+**	\brief On-disk store of rendered preview frames
+**
+**	$Id$
+**
+**	\legal
+**	......... ... 2026 Synfig contributors
+**
+**	This package is free software; you can redistribute it and/or
+**	modify it under the terms of the GNU General Public License as
+**	published by the Free Software Foundation; either version 2 of
+**	the License, or (at your option) any later version.
+**
+**	This package is distributed in the hope that it will be useful,
+**	but WITHOUT ANY WARRANTY; without even the implied warranty of
+**	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+**	General Public License for more details.
+**	\endlegal
+*/
+/* ========================================================================= */
+
+/* === S T A R T =========================================================== */
+
+#ifndef __SYNFIG_STUDIO_PREVIEWCACHE_H
+#define __SYNFIG_STUDIO_PREVIEWCACHE_H
+
+/* === H E A D E R S ======================================================= */
+
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include <ETL/handle>
+
+#include <gdkmm/pixbuf.h>
+
+/* === M A C R O S ========================================================= */
+
+/* === T Y P E D E F S ===================================================== */
+
+/* === C L A S S E S & S T R U C T S ======================================= */
+
+namespace studio {
+
+//! Stores frames of the preview compressed in a single file.
+/*! The file starts with a key of the document content and preview settings,
+**  the file is rewritten from scratch when the key doesn't match.
+**  Frames are appended in order, so cache always contains first count() frames. */
+class PreviewCache: public etl::shared_object
+{
+public:
+	typedef etl::handle<PreviewCache> Handle;
+
+private:
+	struct Entry
+	{
+		std::streamoff offset;
+		int width, height;
+		size_t size;
+		Entry(): offset(), width(), height(), size() { }
+	};
+
+	std::string filename;
+	std::fstream file;
+	std::vector<Entry> entries;
+	std::streamoff end;
+
+	void create(const std::string &filename, const std::string &key);
+
+public:
+	PreviewCache(const std::string &filename, const std::string &key);
+
+	bool is_open() const { return file.is_open(); }
+
+	//! Count of stored frames
+	int count() const { return (int)entries.size(); }
+
+	//! Loads frame, returns empty pointer if \a index is out of range or file is broken
+	Glib::RefPtr<Gdk::Pixbuf> load(int index);
+
+	//! Appends frame, \a index should be equal to count()
+	bool store(int index, const Glib::RefPtr<Gdk::Pixbuf> &buf);
+
+	//! Closes and deletes the cache file
+	void remove();
+
+	//! Returns 64-bit FNV-1a hash of \a data as hex string
+	static std::string hash(const std::string &data);
+
+	//! Returns directory of the cache files
+	static std::string get_cache_directory();
+
+	//! Returns name of the cache file for the document \a document_filename
+	static std::string get_cache_filename(const std::string &document_filename);
+
+	//! Deletes cache files which are too old, and the least recently used ones
+	//! while total size of the cache directory is too big. File \a keep is not deleted.
+	static void evict(const std::string &keep);
+};
+
+}; // END of namespace studio
+
+/* === E N D =============================================================== */
+
+#endif
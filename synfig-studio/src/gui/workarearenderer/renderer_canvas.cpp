@@ -41,6 +41,7 @@
 #include <synfig/rendering/renderer.h>
 #include <synfig/rendering/common/task/tasktransformation.h>
 
+#include <gui/app.h>
 #include <gui/canvasview.h>
 #include <gui/localization.h>
 #include <gui/timemodel.h>
@@ -77,11 +78,15 @@ static long long
 image_rect_size(const RectInt &rect)
 	{ return 4ll*rect.get_width()*rect.get_height(); }
 
+static long long
+render_rect_size(const RectInt &rect)
+	{ return (long long)sizeof(Color)*rect.get_width()*rect.get_height(); }
+
 /* === M E T H O D S ======================================================= */
 
 Renderer_Canvas::Renderer_Canvas():
-	max_tiles_size_soft(512*1024*1024),
-	max_tiles_size_hard(max_tiles_size_soft + 128*1024*1024),
+	max_tiles_size_soft(),
+	max_tiles_size_hard(),
 	weight_future      (   1.0), // high priority
 	weight_past        (   2.0), // low priority
 	weight_future_extra(  16.0),
@@ -114,6 +119,12 @@ Renderer_Canvas::Renderer_Canvas():
 	alpha_src_surface->flush();
 
 	alpha_context = Cairo::Context::create(alpha_dst_surface);
+
+	//! transparent pixel, outside of it cairo paints nothing
+	blank_surface = Cairo::ImageSurface::create(
+		Cairo::FORMAT_ARGB32, 1, 1);
+
+	update_cache_size();
 }
 
 Renderer_Canvas::~Renderer_Canvas()
@@ -146,12 +157,21 @@ Renderer_Canvas::convert(
 	// this method may be called from the other threads
 	assert(width > 0 && height > 0);
 
+	#ifdef DEBUG_TILES
+	const bool debug_tiles = true;
+	#else
+	const bool debug_tiles = false;
+	#endif
+
+	rendering::SurfaceResource::LockReadBase surface_lock(surface);
+	if (surface_lock.get_resource() && surface_lock.get_resource()->is_blank() && !debug_tiles)
+		return blank_surface;
+
 	Cairo::RefPtr<Cairo::ImageSurface> cairo_surface =
 		Cairo::ImageSurface::create(Cairo::FORMAT_ARGB32, width, height);
 
 	bool success = false;
 
-	rendering::SurfaceResource::LockReadBase surface_lock(surface);
 	if (surface_lock.get_resource() && surface_lock.get_resource()->is_blank()) {
 		success = true;
 	} else
@@ -185,13 +205,6 @@ Renderer_Canvas::convert(
 		} else error("Renderer_Canvas::convert: surface with wrong size");
 	} else error("Renderer_Canvas::convert: surface not exists");
 
-
-	#ifdef DEBUG_TILES
-	const bool debug_tiles = true;
-	#else
-	const bool debug_tiles = false;
-	#endif
-
 	// paint tile
 	if (debug_tiles || !success) {
 		Cairo::RefPtr<Cairo::Context> context = Cairo::Context::create(cairo_surface);
@@ -241,6 +254,12 @@ Renderer_Canvas::on_tile_finished(bool success, const Tile::Handle &tile)
 	tile->cairo_surface = cairo_surface;
 	tile->surface.reset();
 
+	// float surface is released, account the compact one instead
+	long long size = cairo_surface && cairo_surface != blank_surface
+	               ? (long long)cairo_surface->get_stride()*cairo_surface->get_height() : 0;
+	tiles_size += size - tile->size;
+	tile->size = size;
+
 	// don't create handle if ref-count is zero
 	// it means that object was nether had a handles and will removed with handle
 	// or object is already in destruction phase
@@ -283,7 +302,16 @@ Renderer_Canvas::insert_tile(TileList &list, const Tile::Handle &tile)
 	// this method may be called from other threads
 	// mutex must be already locked
 	list.push_back(tile);
-	tiles_size += image_rect_size(tile->rect);
+	tile->size = render_rect_size(tile->rect);
+	tiles_size += tile->size;
+}
+
+void
+Renderer_Canvas::update_cache_size()
+{
+	// mutex must be already locked
+	max_tiles_size_soft = std::max(16, App::workarea_cache_size)*1024ll*1024ll;
+	max_tiles_size_hard = max_tiles_size_soft + max_tiles_size_soft/4;
 }
 
 Renderer_Canvas::TileList::iterator
@@ -292,7 +320,8 @@ Renderer_Canvas::erase_tile(TileList &list, TileList::iterator i, rendering::Tas
 	// this method may be called from other threads
 	// mutex must be already locked
 	if ((*i)->event) events.push_back((*i)->event);
-	tiles_size -= image_rect_size((*i)->rect);
+	tiles_size -= (*i)->size;
+	(*i)->size = 0;
 	(*i)->event.reset();
 	(*i)->surface.reset();
 	(*i)->cairo_surface = Cairo::RefPtr<Cairo::ImageSurface>();
@@ -424,6 +453,21 @@ Renderer_Canvas::enqueue_render_frame(
 	ContextParams context_params(rend_desc.get_render_excluded_contexts());
 	TileList &frame_tiles = tiles[id];
 
+	// layers outside of the window (snapped to tile grid) will be skipped while building the task
+	{
+		RectInt rect = window_rect;
+		rect.minx = int_floor(rect.minx, tile_grid_step);
+		rect.miny = int_floor(rect.miny, tile_grid_step);
+		rect.maxx = int_ceil (rect.maxx, tile_grid_step);
+		rect.maxy = int_ceil (rect.maxy, tile_grid_step);
+		rect &= id.rect();
+		Vector tl = rend_desc.get_tl();
+		Vector size = rend_desc.get_br() - tl;
+		context_params.render_rect = Rect(
+			tl + Vector(size[0]*rect.minx/w, size[1]*rect.miny/h),
+			tl + Vector(size[0]*rect.maxx/w, size[1]*rect.maxy/h) );
+	}
+
 	// create transformation matrix to flip result if needed
 	bool transform = false;
 	Matrix matrix;
@@ -542,6 +586,7 @@ Renderer_Canvas::enqueue_render()
 		bool			is_bounded = time_model->get_play_bounds_enabled();
 
 		build_onion_frames();
+		update_cache_size();
 
 		rendering::Renderer::Handle renderer = rendering::Renderer::get_renderer(renderer_name);
 		
@@ -956,7 +1001,12 @@ Renderer_Canvas::get_thumb(const Time &time)
 {
 	std::lock_guard<std::mutex> lock(mutex);
 	TileMap::const_iterator i = tiles.find( current_thumb.with_time(time) );
-	return i == tiles.end() || i->second.empty() || !*(i->second.begin())
-		 ? Cairo::RefPtr<Cairo::ImageSurface>()
-		 : (*(i->second.begin()))->cairo_surface;
+	if (i == tiles.end() || i->second.empty() || !*(i->second.begin()))
+		return Cairo::RefPtr<Cairo::ImageSurface>();
+
+	const Tile &tile = **(i->second.begin());
+	if (tile.cairo_surface && tile.cairo_surface == blank_surface)
+		return Cairo::ImageSurface::create(
+			Cairo::FORMAT_ARGB32, tile.rect.get_width(), tile.rect.get_height() );
+	return tile.cairo_surface;
 }
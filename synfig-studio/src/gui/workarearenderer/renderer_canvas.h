@@ -120,10 +120,11 @@ public:
 		synfig::rendering::TaskEvent::Handle event;
 		synfig::rendering::SurfaceResource::Handle surface;
 		Cairo::RefPtr<Cairo::ImageSurface> cairo_surface;
+		long long size; //!< bytes accounted in tiles_size
 
-		Tile() { }
+		Tile(): size() { }
 		Tile(const FrameId &frame_id, synfig::RectInt &rect):
-			frame_id(frame_id), rect(rect) { }
+			frame_id(frame_id), rect(rect), size() { }
 	};
 
 	typedef std::map<synfig::Time, FrameStatus> StatusMap;
@@ -134,8 +135,8 @@ public:
 
 private:
 	// cache options
-	const long long max_tiles_size_soft; //!< threshold for creation of new tiles
-	const long long max_tiles_size_hard; //!< threshold for removing already created tiles
+	long long max_tiles_size_soft; //!< threshold for creation of new tiles, see App::workarea_cache_size
+	long long max_tiles_size_hard; //!< threshold for removing already created tiles
 	const synfig::Real weight_future;    //!< will multiply to frames count
 	const synfig::Real weight_past;
 	const synfig::Real weight_future_extra;
@@ -159,7 +160,7 @@ private:
 	FrameId current_frame;
 	synfig::Time frame_duration;
 
-	//! increment of this field makes all tiles outdated
+	//! memory used by tiles, float surfaces while rendering and cairo surfaces when done
 	long long tiles_size;
 
 	synfig::PixelFormat pixel_format;
@@ -169,6 +170,9 @@ private:
 	Cairo::RefPtr<Cairo::ImageSurface> alpha_dst_surface;
 	Cairo::RefPtr<Cairo::Context> alpha_context;
 
+	//! shared by all tiles with fully transparent content, to don't keep memory for them
+	Cairo::RefPtr<Cairo::ImageSurface> blank_surface;
+
 	synfig::Vector previous_tl;
 	synfig::Vector previous_br;
 	Cairo::RefPtr<Cairo::ImageSurface> previous_surface;
@@ -189,6 +193,9 @@ private:
 		const synfig::rendering::SurfaceResource::Handle &surface,
 		int width, int height ) const;
 
+	//! mutex must be locked before call
+	void update_cache_size();
+
 	//! mutex must be locked before call
 	void insert_tile(TileList &list, const Tile::Handle &tile);
 